@@ -0,0 +1,46 @@
+#pragma once
+
+#include "data.h"
+#include "data_block.h"
+#include <cstdint>
+#include <cstring>
+
+// Buffer 类定义
+// 连续字节缓冲区，带读/写游标：[0, read_index_) 为已消费，
+// [read_index_, write_index_) 为可读数据，[write_index_, capacity) 为可写空间。
+// 存储为引用计数的 DataBlock，Take() 切出的 Data 直接引用缓冲区内存而不复制；
+// 存储仍被切片引用时，缓冲区不会覆盖已写入区域，而是换用新块。
+
+class Buffer {
+public:
+    Buffer();
+    ~Buffer();
+    
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    
+    size_t ReadableBytes() const { return write_index_ - read_index_; }
+    size_t WritableBytes() const { return block_ ? block_->capacity() - write_index_ : 0; }
+    
+    const uint8_t* Peek() const { return block_->bytes() + read_index_; }
+    uint8_t* BeginWrite() { return block_ ? block_->bytes() + write_index_ : nullptr; }
+    
+    // 消费 n 字节可读数据
+    void Retrieve(size_t n);
+    void RetrieveAll();
+    // 切出 n 字节可读数据作为零拷贝的 Data，并消费它们
+    Data Take(size_t n);
+    // 确认已向 BeginWrite() 写入 n 字节
+    void HasWritten(size_t n) { write_index_ += n; }
+    
+    void Append(const void* data, size_t n);
+    // 保证至少 n 字节可写空间，优先搬移已消费区域，不够再换用更大的块
+    void EnsureWritable(size_t n);
+    // 缓冲区为空时归还存储，空闲连接不占用内存
+    void ReleaseIfEmpty();
+    
+private:
+    DataBlock* block_;
+    size_t read_index_;
+    size_t write_index_;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C（Castagnoli）校验
+// 启动时按 CPU 选择实现：x86-64 上用 SSE4.2 crc32 指令，AArch64 上用 ARMv8 CRC 指令，
+// 大块数据三路交错以掩盖指令延迟；都不支持时退回查表（slice-by-8）。
+// 可分段计算：Crc32c(Crc32c(0, a), b) 等于 Crc32c(0, a 与 b 拼接)。
+
+// 在 crc 的基础上继续计算 data 的 CRC32C，初值为 0
+uint32_t Crc32c(uint32_t crc, const void* data, size_t length);
+
+// 查表实现，与 Crc32c 结果相同；用于基准对比
+uint32_t Crc32cPortable(uint32_t crc, const void* data, size_t length);
+
+// 当前选用的实现：sse4.2 / armv8-crc / table
+const char* Crc32cImplementation();
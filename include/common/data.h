@@ -1,14 +1,22 @@
 #pragma once
 
+#include "data_block.h"
 #include <cstdint>
 #include <cstring>
 #include <memory>
 
+// Data 类定义
+// 负载视图：指向共享 DataBlock 中的一段区间。拷贝与切片只增加引用计数，
+// 不复制字节；需要独立副本时显式调用 Clone()。
+// 注意：非 const 的 ptr() 写入对共享同一块的所有 Data 可见。
+
 class Data {
 public:
     Data();
     explicit Data(size_t length);
     Data(const void* ptr, size_t length);
+    // 引用 block 中 [offset, offset + length) 区间，增加一次引用计数
+    Data(DataBlock* block, size_t offset, size_t length);
     Data(const Data& other);
     Data(Data&& other) noexcept;
     ~Data();
@@ -16,12 +24,19 @@ public:
     Data& operator=(const Data& other);
     Data& operator=(Data&& other) noexcept;
     
-    const void* ptr() const { return data_.get(); }
-    void* ptr() { return data_.get(); }
+    // 深拷贝，得到独占的新存储
+    Data Clone() const;
+    // 共享存储的子区间，越界部分会被截断
+    Data Slice(size_t offset, size_t length) const;
+    
+    const void* ptr() const { return block_ ? block_->bytes() + offset_ : nullptr; }
+    void* ptr() { return block_ ? block_->bytes() + offset_ : nullptr; }
     size_t length() const { return length_; }
     
 private:
-    std::unique_ptr<uint8_t[]> data_;
+    void Reset();
+    
+    DataBlock* block_;
+    size_t offset_;
     size_t length_;
 };
-
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// DataBlock 类定义
+// 引用计数的负载存储块：块头之后紧跟 capacity 字节数据，一次分配。
+// 多个 Data 可以共享同一个块的不同区间（切片），最后一个引用释放时归还内存。
+// 内存来自 SlabAllocator，capacity 为向上取整后的 size class 容量。
+
+class DataBlock {
+public:
+    // 新块的引用计数为 1
+    static DataBlock* Create(size_t capacity);
+    
+    void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+    void Unref();
+    
+    // 仅有一个引用时可以安全地覆盖已写入的区域
+    bool unique() const { return refs_.load(std::memory_order_acquire) == 1; }
+    
+    uint8_t* bytes() { return reinterpret_cast<uint8_t*>(this + 1); }
+    const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+    size_t capacity() const { return capacity_; }
+    
+private:
+    explicit DataBlock(size_t capacity) : refs_(1), capacity_(capacity) {}
+    ~DataBlock() = default;
+    
+    alignas(16) std::atomic<uint32_t> refs_;
+    size_t capacity_;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Logger 类定义
+// 异步日志：调用线程把格式化好的一行写入本线程的无锁环形缓冲区（单生产者单消费者），
+// 后台线程统一取出并写入文件。环满时丢弃并计数，热路径上从不阻塞、不加锁。
+// 低于 LOG_COMPILE_LEVEL 的级别在编译期整体消除；运行期级别可随时调整。
+// Start 之前（或 Stop 之后）的日志同步写到 stderr。
+
+enum class LogLevel : int {
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERROR = 4,
+    OFF = 5
+};
+
+// 编译期阈值，默认保留 DEBUG 及以上，可通过 CMake 的 LOG_COMPILE_LEVEL 调整
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 1
+#endif
+
+struct LogConfig {
+    LogLevel level = LogLevel::INFO;
+    // 输出文件路径，为空时写 stderr
+    std::string file;
+    // 每个线程环形缓冲区的记录数（2 的幂）
+    size_t ring_slots = 4096;
+};
+
+class Logger {
+public:
+    // 启动后台写线程；重复调用返回 false
+    static bool Start(const LogConfig& config);
+    // 写完所有已入队的日志后停止后台线程
+    static void Stop();
+    
+    static void SetLevel(LogLevel level);
+    static LogLevel GetLevel();
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+    
+    // 写入一条已格式化的日志（不含换行）
+    static void Write(LogLevel level, const char* text, size_t length);
+    
+    // 因环满而丢弃的记录总数
+    static uint64_t Dropped();
+    
+    // 解析 trace/debug/info/warn/error/off
+    static bool ParseLevel(const char* name, LogLevel* level);
+
+private:
+    inline static std::atomic<int> level_{static_cast<int>(LogLevel::INFO)};
+};
+
+// 以十六进制输出整数
+struct LogHex {
+    uint64_t value;
+    explicit LogHex(uint64_t v) : value(v) {}
+};
+
+// LogLine：在栈上的定长缓冲区中拼接一行日志，析构时提交给 Logger
+// 超长部分被截断，不分配内存
+class LogLine {
+public:
+    static constexpr size_t kMaxLength = 224;
+    
+    LogLine(LogLevel level, const char* file, int line, uint32_t suppressed = 0);
+    ~LogLine();
+    
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+    
+    LogLine& operator<<(std::string_view text);
+    LogLine& operator<<(const char* text) { return *this << std::string_view(text ? text : "(null)"); }
+    LogLine& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    LogLine& operator<<(char c);
+    LogLine& operator<<(bool value) { return *this << std::string_view(value ? "true" : "false"); }
+    LogLine& operator<<(double value);
+    LogLine& operator<<(const void* ptr);
+    LogLine& operator<<(LogHex hex);
+    
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                                      !std::is_same_v<T, char>>>
+    LogLine& operator<<(T value) {
+        auto result = std::to_chars(buf_ + length_, buf_ + kMaxLength, value);
+        if (result.ec == std::errc()) {
+            length_ = static_cast<size_t>(result.ptr - buf_);
+        }
+        return *this;
+    }
+
+private:
+    LogLevel level_;
+    uint32_t suppressed_;
+    size_t length_;
+    char buf_[kMaxLength];
+};
+
+// LogRateLimiter：按调用点限速，每秒最多放行 per_second 条，被抑制的条数附在下一条放行的日志上
+// 每个线程每个调用点一个实例，无需同步
+class LogRateLimiter {
+public:
+    bool Allow(uint32_t per_second);
+    uint32_t TakeSuppressed();
+
+private:
+    int64_t window_start_ms_ = 0;
+    uint32_t count_ = 0;
+    uint32_t suppressed_ = 0;
+};
+
+#ifdef __FILE_NAME__
+#define LOG_FILE_NAME __FILE_NAME__
+#else
+#define LOG_FILE_NAME __FILE__
+#endif
+
+// 用法：LOG_INFO << "Listening on " << port;
+// 级别未开启时整条语句（包括参数求值）被跳过
+#define LOG_AT(level)                                                                                \
+    if (static_cast<int>(level) < LOG_COMPILE_LEVEL || !Logger::IsEnabled(level)) {                  \
+    } else                                                                                           \
+        LogLine(level, LOG_FILE_NAME, __LINE__)
+
+#define LOG_TRACE LOG_AT(LogLevel::TRACE)
+#define LOG_DEBUG LOG_AT(LogLevel::DEBUG)
+#define LOG_INFO LOG_AT(LogLevel::INFO)
+#define LOG_WARN LOG_AT(LogLevel::WARN)
+#define LOG_ERROR LOG_AT(LogLevel::ERROR)
+
+// 限速版本，用于可能按连接刷屏的日志：LOG_RATE_LIMITED(LogLevel::WARN, 10) << ...;
+#define LOG_RATE_LIMITED(level, per_second)                                                          \
+    if (static_cast<int>(level) < LOG_COMPILE_LEVEL || !Logger::IsEnabled(level)) {                  \
+    } else if (static thread_local LogRateLimiter log_limiter_; !log_limiter_.Allow(per_second)) {   \
+    } else                                                                                           \
+        LogLine(level, LOG_FILE_NAME, __LINE__, log_limiter_.TakeSuppressed())
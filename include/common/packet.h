@@ -19,13 +19,35 @@ public:
     PacketHeader& header() { return header_; }
     
     const Data& data() const { return data_; }
-    Data& data() { return data_; }
+    // 可写访问视为负载可能被修改，已记录的负载 CRC 随之失效
+    Data& data() {
+        has_payload_crc_ = false;
+        return data_;
+    }
     
+    // 收到该帧时的单调时钟（纳秒），0 表示非网络收到的帧；用于回射延迟统计
+    uint64_t received_ns() const { return received_ns_; }
+    void set_received_ns(uint64_t received_ns) { received_ns_ = received_ns; }
+    
+    // 负载的 CRC32C（见 TcpEpoller::SetChecksum）：收到带校验尾部的帧时记下，原样回射时发送方不必再读一遍负载。
+    // has_payload_crc() 为真时 payload_crc() 有效；发送队列中的 Packet 在入队时已填入
+    bool has_payload_crc() const { return has_payload_crc_; }
+    uint32_t payload_crc() const { return payload_crc_; }
+    void set_payload_crc(uint32_t payload_crc) {
+        payload_crc_ = payload_crc;
+        has_payload_crc_ = true;
+    }
+    
+    // 拷贝构造/赋值与 Ack() 共享负载存储；需要独立副本时使用 Clone()
+    Packet Clone() const;
     Packet Ack() const;
     void Send();
     
 private:
     PacketHeader header_;
+    uint32_t payload_crc_;
     Data data_;
+    uint64_t received_ns_;
+    bool has_payload_crc_;
 };
 
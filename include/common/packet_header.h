@@ -8,9 +8,19 @@ enum class PacketHeaderCommand : uint32_t {
     ACK = 1,
     ERROR = 2,
     READ_EOF = 3,
-    WRITE_CLOSED = 4
+    WRITE_CLOSED = 4,
+    // 请求服务端指标：应答同为 STATS，负载为纯文本指标
+    STATS = 10,
+    // 模拟耗时处理：服务端占用 CPU extra2 低 31 位所示的微秒数后原样回射，配置了卸载线程池时在池线程中执行；
+    // extra2 带 kWorkUnordered 时应答可以先于同一连接上更早的请求返回，对端按 extra1 匹配。
+    // 服务端默认不处理；未开启、超过上限或卸载池已满时应答 ERROR（无负载，extra1 不变）
+    WORK = 11
 };
 
+constexpr uint32_t kWorkUnordered = 1u << 31;
+// 单个 WORK 请求可占用 CPU 的硬上限（微秒），服务端配置的上限不能超过它
+constexpr uint32_t kMaxWorkUs = 10000;
+
 struct PacketHeader {
     uint32_t command;
     uint32_t length;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// SlabAllocator 类定义
+// 负载缓冲区的分级池化分配器：容量按 2 的幂向上取整到 size class，
+// 每个线程（即每个 Reactor）持有自己的空闲链表缓存，分配/释放不加锁；
+// 超过最大 class 的大帧直接走堆分配。
+// 每个 slot 在负载之前预留 kSlotHeader 字节，供 DataBlock 存放引用计数等块头。
+
+struct SlabConfig {
+    // 最小/最大 size class（字节，2 的幂）；超过 max_class_size 的请求走堆
+    size_t min_class_size = 64;
+    size_t max_class_size = 1 << 20;
+    // 每个线程每个 class 最多缓存的空闲 slot 数
+    size_t max_cached_per_class = 1024;
+    // 每个线程缓存的空闲字节上限
+    size_t max_cached_bytes = 64 << 20;
+};
+
+struct SlabStats {
+    uint64_t hits = 0;          // 命中线程缓存
+    uint64_t misses = 0;        // 缓存为空，从堆分配新 slot
+    uint64_t oversized = 0;     // 超过最大 class，直接走堆
+    uint64_t releases = 0;      // 因缓存已满归还给堆的 slot
+    uint64_t bytes_pooled = 0;  // 当前缓存中的空闲字节数
+};
+
+class SlabAllocator {
+public:
+    static constexpr size_t kSlotHeader = 32;
+    
+    // 需在任何线程开始分配前调用
+    static void Configure(const SlabConfig& config);
+    static const SlabConfig& config();
+    
+    // 返回至少 kSlotHeader + capacity 字节的内存，*class_capacity 为实际可用的负载容量
+    static void* Allocate(size_t capacity, size_t* class_capacity);
+    // class_capacity 必须是 Allocate 返回的值
+    static void Deallocate(void* slot, size_t class_capacity);
+    
+    // 汇总所有线程（含已退出线程）的统计，仅在读取时聚合
+    static SlabStats Stats();
+};
@@ -0,0 +1,426 @@
+#pragma once
+
+#include "packet_header.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 线上包头编解码
+// 包头在线上的布局在编译期用字段列表描述：每个字段对应 PacketHeader 的一个成员，指定线上宽度与字节序，
+// 可选字段值为 0 时不出现在线上，由布局中的 PresenceMask 位图标记。
+// HeaderLayout 据此生成定长、无分支的编解码函数（可选字段用条件选择代替跳转）；
+// WireFormat 把一个布局包装成运行时可选的描述，TcpEpoller 与压测客户端只通过它收发，
+// 新增帧格式不需要修改 I/O 代码。变长编码等无法用字段列表描述的格式（如 CompactHeaderCodec）
+// 只需提供与 HeaderLayout 相同的静态接口。
+
+enum class ByteOrder {
+    LITTLE,
+    BIG
+};
+
+namespace wire {
+
+template <size_t Width>
+struct UintOf;
+template <>
+struct UintOf<1> { using type = uint8_t; };
+template <>
+struct UintOf<2> { using type = uint16_t; };
+template <>
+struct UintOf<4> { using type = uint32_t; };
+
+template <typename T>
+constexpr T ByteSwap(T value) {
+    if constexpr (sizeof(T) == 1) {
+        return value;
+    } else if constexpr (sizeof(T) == 2) {
+        return __builtin_bswap16(value);
+    } else {
+        return __builtin_bswap32(value);
+    }
+}
+
+// 按线上字节序读写 Width 字节的无符号整数；与主机序一致时就是一次 memcpy
+template <size_t Width, ByteOrder Order>
+inline uint32_t Load(const uint8_t* in) {
+    using T = typename UintOf<Width>::type;
+    T value;
+    std::memcpy(&value, in, Width);
+    if constexpr ((Order == ByteOrder::BIG) != (std::endian::native == std::endian::big)) {
+        value = ByteSwap(value);
+    }
+    return value;
+}
+
+template <size_t Width, ByteOrder Order>
+inline void Store(uint8_t* out, uint32_t value) {
+    using T = typename UintOf<Width>::type;
+    T narrowed = static_cast<T>(value);
+    if constexpr ((Order == ByteOrder::BIG) != (std::endian::native == std::endian::big)) {
+        narrowed = ByteSwap(narrowed);
+    }
+    std::memcpy(out, &narrowed, Width);
+}
+
+// 编解码过程中的游标与可选字段位图
+struct Cursor {
+    size_t offset = 0;
+    uint32_t presence = 0;
+    unsigned optional_index = 0;
+};
+
+// 解码可选字段缺席时读取的零字节
+inline constexpr uint8_t kZeroBytes[4] = {0, 0, 0, 0};
+
+}  // namespace wire
+
+// 定长字段：PacketHeader::*Member 在线上占 Width 字节（1/2/4），编码时截断到该宽度
+template <uint32_t PacketHeader::*Member, size_t Width, ByteOrder Order = ByteOrder::LITTLE>
+struct Field {
+    static_assert(Width == 1 || Width == 2 || Width == 4, "field width must be 1, 2 or 4 bytes");
+    static constexpr size_t kMinSize = Width;
+    static constexpr size_t kMaxSize = Width;
+    static constexpr bool kOptional = false;
+    static constexpr bool kPresence = false;
+    static constexpr bool kHostLayout = Width == 4 && (Order == ByteOrder::BIG) == (std::endian::native == std::endian::big);
+    static constexpr uint32_t PacketHeader::*kMember = Member;
+    
+    static bool Present(const PacketHeader&) { return true; }
+    static void Encode(const PacketHeader& header, uint8_t* out, wire::Cursor& cursor) {
+        wire::Store<Width, Order>(out + cursor.offset, header.*Member);
+        cursor.offset += Width;
+    }
+    static void Decode(const uint8_t* in, PacketHeader* header, wire::Cursor& cursor) {
+        header->*Member = wire::Load<Width, Order>(in + cursor.offset);
+        cursor.offset += Width;
+    }
+};
+
+// 可选字段：值为 0 时不占线上空间，是否出现由此前的 PresenceMask 中按声明顺序分配的位标记
+template <uint32_t PacketHeader::*Member, size_t Width, ByteOrder Order = ByteOrder::LITTLE>
+struct OptionalField {
+    static_assert(Width == 1 || Width == 2 || Width == 4, "field width must be 1, 2 or 4 bytes");
+    static constexpr size_t kMinSize = 0;
+    static constexpr size_t kMaxSize = Width;
+    static constexpr bool kOptional = true;
+    static constexpr bool kPresence = false;
+    static constexpr bool kHostLayout = false;
+    
+    static bool Present(const PacketHeader& header) { return header.*Member != 0; }
+    static void Encode(const PacketHeader& header, uint8_t* out, wire::Cursor& cursor) {
+        uint32_t present = (cursor.presence >> cursor.optional_index++) & 1;
+        // 缺席时仍写入（值为 0），但游标不前进，后续字段会覆盖
+        wire::Store<Width, Order>(out + cursor.offset, header.*Member);
+        cursor.offset += present * Width;
+    }
+    static void Decode(const uint8_t* in, PacketHeader* header, wire::Cursor& cursor) {
+        uint32_t present = (cursor.presence >> cursor.optional_index++) & 1;
+        const uint8_t* source = present ? in + cursor.offset : wire::kZeroBytes;
+        header->*Member = wire::Load<Width, Order>(source);
+        cursor.offset += present * Width;
+    }
+};
+
+// 可选字段位图，占 1 字节，必须位于所有可选字段之前、且之前只有定长字段
+struct PresenceMask {
+    static constexpr size_t kMinSize = 1;
+    static constexpr size_t kMaxSize = 1;
+    static constexpr bool kOptional = false;
+    static constexpr bool kPresence = true;
+    static constexpr bool kHostLayout = false;
+    
+    static bool Present(const PacketHeader&) { return true; }
+    static void Encode(const PacketHeader&, uint8_t* out, wire::Cursor& cursor) {
+        out[cursor.offset++] = static_cast<uint8_t>(cursor.presence);
+    }
+    static void Decode(const uint8_t* in, PacketHeader*, wire::Cursor& cursor) {
+        cursor.presence = in[cursor.offset++];
+    }
+};
+
+namespace wire {
+
+inline constexpr size_t kNoPresence = ~size_t(0);
+
+// PresenceMask 在包头中的偏移；位置不合法（其前有可选字段或有多个位图）时返回 kNoPresence
+template <typename... Fields>
+constexpr size_t PresenceOffset() {
+    size_t offset = 0;
+    size_t found = kNoPresence;
+    bool optional_seen = false;
+    bool valid = true;
+    auto visit = [&](size_t min_size, size_t max_size, bool optional, bool presence) {
+        if (presence) {
+            valid = valid && found == kNoPresence && !optional_seen;
+            found = offset;
+        }
+        optional_seen = optional_seen || optional;
+        valid = valid && (found != kNoPresence || min_size == max_size);
+        offset += max_size;
+    };
+    (visit(Fields::kMinSize, Fields::kMaxSize, Fields::kOptional, Fields::kPresence), ...);
+    return valid ? found : kNoPresence;
+}
+
+// 字段是否按 PacketHeader 的成员顺序排列
+template <typename... Fields>
+constexpr bool IsMemberOrder() {
+    if constexpr (sizeof...(Fields) == 5 && (Fields::kHostLayout && ...)) {
+        uint32_t PacketHeader::*const members[] = {Fields::kMember...};
+        uint32_t PacketHeader::*const expected[] = {&PacketHeader::command, &PacketHeader::length, &PacketHeader::error,
+                                                     &PacketHeader::extra1, &PacketHeader::extra2};
+        for (size_t i = 0; i < sizeof...(Fields); i++) {
+            if (members[i] != expected[i]) {
+                return false;
+            }
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+}  // namespace wire
+
+template <typename... Fields>
+class HeaderLayout {
+public:
+    static constexpr size_t kMinSize = (Fields::kMinSize + ...);
+    static constexpr size_t kMaxSize = (Fields::kMaxSize + ...);
+    static constexpr size_t kOptionalCount = (size_t(Fields::kOptional) + ...);
+    // 线上字节与 PacketHeader 的内存表示完全相同，可直接 memcpy 或把 iovec 指向 header
+    static constexpr bool kHostLayout = sizeof...(Fields) == 5 && kMinSize == sizeof(PacketHeader) &&
+                                        (Fields::kHostLayout && ...) && wire::IsMemberOrder<Fields...>();
+    
+    // 定长布局不通过首字节协商
+    static constexpr uint8_t kMagic = 0;
+    
+    static_assert(kOptionalCount <= 8, "at most 8 optional fields per layout");
+    static_assert(kOptionalCount == 0 || wire::PresenceOffset<Fields...>() != wire::kNoPresence,
+                  "optional fields need a PresenceMask before them, preceded only by fixed fields");
+    
+    static size_t EncodedSize(const PacketHeader& header) {
+        return kMinSize + OptionalBytes(ComputePresence(header));
+    }
+    
+    // out 至少 kMaxSize 字节，返回写入的字节数
+    static size_t Encode(const PacketHeader& header, uint8_t* out) {
+        wire::Cursor cursor;
+        cursor.presence = ComputePresence(header);
+        (Fields::Encode(header, out, cursor), ...);
+        return cursor.offset;
+    }
+    
+    // 返回消耗的字节数；in 中数据不足一个完整包头时返回 0（定长布局不会出现格式错误）
+    static int Decode(const uint8_t* in, size_t available, PacketHeader* header) {
+        if (available < kMinSize) {
+            return 0;
+        }
+        wire::Cursor cursor;
+        if constexpr (kOptionalCount > 0) {
+            size_t size = kMinSize + OptionalBytes(in[wire::PresenceOffset<Fields...>()]);
+            if (available < size) {
+                return 0;
+            }
+        }
+        (Fields::Decode(in, header, cursor), ...);
+        return static_cast<int>(cursor.offset);
+    }
+
+private:
+    static uint32_t ComputePresence(const PacketHeader& header) {
+        uint32_t presence = 0;
+        unsigned index = 0;
+        auto visit = [&](bool optional, bool present) {
+            if (optional) {
+                presence |= uint32_t(present) << index++;
+            }
+        };
+        (visit(Fields::kOptional, Fields::Present(header)), ...);
+        return presence;
+    }
+    
+    static size_t OptionalBytes(uint32_t presence) {
+        size_t bytes = 0;
+        unsigned index = 0;
+        auto visit = [&](bool optional, size_t width) {
+            if (optional) {
+                bytes += ((presence >> index++) & 1) * width;
+            }
+        };
+        (visit(Fields::kOptional, Fields::kMaxSize), ...);
+        return bytes;
+    }
+};
+
+// CompactHeaderCodec 紧凑帧格式，面向小消息
+// 首字节低 3 位标记 error/extra1/extra2 是否出现，其后依次为 length、command 与出现的字段，均为 LEB128 变长整数。
+// 64 字节以内的 DEFAULT 请求包头只有 3~4 字节（原格式 20 字节）。连接以 kMagic 开头即协商使用该格式。
+class CompactHeaderCodec {
+public:
+    static constexpr size_t kMinSize = 3;
+    static constexpr size_t kMaxSize = 1 + 5 * 5;
+    static constexpr bool kHostLayout = false;
+    // 原格式首字节为 command 的低字节（小端）或高字节（网络序），内置命令都不会等于该值
+    static constexpr uint8_t kMagic = 0xC5;
+    
+    static size_t EncodedSize(const PacketHeader& header);
+    static size_t Encode(const PacketHeader& header, uint8_t* out);
+    // 返回消耗的字节数；数据不足时返回 0，标志位或变长整数非法时返回 -1
+    static int Decode(const uint8_t* in, size_t available, PacketHeader* header);
+};
+
+namespace wire {
+
+inline size_t VarintSize(uint32_t value) {
+    // 每 7 位一个字节：(31 - clz + 7) / 7，value 为 0 时按 1 字节
+    return (static_cast<size_t>(std::bit_width(value | 1)) + 6) / 7;
+}
+
+inline uint8_t* EncodeVarint(uint32_t value, uint8_t* out) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// 返回解码后的下一个位置；数据不足返回 nullptr 并置 *truncated，超过 5 字节或溢出 32 位返回 nullptr
+inline const uint8_t* DecodeVarint(const uint8_t* in, const uint8_t* end, uint32_t* value, bool* truncated) {
+    // 绝大多数字段只有 1 字节
+    if (in < end && *in < 0x80) {
+        *value = *in;
+        return in + 1;
+    }
+    uint32_t result = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (in == end) {
+            *truncated = true;
+            return nullptr;
+        }
+        uint8_t byte = *in++;
+        if (shift == 28 && byte > 0x0F) {
+            return nullptr;
+        }
+        result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            *value = result;
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace wire
+
+inline size_t CompactHeaderCodec::EncodedSize(const PacketHeader& header) {
+    size_t size = 1 + wire::VarintSize(header.length) + wire::VarintSize(header.command);
+    size += header.error ? wire::VarintSize(header.error) : 0;
+    size += header.extra1 ? wire::VarintSize(header.extra1) : 0;
+    size += header.extra2 ? wire::VarintSize(header.extra2) : 0;
+    return size;
+}
+
+inline size_t CompactHeaderCodec::Encode(const PacketHeader& header, uint8_t* out) {
+    uint8_t* cursor = out;
+    *cursor++ = static_cast<uint8_t>((header.error ? 1 : 0) | (header.extra1 ? 2 : 0) | (header.extra2 ? 4 : 0));
+    cursor = wire::EncodeVarint(header.length, cursor);
+    cursor = wire::EncodeVarint(header.command, cursor);
+    if (header.error) {
+        cursor = wire::EncodeVarint(header.error, cursor);
+    }
+    if (header.extra1) {
+        cursor = wire::EncodeVarint(header.extra1, cursor);
+    }
+    if (header.extra2) {
+        cursor = wire::EncodeVarint(header.extra2, cursor);
+    }
+    return static_cast<size_t>(cursor - out);
+}
+
+inline int CompactHeaderCodec::Decode(const uint8_t* in, size_t available, PacketHeader* header) {
+    if (available < kMinSize) {
+        return 0;
+    }
+    uint8_t flags = in[0];
+    if (flags > 7) {
+        return -1;
+    }
+    const uint8_t* end = in + available;
+    const uint8_t* cursor = in + 1;
+    bool truncated = false;
+    PacketHeader decoded{};
+    // length、command 必有，其余按标志位；cursor 为 nullptr 后不再继续
+    cursor = wire::DecodeVarint(cursor, end, &decoded.length, &truncated);
+    cursor = cursor ? wire::DecodeVarint(cursor, end, &decoded.command, &truncated) : nullptr;
+    if (cursor && (flags & 1)) {
+        cursor = wire::DecodeVarint(cursor, end, &decoded.error, &truncated);
+    }
+    if (cursor && (flags & 2)) {
+        cursor = wire::DecodeVarint(cursor, end, &decoded.extra1, &truncated);
+    }
+    if (cursor && (flags & 4)) {
+        cursor = wire::DecodeVarint(cursor, end, &decoded.extra2, &truncated);
+    }
+    if (!cursor) {
+        return truncated ? 0 : -1;
+    }
+    *header = decoded;
+    return static_cast<int>(cursor - in);
+}
+
+// 包头在线上的最大字节数，收发路径按此预留编码空间
+constexpr size_t kMaxWireHeaderSize = 32;
+
+// 帧校验尾部：连接开头出现 kChecksumMagic（可与格式的 magic 任意先后）时，此后双向每帧负载之后跟 4 字节小端 CRC32C，
+// 依次覆盖负载与线上包头字节。负载在前，发送方入队时算一次即可，包头编码后再续上
+constexpr uint8_t kChecksumMagic = 0xCC;
+constexpr size_t kChecksumSize = 4;
+
+// WireFormat 帧格式的运行时描述，由 MakeWireFormat 从编译期布局生成
+struct WireFormat {
+    const char* name;
+    size_t min_header_size;
+    size_t max_header_size;
+    bool host_layout;
+    // 非 0 时，连接的第一个字节为该值表示之后的帧使用此格式（见 TcpEpoller::SetNegotiableFormat）
+    uint8_t magic;
+    size_t (*encoded_size)(const PacketHeader& header);
+    size_t (*encode)(const PacketHeader& header, uint8_t* out);
+    // 返回消耗的字节数；数据不足时返回 0，格式错误返回 -1
+    int (*decode)(const uint8_t* in, size_t available, PacketHeader* header);
+    
+    // 默认格式：主机序 20 字节，与原先直接收发 PacketHeader 结构体兼容
+    static const WireFormat& Native();
+    // 小消息用的紧凑格式（CompactHeaderCodec），服务端默认允许连接通过首字节协商使用
+    static const WireFormat& Compact();
+    // 按名称查找内置格式（native/network/slim/compact），未知名称返回 nullptr
+    static const WireFormat* Find(const char* name);
+};
+
+template <typename Layout>
+constexpr WireFormat MakeWireFormat(const char* name) {
+    static_assert(Layout::kMaxSize <= kMaxWireHeaderSize, "header layout exceeds kMaxWireHeaderSize");
+    return WireFormat{name, Layout::kMinSize, Layout::kMaxSize, Layout::kHostLayout, Layout::kMagic,
+                      &Layout::EncodedSize, &Layout::Encode, &Layout::Decode};
+}
+
+// 原有布局：五个 32 位字段，小端
+using NativeHeaderLayout = HeaderLayout<Field<&PacketHeader::command, 4>, Field<&PacketHeader::length, 4>,
+                                        Field<&PacketHeader::error, 4>, Field<&PacketHeader::extra1, 4>,
+                                        Field<&PacketHeader::extra2, 4>>;
+
+// 网络字节序的同一布局，用于与大端主机互通
+using NetworkHeaderLayout =
+    HeaderLayout<Field<&PacketHeader::command, 4, ByteOrder::BIG>, Field<&PacketHeader::length, 4, ByteOrder::BIG>,
+                 Field<&PacketHeader::error, 4, ByteOrder::BIG>, Field<&PacketHeader::extra1, 4, ByteOrder::BIG>,
+                 Field<&PacketHeader::extra2, 4, ByteOrder::BIG>>;
+
+// 网络字节序，error/extra1/extra2 为 0 时省略：常见的请求只有 9 字节包头
+using SlimHeaderLayout =
+    HeaderLayout<Field<&PacketHeader::command, 4, ByteOrder::BIG>, Field<&PacketHeader::length, 4, ByteOrder::BIG>,
+                 PresenceMask, OptionalField<&PacketHeader::error, 4, ByteOrder::BIG>,
+                 OptionalField<&PacketHeader::extra1, 4, ByteOrder::BIG>,
+                 OptionalField<&PacketHeader::extra2, 4, ByteOrder::BIG>>;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "center.h"
+#include <memory>
+#include <vector>
+
+class Epoller;
+class PlacementPolicy;
+
+// AcceptorCenter 类定义
+// Acceptor/Worker 模式中的接入线程：只运行 accept4 循环，
+// 按 PlacementPolicy 把新连接 fd 投递给 Worker Center，自身不持有任何连接。
+
+class AcceptorCenter : public Center {
+public:
+    AcceptorCenter(const std::vector<std::unique_ptr<Center>>& workers, PlacementPolicy& placement);
+    virtual ~AcceptorCenter();
+    
+protected:
+    virtual void HandleAccepted(int fd) override;
+    virtual std::unique_ptr<Epoller> NewConnectionEpoller(int fd) override;
+    
+private:
+    const std::vector<std::unique_ptr<Center>>& workers_;
+    PlacementPolicy& placement_;
+};
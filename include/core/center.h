@@ -2,7 +2,17 @@
 
 #include <memory>
 #include <cstdint>
+#include <array>
+#include <deque>
+#include <functional>
 #include <map>
+#include <vector>
+#include <atomic>
+#include "mpsc_queue.h"
+#include "metrics.h"
+#include "timer_wheel.h"
+#include "../net/endpoint.h"
+#include "../net/epoller.h"
 
 #ifdef _WIN32
 // Windows 下不支持epoll，我们需要做特殊处理
@@ -12,32 +22,201 @@
 #include <sys/epoll.h>
 #endif
 
-class Epoller;
+class OffloadPool;
+class PlacementPolicy;
+struct msghdr;
+
+// 连接超时（毫秒），0 表示不检查；检测粒度为一个周期，即实际关闭发生在超时后的 1~2 个周期内
+struct ConnectionTimeouts {
+    // 既无读也无写的空闲时长
+    uint32_t idle_ms = 300000;
+    // 一帧从收到首字节起必须在该时长内收全（防止逐字节发送的慢速连接）
+    uint32_t read_ms = 30000;
+    // 发送队列非空但没有任何写出进展的时长
+    uint32_t write_ms = 60000;
+};
 
 // Center 类定义
 // 负责监听、接入连接、事件轮询与资源回收
+// 每个 Center 是一个独立的 Reactor：多线程模式下每个线程各持有一个 Center，
+// 彼此不共享 epoll_fd_/epollers_，收发路径上无锁
+// 可同时监听多个地址（IPv4/IPv6 TCP、Unix 域 socket），各地址接入的连接由同一个 NewConnectionEpoller 处理
+// 默认基于 epoll；Init/Run 及监听socket、Epoller 注册相关接口为虚函数，
+// 其他 I/O 后端（如 IoUringCenter）覆写它们并复用连接管理逻辑
 
 class Center {
 public:
     Center();
     virtual ~Center();
     
+    // 多 Reactor 模式下需在 Listen 之前开启，使多个监听socket绑定同一端口
+    void SetReusePort(bool reuse_port) { reuse_port_ = reuse_port; }
+    // 以 EPOLLET 注册新连接；读写排空到 EAGAIN，预算用尽的连接进入就绪列表
+    void SetEdgeTriggered(bool edge_triggered) { edge_triggered_ = edge_triggered; }
+    void SetTimeouts(const ConnectionTimeouts& timeouts) { timeouts_ = timeouts; }
+    const ConnectionTimeouts& timeouts() const { return timeouts_; }
+    // 延迟写出：Send 只入队并标记连接，本轮事件全部处理完后每个连接统一写出一次，
+    // 同一批事件中各次读到的应答合并为一次聚合写；Epoller::SetImmediateFlush 可按连接退出
+    void SetDeferredFlush(bool deferred_flush) { deferred_flush_ = deferred_flush; }
+    bool deferred_flush() const { return deferred_flush_; }
+    // 是否接受连接协商共享内存环（见 TcpEpoller::SetNegotiableRing），默认拒绝
+    void SetRingEnabled(bool enabled) { ring_enabled_ = enabled; }
+    bool ring_enabled() const { return ring_enabled_; }
+    // 共享内存环连接在最后一次收到数据后继续忙轮询的时长（微秒），之后才在门铃上休眠；0 表示处理完即休眠
+    void SetRingPollUs(uint32_t poll_us) { ring_poll_us_ = poll_us; }
+    uint32_t ring_poll_us() const { return ring_poll_us_; }
+    // 各优先级连接每次调度的读写预算（见 IoBudget）；默认 HIGH/NORMAL 为 256KB、64 帧，BULK 为 64KB、16 帧
+    void SetIoBudget(IoPriority priority, const IoBudget& budget);
+    const IoBudget& io_budget(IoPriority priority) const { return io_budgets_[static_cast<size_t>(priority)]; }
+    // 收到负载不小于该字节数的帧的连接自动降为 BULK，之后不再升回；0 表示不自动分类
+    void SetBulkFrameBytes(size_t bytes) { bulk_frame_bytes_ = bytes; }
+    size_t bulk_frame_bytes() const { return bulk_frame_bytes_; }
+    // 耗时处理的卸载线程池，可由多个 Center 共用；需在 Run 之前设置，且在所有 Center 析构之前 Stop
+    void SetOffloadPool(OffloadPool* pool) { offload_pool_ = pool; }
+    OffloadPool* offload_pool() const { return offload_pool_; }
+    
+    // 创建epoll实例与唤醒eventfd；Listen 会自动调用，Worker Center 需在投递连接前调用
+    virtual bool Init();
+    // 打开 endpoint 的监听socket并开始接入；可多次调用以同时监听多个地址。
+    // 数据报地址（udp:）不需要接入，socket 直接交给 NewDatagramEpoller 创建的 Epoller 收发
+    bool Listen(const Endpoint& endpoint);
     bool Listen(const char* host, uint16_t port);
-    void Run();
+    // 接入的连接按 placement 在 peers（可包含自身）间分配：分给自身的直接处理，其他经 PostConnection 投递。
+    // 用于不能 SO_REUSEPORT 的 Unix 域 socket，由一个 Center 接入后分给同组的各 Center；
+    // peers 与 placement 需在本 Center 运行期间保持有效，placement 只在本线程中调用
+    bool Listen(const Endpoint& endpoint, const std::vector<std::unique_ptr<Center>>& peers, PlacementPolicy& placement);
+    virtual void Run();
+    // 可在其他线程或信号处理函数中调用，仅置位并唤醒事件循环
     void Stop();
     
+    // 线程安全：把已 accept 的连接交给本 Center，在本 Center 的线程中创建 Epoller
+    void PostConnection(int fd);
+    // 线程安全：当前持有及待接入的连接数，供 PlacementPolicy 使用
+    size_t ConnectionCount() const;
+    // 线程安全：把 task 交给本 Center 的线程，在下一次被唤醒时执行
+    void QueueInLoop(std::function<void()> task);
+    
+    // 供 Epoller 回调：按 Events() 重新注册兴趣事件
+    virtual void UpdateEpoller(Epoller* epoller);
+    // 供 Epoller 回调：fd 已被关闭，本轮事件处理结束后回收
+    virtual void OnEpollerClosed(Epoller* epoller, int fd);
+    // 供 Epoller 回调：延迟写出模式下加入待写出列表，重复调用只保留一项
+    void ScheduleFlush(Epoller* epoller);
+    // 供 Epoller 回调（仅完成式后端）：按顺序提交 count 个链接在一起的 sendmsg，
+    // 每个完成后回调 Epoller::OutCompleted；msgs 在全部完成前必须保持有效
+    virtual bool SubmitSend(Epoller* epoller, msghdr* msgs, size_t count);
+    // 供 Epoller 回调：除自身 fd 外再以水平触发关注 fd 的可读事件，事件同样交给 epoller->In()；
+    // 不支持的后端返回 false。fd 可能与其他进程共享，关闭前必须先 UnwatchReadable
+    virtual bool WatchReadable(Epoller* epoller, int fd);
+    void UnwatchReadable(int fd);
+    // 供 Epoller 回调：work 在卸载线程池中执行，完成后回到本 Center 的线程调用 done。
+    // 期间 epoller 即使已关闭也不会被回收，done 需先检查 GetFd()。没有线程池或池已满时返回 false，两者都不会被调用
+    bool Offload(Epoller* epoller, std::function<void()> work, std::function<void()> done);
+    
+    // 本 Reactor 的指标，只在本 Center 的线程中更新
+    ReactorMetrics& metrics() { return metrics_; }
+    // 本 Reactor 的定时轮，只能在本 Center 的线程中使用
+    TimerWheel& timers() { return timers_; }
+    
 protected:
+    // accept4 得到新连接后调用，默认在本线程创建 Epoller
+    virtual void HandleAccepted(int fd);
+    // 监听socket index 上接入了 fd：按该监听socket的分配方式交给 HandleAccepted 或同组的其他 Center
+    void DispatchAccepted(size_t index, int fd);
     virtual std::unique_ptr<Epoller> NewConnectionEpoller(int fd) = 0;
+    // 为已绑定的 UDP socket 创建 Epoller，默认不支持数据报，返回空
+    virtual std::unique_ptr<Epoller> NewDatagramEpoller(int fd);
+    // I/O 后端能否以就绪通知驱动数据报 Epoller
+    virtual bool SupportsDatagram() const { return true; }
     int GetFd(const Epoller* epoller) const;
     void AddEpoller(std::unique_ptr<Epoller> epoller);
+    // 移出连接表并把 Epoller 的 fd 标记为失效（由调用方关闭），本轮事件处理结束后析构
     void RemoveEpoller(Epoller* epoller);
     
+    // I/O 后端相关：开始在 listen_fd(index) 上接入，把新连接加入/移出事件源
+    virtual bool RegisterListenSocket(size_t index);
+    virtual bool RegisterEpoller(Epoller* epoller);
+    virtual void UnregisterEpoller(Epoller* epoller);
+    
+    // 供 I/O 后端复用的公共步骤
+    bool InitWakeup();
+    void AcceptConnection(int fd);
+    void DrainWakeup();
+    void DrainPostedConnections();
+    void DrainQueuedTasks();
+    void ReapClosedEpollers();
+    // 事件等待的超时：有待调度的连接时为 0，否则为最近定时器的到期时间（无定时器时 -1）
+    int WaitTimeoutMs() const;
+    // 按当前时间推进定时轮
+    void AdvanceTimers();
+    // 写出本轮标记的连接；在一批事件（含就绪列表）处理完之后、回收关闭的连接之前调用
+    void FlushDirty();
+    bool stop_requested() const { return stop_requested_.load(std::memory_order_acquire); }
+    int listen_fd(size_t index) const { return listen_sockets_[index].fd; }
+    int wakeup_fd() const { return wakeup_fd_; }
+    
+    // 访问 Epoller 中由 Center 维护的状态（友元关系不向子类继承）
+    static void SetAsyncIo(Epoller* epoller, bool async_io);
+    static void AddInflight(Epoller* epoller, int delta);
+    static uint32_t RegisteredEvents(const Epoller* epoller);
+    static void SetRegisteredEvents(Epoller* epoller, uint32_t events);
+    static bool RecvArmed(const Epoller* epoller);
+    static void SetRecvArmed(Epoller* epoller, bool armed);
+    
 private:
-    int listen_fd_;
+    struct ListenSocket {
+        int fd;
+        // 非空时接入的连接按 placement 分给 peers 中的 Center
+        const std::vector<std::unique_ptr<Center>>* peers;
+        PlacementPolicy* placement;
+    };
+    
+    void ScheduleIfPending(Epoller* epoller);
+    void Unschedule(Epoller* epoller);
+    bool ListenDatagram(const Endpoint& endpoint);
+    // 接管 fd 并开始接入，失败时关闭 fd
+    bool AddListenSocket(int fd, const std::vector<std::unique_ptr<Center>>* peers, PlacementPolicy* placement);
+    // 返回监听socket下标，不是监听socket时返回 -1
+    int FindListenSocket(int fd) const;
+    // 就绪的监听socket上 accept 到 EAGAIN
+    void AcceptPending(size_t index);
+    void RunReadyList();
+    void Wakeup();
+    void Shutdown();
+    
+    // 监听socket，个数很少，事件分发时线性查找
+    std::vector<ListenSocket> listen_sockets_;
+    // 本 Center 绑定的文件系统路径 Unix 域 socket，关闭时删除 socket 文件
+    std::vector<Endpoint> socket_files_;
     int epoll_fd_;
-    bool running_;
+    int wakeup_fd_;
+    bool reuse_port_;
+    bool edge_triggered_;
+    bool deferred_flush_;
+    bool ring_enabled_;
+    uint32_t ring_poll_us_;
+    OffloadPool* offload_pool_;
+    ConnectionTimeouts timeouts_;
+    std::atomic<bool> stop_requested_;
     std::map<int, std::unique_ptr<Epoller>> epollers_;
+    // 已自行关闭、等待回收的 Epoller；仍有未完成的异步操作时继续保留
+    std::vector<std::unique_ptr<Epoller>> closed_epollers_;
+    // 预算用尽后仍有未处理数据的连接，按优先级各一个列表，在下一次 epoll_wait 之前轮流调度
+    std::array<std::deque<Epoller*>, kIoPriorityCount> ready_lists_;
+    std::array<IoBudget, kIoPriorityCount> io_budgets_;
+    size_t bulk_frame_bytes_;
+    // 延迟写出模式下本轮有新入队数据的连接
+    std::vector<Epoller*> flush_list_;
+    
+    // 跨线程投递的新连接
+    MpscQueue<int> posted_fds_;
+    std::atomic<size_t> posted_count_;
+    std::atomic<size_t> connection_count_;
+    // 跨线程投递到本线程执行的任务（卸载处理的完成回调等）
+    MpscQueue<std::function<void()>> queued_tasks_;
+    
+    ReactorMetrics metrics_;
+    TimerWheel timers_;
     
     static constexpr int MAX_EVENTS = 1024;
 };
-
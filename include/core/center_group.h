@@ -0,0 +1,53 @@
+#pragma once
+
+#include "center.h"
+#include "placement_policy.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// CenterGroup 类定义
+// 多 Reactor 模式：持有 N 个 Center，每个 Center 在独立线程中运行自己的事件循环，
+// 连接建立后只在所属线程内处理，收发路径上不共享锁。支持两种线程模型：
+//   REUSE_PORT：各 Center 拥有独立的 SO_REUSEPORT 监听socket，由内核分发新连接；
+//               Unix 域 socket 不支持 SO_REUSEPORT，由第一个 Center 接入后按 PlacementPolicy 分给各 Center；
+//               UDP 地址在每个 Center（ACCEPTOR 模式下为每个 Worker）上各绑定一个 SO_REUSEPORT socket；
+//   ACCEPTOR：单独的 Acceptor 线程运行 accept4 循环，经无锁队列 + eventfd
+//             把连接交给 Worker Center，分配方式由 PlacementPolicy 决定。
+
+enum class ThreadingModel {
+    REUSE_PORT,
+    ACCEPTOR
+};
+
+class CenterGroup {
+public:
+    using Factory = std::function<std::unique_ptr<Center>()>;
+    
+    // placement 用于 ACCEPTOR 模式，以及 REUSE_PORT 模式下的 Unix 域 socket，为空时默认轮询
+    CenterGroup(Factory factory, size_t thread_count,
+                ThreadingModel model = ThreadingModel::REUSE_PORT,
+                std::unique_ptr<PlacementPolicy> placement = nullptr);
+    ~CenterGroup();
+    
+    CenterGroup(const CenterGroup&) = delete;
+    CenterGroup& operator=(const CenterGroup&) = delete;
+    
+    bool Listen(const char* host, uint16_t port);
+    // 同时监听多个地址，所有地址接入的连接都由 Factory 创建的 Center 处理
+    bool Listen(const std::vector<Endpoint>& endpoints);
+    // 阻塞直到所有事件循环退出；第一个 Center（ACCEPTOR 模式下为 Acceptor）在调用线程上运行
+    void Run();
+    // 可在信号处理函数中调用
+    void Stop();
+    
+    size_t size() const { return centers_.size(); }
+    
+private:
+    ThreadingModel model_;
+    std::unique_ptr<PlacementPolicy> placement_;
+    std::vector<std::unique_ptr<Center>> centers_;
+    std::unique_ptr<Center> acceptor_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+// IoUring 类定义
+// io_uring 的最小封装：直接使用 io_uring_setup/enter/register 系统调用与共享环，
+// 不依赖 liburing。只允许单线程使用（即所属 Center 的事件循环线程）。
+
+class IoUring {
+public:
+    IoUring();
+    ~IoUring();
+    
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    
+    bool Init(unsigned entries);
+    void Close();
+    bool IsOpen() const { return ring_fd_ >= 0; }
+    
+    // 取一个空闲 SQE（已清零）；提交队列已满时返回 nullptr
+    io_uring_sqe* GetSqe();
+    // 提交队列剩余的空闲 SQE 数
+    unsigned SpaceLeft() const;
+    // 提交所有已准备的 SQE，并至少等待 wait_nr 个完成，timeout_ms >= 0 时最多等待该时长（超时返回 -ETIME）；
+    // 返回值同 io_uring_enter（负值为 -errno）
+    int Submit(unsigned wait_nr = 0, int timeout_ms = -1);
+    
+    // 依次处理所有已就绪的 CQE，处理完后统一推进 CQ 头
+    template <typename Fn>
+    unsigned ForEachCqe(Fn&& fn) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned count = tail - head;
+        for (; head != tail; head++) {
+            fn(cqes_[head & *cq_mask_]);
+        }
+        __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+        return count;
+    }
+    
+    int Register(unsigned opcode, void* arg, unsigned nr_args);
+    int fd() const { return ring_fd_; }
+    
+private:
+    int ring_fd_;
+    unsigned entries_;
+    
+    void* sq_ring_;
+    size_t sq_ring_size_;
+    void* cq_ring_;
+    size_t cq_ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    // 本地已准备但尚未发布给内核的 SQE 尾
+    unsigned sqe_tail_;
+    
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    io_uring_cqe* cqes_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "center.h"
+#include "io_uring.h"
+#include <cstddef>
+#include <cstdint>
+
+// IoUringCenter 类定义
+// 基于 io_uring 的 Center 实现：多次触发（multishot）accept，
+// 多次触发 recv + 提供缓冲区环（provided buffer ring），链接提交的 sendmsg。
+// 复用 Center 的连接管理与跨线程投递逻辑，Epoller 的 RecvImpl/AllSendedImpl 回调不变：
+// 数据经 Epoller::InData 送入解帧流程，发送由 TcpEpoller 通过 SubmitSend 提交、OutCompleted 收尾。
+
+class IoUringCenter : public Center {
+public:
+    IoUringCenter();
+    virtual ~IoUringCenter();
+    
+    // 运行时探测内核是否支持所需特性，不支持时应退回 EpollCenter
+    static bool IsSupported();
+    
+    virtual bool Init() override;
+    virtual void Run() override;
+    
+    // 完成式后端只关心读兴趣：发送完成即驱动后续写；暂停读取时取消 multishot recv，恢复时重新挂起
+    virtual void UpdateEpoller(Epoller* epoller) override;
+    virtual void OnEpollerClosed(Epoller* epoller, int fd) override;
+    virtual bool SubmitSend(Epoller* epoller, msghdr* msgs, size_t count) override;
+    // 共享内存环的门铃需要就绪通知驱动，不支持
+    virtual bool WatchReadable(Epoller*, int) override { return false; }
+    
+protected:
+    // 数据报 Epoller 依赖就绪通知与 recvmmsg，multishot recv 也不带对端地址
+    virtual bool SupportsDatagram() const override { return false; }
+    virtual bool RegisterListenSocket(size_t index) override;
+    virtual bool RegisterEpoller(Epoller* epoller) override;
+    virtual void UnregisterEpoller(Epoller* epoller) override;
+    
+private:
+    bool InitBufferRing();
+    io_uring_sqe* NextSqe();
+    void ArmAccept(size_t index);
+    void ArmWakeup();
+    void ArmRecv(Epoller* epoller);
+    void CancelOperation(Epoller* epoller, uint64_t op);
+    void CancelEpoller(Epoller* epoller);
+    void HandleCompletion(const io_uring_cqe& cqe);
+    void HandleRecv(Epoller* epoller, const io_uring_cqe& cqe);
+    void RecycleBuffer(uint16_t bid);
+    
+    IoUring ring_;
+    
+    // 提供缓冲区环：内核为 multishot recv 从中挑选缓冲区；为空表示使用旧式提供缓冲区
+    io_uring_buf_ring* buf_ring_;
+    size_t buf_ring_size_;
+    uint8_t* buffers_;
+    size_t buffers_size_;
+    uint16_t buf_tail_;
+    
+    static constexpr unsigned kRingEntries = 1024;
+    static constexpr unsigned kBufferCount = 256;
+    static constexpr size_t kBufferSize = 16384;
+    static constexpr uint16_t kBufferGroup = 0;
+};
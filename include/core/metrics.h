@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 运行时指标
+// 每个 Center 持有一份 ReactorMetrics，只由该 Center 的事件循环线程更新：
+// 计数器是单写者原子量（relaxed load + store，无 lock 前缀指令），读取方在任意线程聚合。
+// MetricsRegistry 记录所有存活的 ReactorMetrics，仅在读取（stats 请求、管理端口）时加锁遍历。
+
+// 单写者计数器/仪表
+struct MetricCounter {
+    std::atomic<uint64_t> value{0};
+    
+    void Add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void Sub(uint64_t n) { value.store(value.load(std::memory_order_relaxed) - n, std::memory_order_relaxed); }
+    uint64_t Load() const { return value.load(std::memory_order_relaxed); }
+};
+
+// 对数分桶直方图：第 i 个桶统计 [2^(i-1), 2^i) 区间内的样本，桶 0 只含 0，共 65 个桶
+class LogHistogram {
+public:
+    static constexpr size_t kBuckets = 65;
+    
+    void Record(uint64_t value);
+    
+    MetricCounter buckets[kBuckets];
+    MetricCounter count;
+    MetricCounter sum;
+    MetricCounter max;
+};
+
+// 某一时刻的直方图副本，可跨 Reactor 合并
+struct HistogramSnapshot {
+    uint64_t buckets[LogHistogram::kBuckets] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    
+    void Merge(const HistogramSnapshot& other);
+    // 估算分位数：返回包含该分位样本的桶上界（不超过 max）
+    uint64_t Percentile(double q) const;
+};
+
+struct ReactorMetrics {
+    MetricCounter connections_accepted;
+    MetricCounter connections_closed;
+    // 因空闲、读帧超时或写停滞被关闭的连接数
+    MetricCounter connections_timed_out;
+    MetricCounter packets_in;
+    MetricCounter packets_out;
+    MetricCounter bytes_in;
+    MetricCounter bytes_out;
+    // 读到/写到 EAGAIN（含短写）的次数
+    MetricCounter read_eagain;
+    MetricCounter write_eagain;
+    // 所有连接发送队列中待写的 Packet 数
+    MetricCounter send_queue_depth;
+    // 所有连接发送队列中待写的字节数
+    MetricCounter send_queue_bytes;
+    // 因发送队列积压（水位或内存预算）暂停读取的次数
+    MetricCounter read_pauses;
+    // 校验尾部不符而关闭连接的次数
+    MetricCounter checksum_errors;
+    // UDP：收到/发出的报文数，丢弃的报文数（截断、帧格式错误或发送失败），带 UDP_SEGMENT 的合并发送次数
+    MetricCounter datagrams_received;
+    MetricCounter datagrams_sent;
+    MetricCounter datagrams_dropped;
+    MetricCounter gso_sends;
+    // 改用共享内存环的连接数，以及被门铃唤醒的次数（轮询窗口内到达的数据不需要门铃）
+    MetricCounter ring_connections;
+    MetricCounter ring_doorbells;
+    // 交给卸载线程池的请求数，以及池已满而未能卸载的次数
+    MetricCounter offload_tasks;
+    MetricCounter offload_rejected;
+    // 读写预算用尽而让出、交给就绪列表续处理的次数
+    MetricCounter budget_yields;
+    // 每次 epoll_wait/io_uring_enter 返回的事件数
+    LogHistogram events_per_wakeup;
+    // 从收到一帧到其回射完全写出的耗时（纳秒）
+    LogHistogram echo_latency_ns;
+};
+
+struct MetricsSnapshot {
+    uint64_t connections_accepted = 0;
+    uint64_t connections_closed = 0;
+    uint64_t connections_timed_out = 0;
+    uint64_t packets_in = 0;
+    uint64_t packets_out = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    uint64_t read_eagain = 0;
+    uint64_t write_eagain = 0;
+    uint64_t send_queue_depth = 0;
+    uint64_t send_queue_bytes = 0;
+    uint64_t read_pauses = 0;
+    uint64_t checksum_errors = 0;
+    uint64_t datagrams_received = 0;
+    uint64_t datagrams_sent = 0;
+    uint64_t datagrams_dropped = 0;
+    uint64_t gso_sends = 0;
+    uint64_t ring_connections = 0;
+    uint64_t ring_doorbells = 0;
+    uint64_t offload_tasks = 0;
+    uint64_t offload_rejected = 0;
+    uint64_t budget_yields = 0;
+    HistogramSnapshot events_per_wakeup;
+    HistogramSnapshot echo_latency_ns;
+    
+    static MetricsSnapshot From(const ReactorMetrics& metrics);
+    void Merge(const MetricsSnapshot& other);
+};
+
+class MetricsRegistry {
+public:
+    static void Register(ReactorMetrics* metrics);
+    static void Unregister(ReactorMetrics* metrics);
+    
+    // 各 Reactor 的快照，按注册顺序
+    static std::vector<MetricsSnapshot> Collect();
+    // 纯文本格式（Prometheus exposition 风格），含合计与各 Reactor 明细
+    static std::string Format();
+};
+
+// 单调时钟纳秒，用于延迟统计
+uint64_t MonotonicNs();
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// MpscQueue 类定义
+// 无锁多生产者单消费者队列（Vyukov 算法）。
+// Push 可在任意线程调用，Pop 只能由唯一的消费者线程调用。
+
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : stub_(new Node()), head_(stub_), tail_(stub_) {}
+    
+    ~MpscQueue() {
+        T value;
+        while (Pop(value)) {
+        }
+        delete tail_;
+    }
+    
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    
+    void Push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+    
+    bool Pop(T& value) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+    
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+    
+    Node* stub_;
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// OffloadPool 类定义
+// 有界工作窃取线程池，用于把耗时的请求处理移出事件循环线程（见 TcpEpoller::Offload）。
+// 每个工作线程有自己的任务队列，提交按轮询分散到各队列；线程从自己队列的头部取任务，
+// 自己的队列空了再从其他队列的尾部窃取，个别任务耗时很长时其余任务不会排在它后面等待。
+// 在途任务（已提交、尚未执行完）数达到上限时 Submit 返回 false，由调用方降级处理，队列不会无限增长。
+// 工作线程以较低的优先级（nice）运行：CPU 不够时内核先调度事件循环线程，耗时任务不会挤占收发的时间片。
+
+class OffloadPool {
+public:
+    static constexpr int kDefaultNice = 10;
+    
+    // capacity 为 0 时取 threads × 1024；nice 为工作线程的 nice 值（只能调低优先级）
+    explicit OffloadPool(size_t threads, size_t capacity = 0, int nice = kDefaultNice);
+    // 等价于 Stop()
+    ~OffloadPool();
+    
+    OffloadPool(const OffloadPool&) = delete;
+    OffloadPool& operator=(const OffloadPool&) = delete;
+    
+    // 线程安全：提交任务，池已满或已停止时返回 false
+    bool Submit(std::function<void()> task);
+    // 停止并等待工作线程退出，尚未开始执行的任务直接丢弃；需在任务回送结果的目标（Center）析构之前调用
+    void Stop();
+    
+    size_t threads() const { return workers_.size(); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+    
+    void WorkerLoop(size_t index);
+    // 先取自己队列的头部，再依次窃取其他队列的尾部
+    bool TakeTask(size_t index, std::function<void()>* task);
+    
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t capacity_;
+    int nice_;
+    // 在途任务数，用于容量限制
+    std::atomic<size_t> inflight_;
+    // 各队列中尚未被取走的任务总数；空闲线程据此判断是否休眠
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> next_worker_;
+    // 休眠的线程数：只有其不为 0 时 Submit 才加锁唤醒
+    std::atomic<size_t> sleeping_;
+    std::atomic<bool> stopping_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class Center;
+
+// PlacementPolicy 类定义
+// Acceptor/Worker 模式下决定新连接交给哪个 Worker Center；
+// REUSE_PORT 模式下也用于分配 Unix 域 socket 上接入的连接。
+// 只在接入连接的那一个线程中调用，实现无需考虑并发。
+
+class PlacementPolicy {
+public:
+    virtual ~PlacementPolicy() = default;
+    
+    virtual size_t Select(const std::vector<std::unique_ptr<Center>>& workers) = 0;
+};
+
+// 轮询分配
+class RoundRobinPlacement : public PlacementPolicy {
+public:
+    size_t Select(const std::vector<std::unique_ptr<Center>>& workers) override;
+    
+private:
+    size_t next_ = 0;
+};
+
+// 分配给当前连接数最少的 Worker
+class LeastConnectionsPlacement : public PlacementPolicy {
+public:
+    size_t Select(const std::vector<std::unique_ptr<Center>>& workers) override;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// 分层时间轮
+// 精度 1ms：第 0 层 256 个槽覆盖 256ms，其上三层各 64 个槽，合计约 18.6 小时，更远的定时器按最远处理。
+// Timer 是侵入式双向链表节点，由持有者分配（通常是 Epoller 的成员），启动/取消均为 O(1) 且不分配内存。
+// 时间轮只在所属 Center 的线程中使用，不加锁。
+
+class TimerWheel;
+
+struct TimerLink {
+    TimerLink* prev = nullptr;
+    TimerLink* next = nullptr;
+};
+
+class Timer : private TimerLink {
+public:
+    Timer();
+    explicit Timer(std::function<void()> callback);
+    // 析构时自动取消
+    ~Timer();
+    
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+    
+    void SetCallback(std::function<void()> callback) { callback_ = std::move(callback); }
+    bool IsArmed() const { return wheel_ != nullptr; }
+    void Cancel();
+
+private:
+    friend class TimerWheel;
+    
+    TimerWheel* wheel_;
+    uint64_t expire_tick_;
+    std::function<void()> callback_;
+};
+
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t now_ms = 0);
+    ~TimerWheel();
+    
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    
+    // delay_ms 后到期；已启动的定时器重新计时。回调中可以再次启动或取消任意定时器
+    void Arm(Timer* timer, uint64_t delay_ms);
+    void Cancel(Timer* timer);
+    
+    // 推进到 now_ms 并依次回调所有到期的定时器，返回触发数
+    size_t Advance(uint64_t now_ms);
+    // 距下一次需要推进的毫秒数，可直接作为 epoll_wait 的超时；没有定时器时返回 -1
+    int NextTimeoutMs() const;
+    size_t size() const { return size_; }
+
+private:
+    static constexpr unsigned kNearBits = 8;
+    static constexpr unsigned kFarBits = 6;
+    static constexpr unsigned kFarLevels = 3;
+    static constexpr size_t kNearSize = size_t(1) << kNearBits;
+    static constexpr size_t kFarSize = size_t(1) << kFarBits;
+    static constexpr uint64_t kMaxDelay = (uint64_t(1) << (kNearBits + kFarLevels * kFarBits)) - 1;
+    
+    void Insert(Timer* timer);
+    void Cascade(unsigned level, size_t index);
+    size_t Fire(TimerLink* slot);
+    
+    static void InitSlot(TimerLink* slot);
+    static void Link(TimerLink* slot, TimerLink* node);
+    static void Unlink(TimerLink* node);
+    
+    // 起始时刻与已推进到的 tick（自起始时刻起的毫秒数）
+    uint64_t base_ms_;
+    uint64_t current_;
+    size_t size_;
+    TimerLink near_[kNearSize];
+    TimerLink far_[kFarLevels][kFarSize];
+};
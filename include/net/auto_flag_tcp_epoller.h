@@ -2,13 +2,16 @@
 
 #include "tcp_epoller.h"
 
+// AutoFlagTcpEpoller 类定义
+// 自动管理 WantOut 标志：短写后发送队列仍有数据时注册 EPOLLOUT，
+// 队列写空后撤销，只在兴趣事件真正变化时才发起 epoll_ctl
+
 class AutoFlagTcpEpoller : public TcpEpoller {
 public:
     AutoFlagTcpEpoller();
     explicit AutoFlagTcpEpoller(int fd);
     virtual ~AutoFlagTcpEpoller();
     
-    // 自动管理 WantOut 标志
-    // 继承 TcpEpoller 的功能
+protected:
+    virtual void SetWantOut(bool want_out) override;
 };
-
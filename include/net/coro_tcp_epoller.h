@@ -0,0 +1,117 @@
+#pragma once
+
+#include "auto_flag_tcp_epoller.h"
+#include "../common/packet.h"
+#include <coroutine>
+#include <deque>
+#include <optional>
+
+// CoroTcpEpoller 类定义
+// 协程式连接处理：处理函数以 co_await conn.ReadPacket() / co_await conn.Send(packet) 顺序书写多步协议，
+// 不再拆成 RecvImpl 回调状态机。协程始终在所属 Center 线程上由读写事件直接恢复，不切换线程；
+// 每个事件只是一次 coroutine_handle::resume()，没有额外的虚调用或堆分配，协程帧从 SlabAllocator 分配。
+
+class CoroTcpEpoller;
+
+// ConnectionTask 连接处理协程的返回类型
+// 创建后挂起，由 CoroTcpEpoller 在连接注册到 Center 后启动；结束时停在 final_suspend，帧随连接释放
+class ConnectionTask {
+public:
+    struct promise_type {
+        ConnectionTask get_return_object() noexcept;
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+        
+        // 协程帧放在 SlabAllocator 的 slot 中，slot 头部记录尺寸类别
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr) noexcept;
+    };
+    
+    ConnectionTask() noexcept : handle_(nullptr) {}
+    explicit ConnectionTask(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+    ConnectionTask(ConnectionTask&& other) noexcept;
+    ConnectionTask& operator=(ConnectionTask&& other) noexcept;
+    ~ConnectionTask();
+    
+    ConnectionTask(const ConnectionTask&) = delete;
+    ConnectionTask& operator=(const ConnectionTask&) = delete;
+    
+    std::coroutine_handle<promise_type> handle() const { return handle_; }
+    bool done() const { return !handle_ || handle_.done(); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 连接处理函数：每个连接调用一次，返回的协程在连接关闭或处理函数返回时结束
+using CoroHandler = ConnectionTask (*)(CoroTcpEpoller& conn);
+
+class CoroTcpEpoller : public AutoFlagTcpEpoller {
+public:
+    class ReadAwaiter {
+    public:
+        explicit ReadAwaiter(CoroTcpEpoller* conn) : conn_(conn) {}
+        bool await_ready() const noexcept { return !conn_->inbox_.empty() || conn_->fd_ < 0; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept;
+        // 连接已关闭且没有剩余帧时返回 std::nullopt
+        std::optional<Packet> await_resume();
+    
+    private:
+        friend class CoroTcpEpoller;
+        CoroTcpEpoller* conn_;
+        std::coroutine_handle<> handle_;
+        // 挂起期间到达的帧直接交到这里，不经过 inbox_
+        std::optional<Packet> result_;
+    };
+    
+    class SendAwaiter {
+    public:
+        SendAwaiter(CoroTcpEpoller* conn, Packet packet) : conn_(conn), packet_(std::move(packet)) {}
+        // 入队在这里完成；只有发送队列达到高水位时才挂起
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> handle) noexcept { conn_->send_waiter_ = handle; }
+        // 返回连接是否仍然打开
+        bool await_resume() const noexcept { return conn_->fd_ >= 0; }
+    
+    private:
+        CoroTcpEpoller* conn_;
+        Packet packet_;
+    };
+    
+    CoroTcpEpoller(int fd, CoroHandler handler);
+    virtual ~CoroTcpEpoller();
+    
+    // 等待下一帧
+    ReadAwaiter ReadPacket() { return ReadAwaiter(this); }
+    // 入队发送；写出由读写事件驱动，与回调路径一样在本轮读处理结束后聚合写出。
+    // 发送队列达到高水位时挂起，降到低水位以下再恢复；连接已关闭时丢弃
+    SendAwaiter Send(Packet packet) { return SendAwaiter(this, std::move(packet)); }
+    bool IsOpen() const { return fd_ >= 0; }
+    
+    virtual void RecvImpl(Packet packet) override;
+    virtual void AllSendedImpl() override;
+    virtual void Out() override;
+    virtual void OutCompleted(int result) override;
+
+protected:
+    virtual void OnRegistered() override;
+    virtual void OnClosed() override;
+
+private:
+    // 恢复协程；处理函数已返回时在发送队列写完后关闭连接
+    void Resume(std::coroutine_handle<> handle);
+    // 写出进展后恢复等待发送的协程，并写出它新入队的数据
+    void ResumeSender();
+    bool SendBlocked() const;
+    
+    CoroHandler handler_;
+    ConnectionTask task_;
+    // 协程未在 ReadPacket 上等待时到达的帧
+    std::deque<Packet> inbox_;
+    ReadAwaiter* read_waiter_;
+    std::coroutine_handle<> send_waiter_;
+    // 处理函数已返回，发送队列写完后关闭
+    bool finished_;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+
+// Endpoint 类定义
+// socket 地址：IPv4/IPv6 TCP、Unix 域 socket 或 UDP，监听与连接共用。文本形式：
+//   8888、0.0.0.0:8888、127.0.0.1:8888   IPv4 TCP，只写端口时监听所有地址
+//   [::]:8888、[::1]:8888                 IPv6 TCP；[::] 关闭 IPV6_V6ONLY，同一 socket 也接受 IPv4 连接
+//   unix:/run/echo.sock                   Unix 域 socket，文件系统路径
+//   unix:@echo                            Unix 域 socket，Linux 抽象命名空间（不落文件，进程退出即消失）
+//   udp:8888、udp:[::]:8888               UDP，地址部分与 TCP 相同；每个报文承载一帧
+// 同机客户端走 Unix 域 socket 可省去 TCP/IP 协议栈与回环设备，往返延迟明显低于回环 TCP。
+
+class Endpoint {
+public:
+    Endpoint();
+    
+    // 解析上述文本形式，失败返回 false
+    static bool Parse(const std::string& text, Endpoint* endpoint);
+    // host 为空或 0.0.0.0 时为 IPv4 全部地址；含 ':' 时按 IPv6 解析；以 unix: 开头时忽略 port
+    static bool FromHostPort(const char* host, uint16_t port, Endpoint* endpoint);
+    
+    // 创建非阻塞监听 socket：TCP 设置 SO_REUSEADDR，reuse_port 时再设置 SO_REUSEPORT；
+    // 文件系统路径上残留的 socket 文件（上次未正常退出）先删除再绑定。失败返回 -1
+    int OpenListenSocket(bool reuse_port) const;
+    // 创建非阻塞、已绑定的 UDP socket，并尽量调大收发缓冲区以承受突发；失败返回 -1
+    int OpenDatagramSocket(bool reuse_port) const;
+    // 文件系统路径的 Unix 域 socket 在关闭监听后删除 socket 文件，其他类型不做处理
+    void RemoveSocketFile() const;
+    
+    bool is_unix() const { return addr_.ss_family == AF_UNIX; }
+    bool is_datagram() const { return datagram_; }
+    // SO_REUSEPORT 只对 TCP/UDP 有效：Unix 域 socket 的同一路径只能绑定一次
+    bool supports_reuse_port() const { return !is_unix(); }
+    int family() const { return addr_.ss_family; }
+    const sockaddr* addr() const { return reinterpret_cast<const sockaddr*>(&addr_); }
+    socklen_t addr_len() const { return addr_len_; }
+    std::string ToString() const;
+    
+    // 格式化 accept/getpeername 得到的地址，仅用于日志
+    static std::string FormatAddress(const sockaddr* addr, socklen_t addr_len);
+
+private:
+    static bool ParseUnix(const std::string& path, Endpoint* endpoint);
+    
+    sockaddr_storage addr_;
+    socklen_t addr_len_;
+    bool datagram_;
+};
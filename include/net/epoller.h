@@ -1,10 +1,32 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 class Packet;
+class Center;
+class Timer;
+struct ReactorMetrics;
+
+// 连接的调度优先级：决定每次调度的读写预算（见 IoBudget），以及 Center 就绪列表中的服务顺序（数值小的先服务）
+enum class IoPriority : uint8_t {
+    // 交互式小请求
+    HIGH = 0,
+    NORMAL = 1,
+    // 大块传输
+    BULK = 2
+};
+constexpr size_t kIoPriorityCount = 3;
+
+// 一个连接每次被调度（一次就绪事件，或就绪列表中的一次轮转）最多读写的字节数与交给 RecvImpl 的帧数；
+// 用完即让出，剩余的数据与已缓冲的帧留给就绪列表在下一次 epoll_wait 之前继续处理
+struct IoBudget {
+    size_t bytes = 256 * 1024;
+    size_t packets = 64;
+};
 
 // Epoller 基类定义
+// 通过 center_ 回调所属 Center：兴趣事件变化时更新 epoll 注册，关闭时请求回收
 
 class Epoller {
 public:
@@ -17,9 +39,72 @@ public:
     virtual void RecvImpl(Packet packet) = 0;
     virtual void AllSendedImpl() {}
     
+    // 完成式后端（io_uring）使用：Center 已读到的数据直接交给 Epoller，length 为 0 表示对端关闭
+    virtual void InData(const void* data, size_t length) { (void)data; (void)length; }
+    // 完成式后端使用：一次异步发送完成，result 为写出的字节数或 -errno
+    virtual void OutCompleted(int result) { (void)result; }
+    
+    // 期望的 epoll 兴趣事件，默认只关心可读
+    virtual uint32_t Events() const;
+    
     int GetFd() const { return fd_; }
+    Center* GetCenter() const { return center_; }
+    // 所属 Center 的指标；未注册到 Center 时指向一份不被汇总的占位指标
+    ReactorMetrics& metrics() const { return *metrics_; }
+    static ReactorMetrics* DetachedMetrics();
+    
+    // 在所属 Center 的定时轮上启动 timer，delay_ms 后在 Center 线程中回调，已启动的重新计时；
+    // 未加入 Center 时返回 false。timer 通常是派生类的成员，析构时自动取消
+    bool StartTimer(Timer* timer, uint64_t delay_ms);
+    
+    // 边沿触发模式下由所属 Center 设置，读写需排空到 EAGAIN
+    bool IsEdgeTriggered() const { return edge_triggered_; }
+    // 因本轮预算用尽而未读/写完，需要 Center 在下一次 epoll_wait 前再次调度
+    bool HasPendingIn() const { return pending_in_; }
+    bool HasPendingOut() const { return pending_out_; }
+    // 所属 Center 为完成式后端时为真：Out() 需通过 Center::SubmitSend 提交异步发送
+    bool IsAsyncIo() const { return async_io_; }
+    // 退出 Center 的延迟写出：读处理结束后立即写出，适合对延迟敏感的连接
+    void SetImmediateFlush(bool immediate) { immediate_flush_ = immediate; }
+    // 待写数据是否交给 Center 在本轮末尾统一写出
+    bool DefersFlush() const;
+    // 调度优先级，默认 NORMAL；可随时调整，下一次调度起生效
+    void SetPriority(IoPriority priority) { priority_ = priority; }
+    IoPriority priority() const { return priority_; }
+    // 所属 Center 为本连接优先级配置的预算，未加入 Center 时为默认值
+    const IoBudget& budget() const;
     
 protected:
+    // 加入 Center（已注册事件源）后由 Center 调用，可在此启动定时器
+    virtual void OnRegistered() {}
+    // Events() 变化后调用，仅在与已注册事件不同时才会发起 epoll_ctl
+    void UpdateEvents();
+    // fd 已关闭，通知 Center 在本轮事件处理结束后回收本对象
+    void NotifyClosed(int closed_fd);
+    // 延迟写出模式下请求所属 Center 在本轮末尾调用 Out()
+    void ScheduleFlush();
+    void SetPendingIn(bool pending) { pending_in_ = pending; }
+    void SetPendingOut(bool pending) { pending_out_ = pending; }
+    
     int fd_;
+    
+private:
+    friend class Center;
+    
+    Center* center_;
+    ReactorMetrics* metrics_;
+    uint32_t registered_events_;
+    bool edge_triggered_;
+    bool pending_in_;
+    bool pending_out_;
+    // 是否已在 Center 的就绪列表 / 待写出列表中
+    bool in_ready_list_;
+    bool in_flush_list_;
+    bool immediate_flush_;
+    bool async_io_;
+    // 完成式后端：内核中挂着该连接的 multishot recv（已请求取消、最终完成事件未到时仍为 true）
+    bool recv_armed_;
+    IoPriority priority_;
+    // 完成式后端中尚未完成的异步操作数，归零前不能析构
+    uint32_t inflight_ops_;
 };
-
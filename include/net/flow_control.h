@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FlowControl 类定义
+// 出站方向的背压：单连接发送队列超过高水位时暂停读取该连接，降到低水位以下再恢复；
+// 所有连接发送队列与接收缓冲区的合计字节数超过进程级预算时，有积压的连接同样暂停读取，写出进度驱动恢复。
+// 入站方向：包头声明的负载长度超过 max_frame_length 的连接直接关闭；负载未收全时只按已收到的字节数成倍预留空间，
+// 一个包头不能让服务端预先分配整帧的内存。接收缓冲区中尚未解出的字节同样计入进程级预算，超出预算时
+// 发送队列与接收缓冲区合计达到 budget_pause_bytes 的连接暂停读取。只因接收缓冲区暂停的连接没有写出进度驱动恢复，
+// 由连接上的定时器定期复查；进程持续超出预算达 budget_stall_ms 时关闭这样的连接，逐个释放直到回落到预算以内，
+// 避免所有连接都握着半帧互相等待。
+// 共享内存环的映射同样计入预算，超出时拒绝协商。
+
+struct FlowControlConfig {
+    // 单连接发送队列的高/低水位（字节）；high_watermark 为 0 表示不限制
+    size_t high_watermark = 4 << 20;
+    size_t low_watermark = 1 << 20;
+    // 所有连接发送队列与接收缓冲区合计字节上限；0 表示不限制
+    size_t memory_budget = 0;
+    // 超出预算时，发送队列与接收缓冲区合计达到该字节数的连接暂停读取，降到该值以下或合计回落到预算以内时恢复
+    size_t budget_pause_bytes = 64 << 10;
+    // 只因接收缓冲区暂停读取的连接，进程持续超出预算达到该毫秒数时关闭；0 表示不关闭
+    uint32_t budget_stall_ms = 2000;
+    // 单帧负载长度上限（字节），超过时关闭连接；0 表示不限制
+    size_t max_frame_length = 64 << 20;
+};
+
+class FlowControl {
+public:
+    // 需在任何 Center 开始运行前调用
+    static void Configure(const FlowControlConfig& config);
+    static const FlowControlConfig& config();
+    
+    // 发送队列与接收缓冲区的字节记账；各线程先在本地累计，超过批量阈值才更新全局计数
+    static void Charge(size_t bytes);
+    static void Release(size_t bytes);
+    
+    static bool OverBudget();
+    // 再占用 bytes 字节后是否仍在预算以内；未设置预算时总为 true
+    static bool Fits(size_t bytes);
+    // 全局计数，误差不超过 线程数 × 批量阈值
+    static uint64_t BufferedBytes();
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// 连接的第一个字节为该值表示请求改用共享内存环收发，只能通过 Unix 域 socket 协商：
+// 服务端回复同一字节并以 SCM_RIGHTS 附带 memfd 与两个 eventfd 门铃，回复 0 表示拒绝，连接照常走 socket
+constexpr uint8_t kShmRingMagic = 0xD5;
+
+// ShmRing 类定义
+// 同机两个进程之间的一对单生产者单消费者字节环（客户端到服务端、服务端到客户端各一个），放在同一个 memfd 中。
+// 环上的字节流与 socket 上完全相同（包头格式、校验尾部与首字节协商照旧），收发方只是把 read/write 换成内存复制。
+// 门铃：每一方各有一个 eventfd，只在准备休眠时置位共享的等待标志；对端发布数据（或腾出空间）后看到标志才写门铃，
+// 双方都在轮询时收发路径上没有系统调用。socket 保持打开，只用于感知对端关闭
+
+class ShmRing {
+public:
+    // 每个方向的环容量，须为 2 的幂
+    static constexpr size_t kDefaultCapacity = 1 << 20;
+    
+    ~ShmRing();
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+    
+    // 服务端：创建共享内存与门铃，失败返回 nullptr
+    static std::unique_ptr<ShmRing> Create(size_t capacity = kDefaultCapacity);
+    // 服务端：在 socket 上回复 kShmRingMagic 并把共享内存与门铃交给客户端
+    bool Offer(int socket_fd);
+    // 服务端：回复拒绝
+    static bool Decline(int socket_fd);
+    // 客户端：在刚建立的阻塞 socket 上请求并等待服务端回复；服务端拒绝或失败时返回 nullptr
+    static std::unique_ptr<ShmRing> Negotiate(int socket_fd);
+    
+    // 尽量写入 iov 中的数据并发布，返回写入的字节数（环满时为 0 或只写入一部分）；
+    // 对端写坏了共享的读位置时返回 -1，errno 为 EPROTO，调用方应关闭连接
+    ssize_t Write(const iovec* iov, size_t count);
+    // 读出至多 length 字节并归还空间，返回读出的字节数；对端写坏了共享的写位置时返回 -1，errno 为 EPROTO
+    ssize_t Read(void* data, size_t length);
+    bool Readable() const;
+    
+    // 休眠前调用：置位等待标志后再检查一次，已有数据（或已有空间）时撤销并返回 false，调用方不能休眠
+    bool ArmReadable();
+    bool ArmWritable();
+    // 醒来后撤销尚未被对端清除的等待标志
+    void Disarm();
+    // 共享内存映射的总字节数（两个方向的数据区加控制区）
+    size_t map_size() const { return map_size_; }
+    // 服务端创建 capacity 容量的环所需映射的字节数
+    static size_t MapSizeFor(size_t capacity);
+    // 本方门铃的 eventfd，可读表示对端按过门铃
+    int doorbell_fd() const { return doorbell_fd_; }
+    // 清空门铃计数，返回被按响的次数
+    uint64_t DrainDoorbell();
+
+private:
+    struct Control;
+    
+    ShmRing(void* base, size_t map_size, bool server, int doorbell_fd, int peer_doorbell_fd);
+    // 共享内存中第 index 个方向的控制块：0 为客户端到服务端，1 为服务端到客户端
+    static Control* ControlAt(void* base, size_t index);
+    void RingPeer();
+    
+    void* base_;
+    size_t map_size_;
+    size_t capacity_;
+    Control* rx_;
+    Control* tx_;
+    uint8_t* rx_data_;
+    uint8_t* tx_data_;
+    // 本方独占推进的位置，发布前只在本地累计
+    uint64_t rx_head_;
+    uint64_t tx_tail_;
+    // 服务端在 Offer 之前持有 memfd，之后关闭；映射不受影响
+    int memfd_;
+    int doorbell_fd_;
+    int peer_doorbell_fd_;
+    bool read_armed_;
+    bool write_armed_;
+};
@@ -3,9 +3,26 @@
 #include "epoller.h"
 #include "../common/packet.h"
 #include "../common/packet_header.h"
-#include <queue>
+#include "../common/buffer.h"
+#include "../common/wire_codec.h"
+#include "shm_ring.h"
+#include "../core/timer_wheel.h"
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
 #include <vector>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// 卸载处理的应答顺序（见 TcpEpoller::Offload）
+enum class OffloadOrder {
+    // 与本连接的其他应答保持请求顺序
+    IN_ORDER,
+    // 完成即发送，对端按包头 extra1 匹配请求
+    UNORDERED
+};
 
 // TcpEpoller 类定义
 // 单连接读写与发送队列管理
@@ -18,14 +35,82 @@ public:
     
     virtual void In() override;
     virtual void Out() override;
+    virtual void InData(const void* data, size_t length) override;
+    virtual void OutCompleted(int result) override;
+    // 可读始终关注；want_out_ 为真时额外关注可写
+    virtual uint32_t Events() const override;
+    // 仍有按序卸载的请求未完成时，应答排在它们之后，等前面的都发出后再入发送队列
     void Send(Packet packet);
+    // 把耗时的处理交给所属 Center 的卸载线程池（Center::SetOffloadPool）：work 在池线程中执行，
+    // 只能使用自己捕获的数据，不能访问本连接；返回的应答回到本连接所在的线程后发送，连接已关闭则丢弃。
+    // IN_ORDER 时应答与本连接的其他应答保持请求顺序；UNORDERED 时完成即发送，不阻挡也不等待其他应答，
+    // 由处理方在应答包头 extra1 中带上请求的标识。没有线程池或池已满时返回 false，work 不会执行，由调用方自行处理
+    bool Offload(std::function<Packet()> work, OffloadOrder order = OffloadOrder::IN_ORDER);
     void Close();
+    // 包头的线上格式，默认 WireFormat::Native()；需在收发任何数据之前设置
+    void SetWireFormat(const WireFormat* format) { wire_format_ = format; }
+    // 允许对端用首字节协商另一种格式：连接收到的第一个字节等于 format->magic 时丢弃该字节并改用 format 收发
+    void SetNegotiableFormat(const WireFormat* format) { negotiable_format_ = format; }
+    const WireFormat& wire_format() const { return *wire_format_; }
+    // 每帧附带 CRC32C 校验尾部（见 kChecksumSize），收到的帧校验失败时关闭连接；需在收发任何数据之前设置
+    void SetChecksum(bool enabled) { checksum_ = enabled; }
+    // 允许对端在连接开头发送 kChecksumMagic 启用校验尾部
+    void SetNegotiableChecksum(bool enabled) { negotiable_checksum_ = enabled; }
+    bool checksum() const { return checksum_; }
+    // 允许对端在连接开头发送 kShmRingMagic 改用共享内存环收发（见 ShmRing）；
+    // 只有所在 Center 开启了共享内存环、连接为 Unix 域 socket、后端支持 Center::WatchReadable 且映射不超出内存预算时接受，
+    // 否则回复拒绝并继续使用 socket
+    void SetNegotiableRing(bool enabled) { negotiable_ring_ = enabled; }
     
     virtual void RecvImpl(Packet packet) override = 0;
     
 protected:
-    std::queue<Packet> send_queue_;
+    std::deque<Packet> send_queue_;
+    // 队首 Packet 已写出的字节数（包头 + 负载），短写后从此处续写
+    size_t send_offset_;
+    // 发送队列有数据但 socket 暂时不可写，需要等待 EPOLLOUT
     bool want_out_;
+    // 发送队列中所有 Packet 的字节数（包头 + 负载，含队首已写出的部分）
+    size_t send_queue_bytes_;
+    // 发送队列超过高水位，或超出进程内存预算时发送队列与接收缓冲区积压过多，暂停读取（不关注 EPOLLIN）
+    bool read_paused_;
+    
+    // Out() 在短写/队列清空时调用；基类只记录标志，子类可据此更新 epoll 注册
+    virtual void SetWantOut(bool want_out) { want_out_ = want_out; }
+    // 按发送队列、接收缓冲区字节数与 FlowControl 配置暂停/恢复读取，状态变化时更新兴趣事件
+    void UpdateReadPause();
+    // Close() 关闭 fd 后调用，发送队列等状态已清理
+    virtual void OnClosed() {}
+    
+    const WireFormat* wire_format_;
+    // 尚未收到首字节时可协商的格式，收到后清空
+    const WireFormat* negotiable_format_;
+    bool checksum_;
+    bool negotiable_checksum_;
+    bool negotiable_ring_;
+    // 共享内存环：非空时读写都走环，socket 只用于感知对端关闭
+    std::unique_ptr<ShmRing> ring_;
+    // 创建共享内存环并交给对端，失败时关闭连接并返回 false
+    bool StartRing();
+    void StopRing();
+    // 从环中读入接收缓冲区，语义同 ReadSocket
+    ssize_t ReadRing(size_t max_bytes);
+    // 一次 In() 结束时：仍在轮询窗口内则留在就绪列表中继续轮询，否则在门铃上休眠
+    void IdleRing();
+    // Packet 在线上的字节数（编码后的包头 + 负载 + 校验尾部）
+    size_t WireFrameSize(const Packet& packet) const;
+    // 放入发送队列并按需安排写出
+    void EnqueueSend(Packet packet);
+    
+    // 按序应答的编号：offload_next_seq_ 分配给下一个按序卸载的请求或排在其后的应答，
+    // offload_emit_seq_ 是下一个该入发送队列的编号，两者相等时没有排队的应答
+    uint64_t offload_next_seq_;
+    uint64_t offload_emit_seq_;
+    // 已就绪、但前面还有未完成卸载的应答，按编号排序；其字节数计入读暂停的积压量
+    std::map<uint64_t, Packet> offload_parked_;
+    size_t offload_parked_bytes_;
+    // 卸载的处理完成（在本连接所在的线程中）：按序应答先排队，再依次放出编号连续的部分
+    void OnOffloadDone(bool ordered, uint64_t seq, Packet packet);
     
     // 读取状态
     enum ReadState {
@@ -33,10 +118,73 @@ protected:
         READING_DATA
     };
     ReadState read_state_;
+    // 上次解帧因帧数预算提前停止，缓冲区中可能还有完整的帧
+    bool decode_paused_;
     PacketHeader pending_header_;
-    std::vector<uint8_t> pending_data_;
-    size_t pending_data_read_;
+    // 启用校验时：当前帧的线上包头字节，以及已随读入累计进 pending_crc_ 的负载字节数
+    uint8_t pending_header_bytes_[kMaxWireHeaderSize];
+    size_t pending_header_size_;
+    uint32_t pending_crc_;
+    size_t crc_offset_;
+    // 接收缓冲区：每次可读事件一次 readv 填充，再从中切出所有完整帧
+    Buffer recv_buffer_;
+    // 接收缓冲区中已计入 FlowControl 的字节数
+    size_t recv_charged_;
+    // 最近一次读入数据的时刻，作为本批解出各帧的接收时间
+    uint64_t last_read_ns_;
     
     void ResetReadState();
+    // 至多读入 max_bytes 字节，返回 readv 结果，语义同 recv
+    ssize_t ReadSocket(size_t max_bytes);
+    // 从 recv_buffer_ 中解出至多 max_packets 个完整帧并交给 RecvImpl，返回交出的帧数
+    size_t DecodeFrames(size_t max_packets);
+    // 核对紧跟 length 字节负载之后的校验尾部；不符时关闭连接并返回 false
+    bool VerifyChecksum(size_t length);
+    // 把接收缓冲区的可读字节数同步到 FlowControl 的记账
+    void ChargeRecvBuffer();
+    
+    // 从队列第 *index 个 Packet 的第 skip 字节起填充 iovec，返回填充项数；
+    // *index 更新为下一个未覆盖的 Packet，*bytes 为本批字节数。
+    // 线上格式与 PacketHeader 内存布局不同时包头编码到 headers，校验尾部也写在这里
+    // （max_iov / 2 个槽，每槽 kMaxWireHeaderSize + kChecksumSize 字节），写出完成前 headers 必须保持有效
+    size_t FillSendIov(size_t* index, size_t skip, iovec* iov, size_t max_iov, size_t* bytes, uint8_t* headers);
+    // 已写出 n 字节：弹出完整写出的 Packet，更新 send_offset_
+    void AdvanceSendQueue(size_t n);
+    
+    // 完成式后端的异步发送：iovec/msghdr 在发送完成前必须保持有效
+    void OutAsync();
+    std::vector<iovec> async_iov_;
+    std::vector<msghdr> async_msgs_;
+    std::vector<uint8_t> async_headers_;
+    size_t sends_in_flight_;
+    // 对端已关闭，待发送队列写完后再关闭连接
+    bool close_after_send_;
+    
+    // 连接超时（见 ConnectionTimeouts）：定时器按周期触发，只比较期间计数是否变化，
+    // 收发路径上不重新计时，每个包只多一次 IsArmed 判断
+    virtual void OnRegistered() override;
+    // 每次读入并解帧后调用，留有不完整的帧时启动读超时
+    void OnReadProgress();
+    void OnIdleTimer();
+    void OnReadTimer();
+    void OnWriteTimer();
+    // 暂停读取期间定期复查预算：只因接收缓冲区暂停的连接没有写出进度触发 UpdateReadPause
+    void OnBudgetTimer();
+    void CloseOnTimeout(const char* reason);
+    bool HasPartialFrame() const { return read_state_ == READING_DATA || recv_buffer_.ReadableBytes() > 0; }
+    
+    Timer idle_timer_;
+    Timer read_timer_;
+    Timer write_timer_;
+    Timer budget_timer_;
+    // 只因接收缓冲区暂停、且进程仍超出预算的累计毫秒数
+    uint32_t budget_stalled_ms_;
+    // 读写次数、已解出的帧数、已写出的字节数，及各定时器上次检查时的值
+    uint64_t activity_;
+    uint64_t frames_in_;
+    uint64_t bytes_written_;
+    uint64_t idle_seen_;
+    uint64_t read_seen_;
+    uint64_t write_seen_;
 };
 
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "epoller.h"
+#include "../common/packet_header.h"
+#include "../common/wire_codec.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// UdpEpoller 类定义
+// 数据报模式：每个 UDP 报文承载一帧（包头 + 负载，包头格式与 TCP 相同，没有校验尾部与首字节协商），
+// 一个 socket 服务所有对端。一次可读事件用 recvmmsg 把一批报文收进预先分配的槽位，逐个交给 OnDatagram，
+// 需要应答的报文直接以槽位中的负载作为应答，整批用一次 sendmmsg 发出；内核支持 UDP GSO 时，
+// 发往同一对端、长度相同的连续应答合并为一个带 UDP_SEGMENT 的消息，由内核（或网卡）切分。
+// 收发路径上没有按报文的内存分配；超过 max_datagram 的报文被截断，计为丢弃。
+
+class UdpEpoller : public Epoller {
+public:
+    static constexpr size_t kBatchSize = 64;
+    static constexpr size_t kDefaultMaxDatagram = 4096;
+    
+    UdpEpoller(int fd, const WireFormat* wire_format, size_t max_datagram = kDefaultMaxDatagram);
+    virtual ~UdpEpoller();
+    
+    virtual void In() override;
+    virtual void Out() override;
+    // 上一批应答因发送缓冲区满未发完时只关心可写：槽位仍被应答引用，不能接收下一批
+    virtual uint32_t Events() const override;
+    // 报文不经过 Packet 路径
+    virtual void RecvImpl(Packet packet) override;
+    
+    // 仍在使用 GSO（探测不支持或出口设备不支持校验和卸载时关闭）
+    bool gso_enabled() const { return gso_max_segment_ > 0; }
+
+protected:
+    // 收到一帧：header 已解码，payload 指向 header.length 字节的负载，可就地修改。
+    // 返回 true 时以 header（不能修改 length）与 payload 作为应答发回对端；payload 在本批应答发出前有效
+    virtual bool OnDatagram(PacketHeader& header, uint8_t* payload) = 0;
+
+private:
+    // 收一批报文，返回报文数；没有数据或出错时返回 0
+    size_t ReceiveBatch();
+    // 解码并交给 OnDatagram，收集应答
+    void ProcessBatch(size_t count);
+    // 从第 first 个应答开始按当前 GSO 限制重新编排发送消息
+    void BuildSendList(size_t first);
+    // 发出剩余的发送消息；发送缓冲区满时返回 false
+    bool SendReplies();
+    bool SamePeer(size_t a, size_t b) const;
+    uint8_t* Slot(size_t index) const { return buffers_.get() + index * slot_stride_; }
+    
+    const WireFormat* wire_format_;
+    size_t max_datagram_;
+    size_t slot_stride_;
+    std::unique_ptr<uint8_t[]> buffers_;
+    
+    std::array<mmsghdr, kBatchSize> recv_msgs_;
+    std::array<iovec, kBatchSize> recv_iov_;
+    std::array<sockaddr_storage, kBatchSize> peers_;
+    
+    // 第 k 个应答：来自槽位 reply_slot_[k]，线上长度 reply_size_[k]，
+    // 占 reply_iov_[2k]（重新编码的包头）与 reply_iov_[2k + 1]（槽位中的负载）
+    std::array<uint8_t, kBatchSize> reply_slot_;
+    std::array<uint32_t, kBatchSize> reply_size_;
+    std::array<iovec, 2 * kBatchSize> reply_iov_;
+    std::array<std::array<uint8_t, kMaxWireHeaderSize>, kBatchSize> reply_headers_;
+    size_t reply_count_;
+    
+    // 发送消息 i 覆盖应答 [send_first_[i], send_first_[i] + send_segments_[i])
+    std::array<mmsghdr, kBatchSize> send_msgs_;
+    std::array<uint8_t, kBatchSize> send_first_;
+    std::array<uint8_t, kBatchSize> send_segments_;
+    // UDP_SEGMENT 控制消息
+    struct Control {
+        alignas(cmsghdr) uint8_t data[CMSG_SPACE(sizeof(uint16_t))];
+    };
+    std::array<Control, kBatchSize> send_control_;
+    size_t send_count_;
+    size_t send_next_;
+    // 本批报文的接收时刻，用于记录处理延迟
+    uint64_t batch_received_ns_;
+    
+    // 使用 GSO 的最大分段长度，0 表示不用
+    size_t gso_max_segment_;
+    bool want_out_;
+};
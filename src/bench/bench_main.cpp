@@ -0,0 +1,111 @@
+#include "bench_runner.h"
+#include "data_path_benchmarks.h"
+#include "../include/common/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <unistd.h>
+
+// 替换全局 operator new 以统计堆分配次数；对齐版本不替换，按默认实现走且不计数
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+
+void* CountedAlloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+}  // namespace
+
+uint64_t AllocationCount() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+static void PrintUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  -f filter     只运行名称包含该子串的基准\n"
+              << "  -r reps       每个基准的重复次数，取中位数，默认5\n"
+              << "  -m ms         每次重复的目标时长（毫秒），默认100\n"
+              << "  -o file       把结果保存为基线文件\n"
+              << "  -c file       与基线文件对比，有回退时退出码为 2\n"
+              << "  -T percent    ns/op 变慢超过该百分比视为回退，默认10\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::string save_path;
+    std::string baseline_path;
+    double threshold = 10;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "f:r:m:o:c:T:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                options.filter = optarg;
+                break;
+            case 'r':
+                options.repetitions = std::max(1, std::atoi(optarg));
+                break;
+            case 'm':
+                options.min_time_ms = std::atof(optarg);
+                break;
+            case 'o':
+                save_path = optarg;
+                break;
+            case 'c':
+                baseline_path = optarg;
+                break;
+            case 'T':
+                threshold = std::atof(optarg);
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    
+    // 先读基线，文件不存在时尽早报错而不是跑完所有基准
+    std::map<std::string, BenchResult> baseline;
+    if (!baseline_path.empty() && !LoadBaseline(baseline_path, &baseline)) {
+        std::cerr << "Cannot read baseline " << baseline_path << std::endl;
+        return 1;
+    }
+    
+    // Center 启停的 INFO 日志会打断结果表格
+    Logger::SetLevel(LogLevel::WARN);
+    
+    BenchRunner runner(options);
+    RegisterDataPathBenchmarks(&runner);
+    std::vector<BenchResult> results = runner.RunAll();
+    
+    if (!save_path.empty()) {
+        if (!SaveBaseline(save_path, results)) {
+            std::cerr << "Cannot write baseline " << save_path << std::endl;
+            return 1;
+        }
+        std::cout << "Baseline saved to " << save_path << std::endl;
+    }
+    if (!baseline_path.empty()) {
+        size_t regressions = CompareBaseline(results, baseline, threshold);
+        if (regressions > 0) {
+            std::cout << regressions << " regression(s) beyond " << threshold << "%" << std::endl;
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "bench_runner.h"
+#include "../include/core/metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// 校准阶段：单次运行至少达到该时长才用于估算迭代次数
+constexpr uint64_t kCalibrateNs = 10 * 1000 * 1000;
+constexpr uint64_t kMaxIterations = uint64_t(1) << 32;
+}
+
+BenchRunner::BenchRunner(const BenchOptions& options) : options_(options) {}
+
+void BenchRunner::Add(std::unique_ptr<Benchmark> benchmark) {
+    benchmarks_.push_back(std::move(benchmark));
+}
+
+uint64_t BenchRunner::Measure(Benchmark* benchmark, uint64_t iterations, uint64_t* allocs) {
+    uint64_t allocs_before = AllocationCount();
+    uint64_t start = MonotonicNs();
+    benchmark->Run(iterations);
+    uint64_t elapsed = MonotonicNs() - start;
+    *allocs = AllocationCount() - allocs_before;
+    return std::max<uint64_t>(elapsed, 1);
+}
+
+bool BenchRunner::RunOne(Benchmark* benchmark, BenchResult* result) {
+    if (!benchmark->Setup()) {
+        fprintf(stderr, "%s: setup failed, skipped\n", benchmark->name().c_str());
+        benchmark->Teardown();
+        return false;
+    }
+    
+    // 迭代次数按 10 倍递增直到单次足够长，同时充当预热
+    uint64_t iterations = 1;
+    uint64_t allocs = 0;
+    uint64_t elapsed = Measure(benchmark, iterations, &allocs);
+    while (elapsed < kCalibrateNs && iterations < kMaxIterations) {
+        iterations *= 10;
+        elapsed = Measure(benchmark, iterations, &allocs);
+    }
+    double target_ns = options_.min_time_ms * 1e6;
+    double estimate = static_cast<double>(iterations) * target_ns / static_cast<double>(elapsed);
+    iterations = std::clamp<uint64_t>(static_cast<uint64_t>(estimate), 1, kMaxIterations);
+    
+    std::vector<double> samples;
+    uint64_t total_allocs = 0;
+    for (int i = 0; i < options_.repetitions; i++) {
+        elapsed = Measure(benchmark, iterations, &allocs);
+        samples.push_back(static_cast<double>(elapsed) / static_cast<double>(iterations));
+        total_allocs += allocs;
+    }
+    benchmark->Teardown();
+    
+    std::sort(samples.begin(), samples.end());
+    result->name = benchmark->name();
+    result->iterations = iterations;
+    result->ns_per_op = samples[samples.size() / 2];
+    result->min_ns_per_op = samples.front();
+    result->max_ns_per_op = samples.back();
+    result->allocs_per_op = static_cast<double>(total_allocs) /
+                            (static_cast<double>(iterations) * static_cast<double>(samples.size()));
+    return true;
+}
+
+std::vector<BenchResult> BenchRunner::RunAll() {
+    std::vector<BenchResult> results;
+    printf("%-36s %12s %10s %10s %10s %12s\n", "benchmark", "iterations", "ns/op", "min", "max", "allocs/op");
+    for (const auto& benchmark : benchmarks_) {
+        if (!options_.filter.empty() && benchmark->name().find(options_.filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult result;
+        if (!RunOne(benchmark.get(), &result)) {
+            continue;
+        }
+        printf("%-36s %12llu %10.1f %10.1f %10.1f %12.3f\n", result.name.c_str(),
+               static_cast<unsigned long long>(result.iterations), result.ns_per_op, result.min_ns_per_op,
+               result.max_ns_per_op, result.allocs_per_op);
+        fflush(stdout);
+        results.push_back(result);
+    }
+    return results;
+}
+
+bool SaveBaseline(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "# benchmark ns/op allocs/op\n";
+    for (const BenchResult& result : results) {
+        out << result.name << ' ' << result.ns_per_op << ' ' << result.allocs_per_op << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool LoadBaseline(const std::string& path, std::map<std::string, BenchResult>* baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        BenchResult result;
+        if (fields >> result.name >> result.ns_per_op >> result.allocs_per_op) {
+            (*baseline)[result.name] = result;
+        }
+    }
+    return true;
+}
+
+size_t CompareBaseline(const std::vector<BenchResult>& results, const std::map<std::string, BenchResult>& baseline,
+                       double threshold_percent) {
+    size_t regressions = 0;
+    printf("\n%-36s %10s %10s %9s %12s %12s\n", "benchmark", "base ns", "ns/op", "delta", "base allocs", "allocs/op");
+    for (const BenchResult& result : results) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end()) {
+            printf("%-36s %10s %10.1f %9s %12s %12.3f\n", result.name.c_str(), "-", result.ns_per_op, "new", "-",
+                   result.allocs_per_op);
+            continue;
+        }
+        const BenchResult& base = it->second;
+        double delta = base.ns_per_op > 0 ? (result.ns_per_op - base.ns_per_op) * 100.0 / base.ns_per_op : 0.0;
+        // 分配次数是确定性的，只容忍浮点舍入
+        bool regressed = delta > threshold_percent || result.allocs_per_op > base.allocs_per_op + 0.001;
+        if (regressed) {
+            regressions++;
+        }
+        printf("%-36s %10.1f %10.1f %+8.1f%% %12.3f %12.3f%s\n", result.name.c_str(), base.ns_per_op,
+               result.ns_per_op, delta, base.allocs_per_op, result.allocs_per_op, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
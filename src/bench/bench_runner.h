@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Benchmark 基类定义
+// 每个微基准在 Run 中执行 iterations 次被测操作；Setup/Teardown 不计时。
+// 计时与分配统计由 BenchRunner 完成，子类只关心被测代码本身。
+
+class Benchmark {
+public:
+    explicit Benchmark(std::string name) : name_(std::move(name)) {}
+    virtual ~Benchmark() = default;
+    
+    virtual bool Setup() { return true; }
+    virtual void Run(uint64_t iterations) = 0;
+    virtual void Teardown() {}
+    
+    const std::string& name() const { return name_; }
+
+private:
+    std::string name_;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    // 多次重复中的中位数，以及最快/最慢一次，用于判断结果是否稳定
+    double ns_per_op = 0;
+    double min_ns_per_op = 0;
+    double max_ns_per_op = 0;
+    double allocs_per_op = 0;
+};
+
+struct BenchOptions {
+    // 只运行名称包含该子串的基准
+    std::string filter;
+    int repetitions = 5;
+    // 每次重复的目标时长
+    double min_time_ms = 100;
+};
+
+// 进程内堆分配次数（operator new 调用数），由 bench_main.cpp 中替换的全局 operator new 维护
+uint64_t AllocationCount();
+
+// 阻止编译器把被测结果当作无用代码消除
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options);
+    
+    void Add(std::unique_ptr<Benchmark> benchmark);
+    // 依次运行匹配的基准并逐行打印结果；Setup 失败的基准跳过
+    std::vector<BenchResult> RunAll();
+
+private:
+    bool RunOne(Benchmark* benchmark, BenchResult* result);
+    // 单次计时：返回耗时纳秒，*allocs 为期间的分配次数
+    static uint64_t Measure(Benchmark* benchmark, uint64_t iterations, uint64_t* allocs);
+    
+    BenchOptions options_;
+    std::vector<std::unique_ptr<Benchmark>> benchmarks_;
+};
+
+// 基线文件：每行 "名称 ns/op allocs/op"，以 # 开头的行为注释
+bool SaveBaseline(const std::string& path, const std::vector<BenchResult>& results);
+bool LoadBaseline(const std::string& path, std::map<std::string, BenchResult>* baseline);
+// 打印与基线的对比；ns/op 变慢超过 threshold_percent 或每次操作分配次数增加时视为回退，返回回退项数
+size_t CompareBaseline(const std::vector<BenchResult>& results, const std::map<std::string, BenchResult>& baseline,
+                       double threshold_percent);
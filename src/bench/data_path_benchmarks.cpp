@@ -0,0 +1,579 @@
+#include "data_path_benchmarks.h"
+#include "bench_runner.h"
+#include "../include/common/crc32c.h"
+#include "../include/common/data.h"
+#include "../include/common/packet.h"
+#include "../include/common/packet_header.h"
+#include "../include/common/wire_codec.h"
+#include "../include/net/tcp_epoller.h"
+#include "../include/core/timer_wheel.h"
+#include "../server/echo_server_center.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+PacketHeader MakeHeader(size_t payload_size) {
+    PacketHeader header{};
+    header.command = static_cast<uint32_t>(PacketHeaderCommand::DEFAULT);
+    header.length = static_cast<uint32_t>(payload_size);
+    return header;
+}
+
+// 按 format 编码的若干帧首尾相接的字节流，负载按帧序号填充；frame_ends 非空时记录每帧的结束偏移，
+// checksum 为真时每帧带校验尾部
+std::string MakeFrames(size_t payload_size, size_t count, const WireFormat& format = WireFormat::Native(),
+                       std::vector<size_t>* frame_ends = nullptr, bool checksum = false) {
+    std::string frames;
+    frames.reserve((format.max_header_size + payload_size + kChecksumSize) * count);
+    PacketHeader header = MakeHeader(payload_size);
+    uint8_t encoded[kMaxWireHeaderSize];
+    for (size_t i = 0; i < count; i++) {
+        header.extra1 = static_cast<uint32_t>(i);
+        size_t header_size = format.encode(header, encoded);
+        frames.append(reinterpret_cast<const char*>(encoded), header_size);
+        size_t payload_offset = frames.size();
+        frames.append(payload_size, static_cast<char>('a' + i % 26));
+        if (checksum) {
+            uint8_t trailer[kChecksumSize];
+            uint32_t crc = Crc32c(0, frames.data() + payload_offset, payload_size);
+            wire::Store<4, ByteOrder::LITTLE>(trailer, Crc32c(crc, encoded, header_size));
+            frames.append(reinterpret_cast<const char*>(trailer), kChecksumSize);
+        }
+        if (frame_ends) {
+            frame_ends->push_back(frames.size());
+        }
+    }
+    return frames;
+}
+
+bool SetNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool WriteAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ReadAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = read(fd, data, length);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 未注册到 Center 的 TcpEpoller：收到的帧只计数，并暴露发送队列的内部步骤
+class BenchTcpEpoller : public TcpEpoller {
+public:
+    explicit BenchTcpEpoller(int fd) : TcpEpoller(fd), received_(0) {}
+    
+    virtual void RecvImpl(Packet packet) override {
+        DoNotOptimize(packet);
+        received_++;
+    }
+    
+    using TcpEpoller::AdvanceSendQueue;
+    uint64_t received() const { return received_; }
+    size_t queued() const { return send_queue_.size(); }
+
+private:
+    uint64_t received_;
+};
+
+class DataConstructBenchmark : public Benchmark {
+public:
+    explicit DataConstructBenchmark(size_t size)
+        : Benchmark("Data/Construct/" + std::to_string(size)), payload_(size, 'x') {}
+    
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Data data(payload_.data(), payload_.size());
+            DoNotOptimize(data);
+        }
+    }
+
+private:
+    std::string payload_;
+};
+
+class DataCopyBenchmark : public Benchmark {
+public:
+    DataCopyBenchmark() : Benchmark("Data/Copy/64"), source_(64) {}
+    
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Data copy(source_);
+            DoNotOptimize(copy);
+        }
+    }
+
+private:
+    Data source_;
+};
+
+class DataMoveBenchmark : public Benchmark {
+public:
+    DataMoveBenchmark() : Benchmark("Data/Move/64"), held_(64) {}
+    
+    // 每次操作为一次移动构造加一次移动赋值，使 held_ 在循环中保持有效
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Data moved(std::move(held_));
+            DoNotOptimize(moved);
+            held_ = std::move(moved);
+        }
+    }
+
+private:
+    Data held_;
+};
+
+class PacketAckBenchmark : public Benchmark {
+public:
+    PacketAckBenchmark() : Benchmark("Packet/Ack/64"), packet_(MakeHeader(64), Data(64)) {}
+    
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Packet ack = packet_.Ack();
+            DoNotOptimize(ack);
+        }
+    }
+
+private:
+    Packet packet_;
+};
+
+// 包头解码：连续的已编码包头逐个解出；memcpy 为直接复制结构体的基线，其余经 WireFormat 的解码函数
+class HeaderDecodeBenchmark : public Benchmark {
+public:
+    explicit HeaderDecodeBenchmark(const WireFormat* format)
+        : Benchmark("Header/Decode/" + std::string(format ? format->name : "memcpy")), format_(format) {}
+    
+    virtual bool Setup() override {
+        // 编码长度随 extra1 变化，覆盖可选字段出现与缺席两种情况
+        const WireFormat& format = format_ ? *format_ : WireFormat::Native();
+        PacketHeader header = MakeHeader(64);
+        uint8_t encoded[kMaxWireHeaderSize];
+        for (size_t i = 0; i < kHeaders; i++) {
+            header.extra1 = static_cast<uint32_t>(i % 2 ? i : 0);
+            size_t size = format.encode(header, encoded);
+            stream_.insert(stream_.end(), encoded, encoded + size);
+        }
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        size_t offset = 0;
+        PacketHeader header;
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (offset == stream_.size()) {
+                offset = 0;
+            }
+            if (format_) {
+                offset += static_cast<size_t>(format_->decode(stream_.data() + offset, stream_.size() - offset, &header));
+            } else {
+                std::memcpy(&header, stream_.data() + offset, sizeof(header));
+                offset += sizeof(header);
+            }
+            DoNotOptimize(header);
+        }
+    }
+    
+    virtual void Teardown() override {
+        stream_.clear();
+    }
+
+private:
+    static constexpr size_t kHeaders = 1024;
+    const WireFormat* format_;
+    std::vector<uint8_t> stream_;
+};
+
+class HeaderEncodeBenchmark : public Benchmark {
+public:
+    explicit HeaderEncodeBenchmark(const WireFormat* format)
+        : Benchmark("Header/Encode/" + std::string(format->name)), format_(format) {}
+    
+    virtual void Run(uint64_t iterations) override {
+        PacketHeader header = MakeHeader(64);
+        uint8_t encoded[kMaxWireHeaderSize];
+        for (uint64_t i = 0; i < iterations; i++) {
+            header.extra1 = static_cast<uint32_t>(i & 1);
+            size_t size = format_->encode(header, encoded);
+            DoNotOptimize(size);
+            DoNotOptimize(encoded);
+        }
+    }
+
+private:
+    const WireFormat* format_;
+};
+
+// 默认格式下为 Frame/Decode/<负载>，其他格式追加格式名，带校验尾部时追加 crc
+std::string FrameDecodeName(size_t payload_size, const WireFormat& format, bool checksum) {
+    std::string name = "Frame/Decode/" + std::to_string(payload_size);
+    if (!format.host_layout) {
+        name += '/';
+        name += format.name;
+    }
+    if (checksum) {
+        name += "/crc";
+    }
+    return name;
+}
+
+// 帧解析：对端一次写入一批帧，TcpEpoller::In() 读出并切分；每次操作为一帧，
+// 包含分摊到每帧的 write/readv 系统调用开销
+class FrameDecodeBenchmark : public Benchmark {
+public:
+    explicit FrameDecodeBenchmark(size_t payload_size, const WireFormat& format = WireFormat::Native(), bool checksum = false)
+        : Benchmark(FrameDecodeName(payload_size, format, checksum)),
+          payload_size_(payload_size), format_(format), checksum_(checksum), peer_fd_(-1) {}
+    
+    virtual bool Setup() override {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 || !SetNonBlocking(fds[0])) {
+            return false;
+        }
+        epoller_ = std::make_unique<BenchTcpEpoller>(fds[0]);
+        epoller_->SetWireFormat(&format_);
+        epoller_->SetChecksum(checksum_);
+        peer_fd_ = fds[1];
+        // 每批约 32KB，保证一次写入不会阻塞在 socket 缓冲区上
+        size_t frame_size = format_.max_header_size + payload_size_ + kChecksumSize;
+        batch_ = std::max<size_t>(1, 32768 / frame_size);
+        frame_ends_.clear();
+        frames_ = MakeFrames(payload_size_, batch_, format_, &frame_ends_, checksum_);
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        uint64_t target = epoller_->received() + iterations;
+        while (epoller_->received() < target) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(batch_, target - epoller_->received()));
+            if (!WriteAll(peer_fd_, frames_.data(), frame_ends_[count - 1])) {
+                return;
+            }
+            uint64_t expected = epoller_->received() + count;
+            while (epoller_->received() < expected && epoller_->GetFd() >= 0) {
+                epoller_->In();
+            }
+            if (epoller_->GetFd() < 0) {
+                return;
+            }
+        }
+    }
+    
+    virtual void Teardown() override {
+        if (epoller_) {
+            epoller_->Close();
+            epoller_.reset();
+        }
+        if (peer_fd_ >= 0) {
+            close(peer_fd_);
+            peer_fd_ = -1;
+        }
+    }
+
+private:
+    size_t payload_size_;
+    const WireFormat& format_;
+    bool checksum_;
+    size_t batch_ = 0;
+    std::string frames_;
+    // 变长包头下各帧长度不同，按帧结束偏移写出前 count 帧
+    std::vector<size_t> frame_ends_;
+    std::unique_ptr<BenchTcpEpoller> epoller_;
+    int peer_fd_;
+};
+
+// CRC32C 吞吐：运行时选中的实现（硬件指令可用时）与查表实现对比；每次操作为 size 字节
+class Crc32cBenchmark : public Benchmark {
+public:
+    Crc32cBenchmark(size_t size, bool portable)
+        : Benchmark("Crc32c/" + std::string(portable ? "table" : Crc32cImplementation()) + "/" + std::to_string(size)),
+          data_(size, 'x'), portable_(portable) {}
+    
+    virtual void Run(uint64_t iterations) override {
+        uint32_t crc = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            crc = portable_ ? Crc32cPortable(crc, data_.data(), data_.size()) : Crc32c(crc, data_.data(), data_.size());
+        }
+        DoNotOptimize(crc);
+    }
+
+private:
+    std::string data_;
+    bool portable_;
+};
+
+// 发送队列入队与出队，不涉及系统调用
+class SendQueuePushPopBenchmark : public Benchmark {
+public:
+    SendQueuePushPopBenchmark() : Benchmark("SendQueue/PushPop/64"), packet_(MakeHeader(64), Data(64)) {}
+    
+    virtual bool Setup() override {
+        epoller_ = std::make_unique<BenchTcpEpoller>(-1);
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        size_t frame_size = sizeof(PacketHeader) + packet_.data().length();
+        for (uint64_t i = 0; i < iterations; i++) {
+            epoller_->Send(packet_);
+            epoller_->AdvanceSendQueue(frame_size);
+        }
+    }
+    
+    virtual void Teardown() override {
+        epoller_.reset();
+    }
+
+private:
+    Packet packet_;
+    std::unique_ptr<BenchTcpEpoller> epoller_;
+};
+
+// 聚合写：入队一批 Packet 后由 Out() 以 sendmsg 写出，对端读空；每次操作为一个 Packet。
+// 带校验尾部时包含入队时的负载 CRC 与写出时续上的包头 CRC
+class GatherWriteBenchmark : public Benchmark {
+public:
+    static constexpr size_t kBatch = 32;
+    
+    GatherWriteBenchmark(size_t payload_size, bool checksum)
+        : Benchmark("SendQueue/GatherWrite/" + std::to_string(payload_size) + (checksum ? "/crc" : "")),
+          packet_(MakeHeader(payload_size), Data(payload_size)), checksum_(checksum), peer_fd_(-1) {}
+    
+    virtual bool Setup() override {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 || !SetNonBlocking(fds[0])) {
+            return false;
+        }
+        epoller_ = std::make_unique<BenchTcpEpoller>(fds[0]);
+        epoller_->SetChecksum(checksum_);
+        peer_fd_ = fds[1];
+        drain_.resize(kBatch * FrameSize());
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        size_t frame_size = FrameSize();
+        uint64_t done = 0;
+        while (done < iterations) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(kBatch, iterations - done));
+            for (size_t i = 0; i < count; i++) {
+                epoller_->Send(packet_);
+            }
+            epoller_->Out();
+            if (epoller_->queued() != 0 || !ReadAll(peer_fd_, drain_.data(), count * frame_size)) {
+                return;
+            }
+            done += count;
+        }
+    }
+    
+    virtual void Teardown() override {
+        if (epoller_) {
+            epoller_->Close();
+            epoller_.reset();
+        }
+        if (peer_fd_ >= 0) {
+            close(peer_fd_);
+            peer_fd_ = -1;
+        }
+    }
+
+private:
+    size_t FrameSize() const {
+        return sizeof(PacketHeader) + packet_.data().length() + (checksum_ ? kChecksumSize : 0);
+    }
+    
+    Packet packet_;
+    bool checksum_;
+    std::unique_ptr<BenchTcpEpoller> epoller_;
+    std::vector<char> drain_;
+    int peer_fd_;
+};
+
+// 定时轮：已有 count 个定时器时，依次对其中一个重新计时再取消（连接超时的每包开销上限）
+class TimerRearmBenchmark : public Benchmark {
+public:
+    explicit TimerRearmBenchmark(size_t count)
+        : Benchmark("Timer/RearmCancel/" + std::to_string(count)), count_(count) {}
+    
+    virtual bool Setup() override {
+        wheel_ = std::make_unique<TimerWheel>(0);
+        timers_ = std::make_unique<Timer[]>(count_);
+        for (size_t i = 0; i < count_; i++) {
+            wheel_->Arm(&timers_[i], 1000 + i % 60000);
+        }
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            Timer* timer = &timers_[i % count_];
+            wheel_->Arm(timer, 30000);
+            timer->Cancel();
+            wheel_->Arm(timer, 1000 + i % 60000);
+        }
+    }
+    
+    virtual void Teardown() override {
+        timers_.reset();
+        wheel_.reset();
+    }
+
+private:
+    size_t count_;
+    std::unique_ptr<TimerWheel> wheel_;
+    std::unique_ptr<Timer[]> timers_;
+};
+
+// Center 事件循环：回射服务在独立线程运行，另有 K 个空闲连接；
+// 每次操作为活跃连接上一个 64 字节帧的完整往返。coroutine 为真时连接由 CoroEchoHandler 处理
+class CenterRoundTripBenchmark : public Benchmark {
+public:
+    CenterRoundTripBenchmark(size_t idle, bool coroutine)
+        : Benchmark("Center/RoundTrip/" + std::string(coroutine ? "coro/" : "") + "idle=" + std::to_string(idle)), idle_(idle),
+          coroutine_(coroutine), active_fd_(-1) {}
+    
+    virtual bool Setup() override {
+        if (!RaiseFdLimit(2 * idle_ + 64)) {
+            return false;
+        }
+        center_ = std::make_unique<EchoServerCenter>(coroutine_);
+        if (!center_->Init()) {
+            return false;
+        }
+        for (size_t i = 0; i <= idle_; i++) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 || !SetNonBlocking(fds[0])) {
+                return false;
+            }
+            center_->PostConnection(fds[0]);
+            if (i == idle_) {
+                active_fd_ = fds[1];
+            } else {
+                idle_fds_.push_back(fds[1]);
+            }
+        }
+        frame_ = MakeFrames(64, 1);
+        reply_.resize(frame_.size());
+        thread_ = std::thread([this]() { center_->Run(); });
+        return true;
+    }
+    
+    virtual void Run(uint64_t iterations) override {
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (!WriteAll(active_fd_, frame_.data(), frame_.size()) ||
+                !ReadAll(active_fd_, reply_.data(), reply_.size())) {
+                return;
+            }
+        }
+    }
+    
+    virtual void Teardown() override {
+        if (center_) {
+            center_->Stop();
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        center_.reset();
+        for (int fd : idle_fds_) {
+            close(fd);
+        }
+        idle_fds_.clear();
+        if (active_fd_ >= 0) {
+            close(active_fd_);
+            active_fd_ = -1;
+        }
+    }
+
+private:
+    static bool RaiseFdLimit(size_t needed) {
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return false;
+        }
+        if (limit.rlim_cur >= needed) {
+            return true;
+        }
+        if (limit.rlim_max < needed) {
+            return false;
+        }
+        limit.rlim_cur = needed;
+        return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+    }
+    
+    size_t idle_;
+    bool coroutine_;
+    std::unique_ptr<EchoServerCenter> center_;
+    std::thread thread_;
+    std::vector<int> idle_fds_;
+    int active_fd_;
+    std::string frame_;
+    std::vector<char> reply_;
+};
+
+}  // namespace
+
+void RegisterDataPathBenchmarks(BenchRunner* runner) {
+    runner->Add(std::make_unique<DataConstructBenchmark>(64));
+    runner->Add(std::make_unique<DataConstructBenchmark>(4096));
+    runner->Add(std::make_unique<DataCopyBenchmark>());
+    runner->Add(std::make_unique<DataMoveBenchmark>());
+    runner->Add(std::make_unique<PacketAckBenchmark>());
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(64));
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(4096));
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(64, *WireFormat::Find("slim")));
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(64, WireFormat::Compact()));
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(64, WireFormat::Native(), true));
+    runner->Add(std::make_unique<FrameDecodeBenchmark>(4096, WireFormat::Native(), true));
+    runner->Add(std::make_unique<HeaderDecodeBenchmark>(nullptr));
+    for (const char* name : {"native", "network", "slim", "compact"}) {
+        runner->Add(std::make_unique<HeaderDecodeBenchmark>(WireFormat::Find(name)));
+        runner->Add(std::make_unique<HeaderEncodeBenchmark>(WireFormat::Find(name)));
+    }
+    runner->Add(std::make_unique<SendQueuePushPopBenchmark>());
+    runner->Add(std::make_unique<GatherWriteBenchmark>(64, false));
+    runner->Add(std::make_unique<GatherWriteBenchmark>(4096, false));
+    runner->Add(std::make_unique<GatherWriteBenchmark>(4096, true));
+    for (size_t size : {64, 4096, 65536}) {
+        runner->Add(std::make_unique<Crc32cBenchmark>(size, false));
+        runner->Add(std::make_unique<Crc32cBenchmark>(size, true));
+    }
+    runner->Add(std::make_unique<TimerRearmBenchmark>(100000));
+    runner->Add(std::make_unique<CenterRoundTripBenchmark>(0, false));
+    runner->Add(std::make_unique<CenterRoundTripBenchmark>(1000, false));
+    runner->Add(std::make_unique<CenterRoundTripBenchmark>(0, true));
+}
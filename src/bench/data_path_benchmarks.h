@@ -0,0 +1,7 @@
+#pragma once
+
+class BenchRunner;
+
+// 注册每包路径上的微基准：Data 构造/拷贝/移动、Packet::Ack、socketpair 上的帧解析（含校验尾部）、CRC32C 吞吐、
+// 发送队列入队/出队与聚合写、定时轮重新计时，以及带 K 个空闲连接时 Center 事件循环的往返开销（回调与协程两种连接处理）
+void RegisterDataPathBenchmarks(BenchRunner* runner);
@@ -2,52 +2,160 @@
 #include "../include/common/packet_header.h"
 #include "../include/common/packet.h"
 #include "../include/common/data.h"
+#include "../include/net/endpoint.h"
 #include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
 #include <unistd.h>
 #include <cstring>
 #include <cerrno>
+#include <cstdlib>
+#include <algorithm>
 #include <string>
+#include "load_generator.h"
+
+static void PrintUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-b] [options] [host] [port]\n"
+              << "  host 可为 IPv4/IPv6 地址，或 unix:/path、unix:@name 连接 Unix 域 socket（忽略 port）\n"
+              << "  不带 -b 时发送三个测试包并校验回射\n"
+              << "  -b            压测模式\n"
+              << "  -t threads    压测线程数，默认1\n"
+              << "  -c conns      每个线程的连接数，默认1\n"
+              << "  -d depth      每个连接在途请求数（流水线深度），默认1\n"
+              << "  -s sizes      负载大小：64、64-4096（均匀）或 64:90,1024:10（加权），默认64\n"
+              << "  -r rate       开环模式的总请求速率（次/秒），按计划发送时间统计延迟；默认0为闭环\n"
+              << "  -D seconds    统计时长，默认10\n"
+              << "  -w seconds    预热时长（不计入统计），默认2\n"
+              << "  -S seed       随机种子，相同种子下负载序列可复现，默认1\n"
+              << "  -j            以单行 JSON 输出结果\n"
+              << "  -f format     压测模式的包头格式：native（默认）/network/slim 须与服务端 -f 一致；\n"
+              << "                compact 在连接首字节协商，任何服务端格式下都可用\n"
+              << "  -k            压测模式下每帧附带 CRC32C 校验尾部并校验应答，在连接开头协商\n"
+              << "  -u            压测模式改用 UDP，每个请求一个报文（服务端 -a udp:...）；应答按 extra1 匹配；不重传，1 秒内未收到应答的请求计为丢失（lost）\n"
+              << "  -m            压测模式经 Unix 域 socket（host 为 unix:...）协商改用共享内存环收发，客户端忙轮询\n"
+              << "  -x usec:ratio 压测模式下按 ratio 的比例发送耗时请求（WORK），服务端为每个占用 usec 微秒 CPU；\n"
+              << "                其延迟单独输出，latency 只统计普通回射请求；服务端须以 -X 开启且 usec 不超过其上限\n"
+              << "  -o            耗时请求允许乱序应答，按 extra1 匹配\n";
+}
+
+static int RunBenchmark(const LoadConfig& config) {
+    LoadResult result;
+    if (!RunLoad(config, &result)) {
+        return 1;
+    }
+    PrintLoadResult(config, result);
+    return result.errors == 0 ? 0 : 2;
+}
 
 int main(int argc, char* argv[]) {
-    std::cout << "Echo Client Starting..." << std::endl;
+    LoadConfig config;
+    bool bench = false;
     
-    const char* host = "127.0.0.1";
-    uint16_t port = 8888;
+    int opt;
+    while ((opt = getopt(argc, argv, "bt:c:d:s:r:D:w:S:jf:kumx:oh")) != -1) {
+        switch (opt) {
+            case 'b':
+                bench = true;
+                break;
+            case 't':
+                config.threads = std::max(1, std::atoi(optarg));
+                break;
+            case 'c':
+                config.connections = std::max(1, std::atoi(optarg));
+                break;
+            case 'd':
+                config.pipeline = std::max(1, std::atoi(optarg));
+                break;
+            case 's':
+                if (!config.sizes.Parse(optarg)) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'r':
+                config.rate = std::atof(optarg);
+                break;
+            case 'D':
+                config.duration_sec = std::atof(optarg);
+                break;
+            case 'w':
+                config.warmup_sec = std::atof(optarg);
+                break;
+            case 'S':
+                config.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'j':
+                config.json = true;
+                break;
+            case 'f':
+                config.wire_format = WireFormat::Find(optarg);
+                if (!config.wire_format) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'k':
+                config.checksum = true;
+                break;
+            case 'u':
+                config.udp = true;
+                break;
+            case 'm':
+                config.shm = true;
+                break;
+            case 'x': {
+                const char* colon = strchr(optarg, ':');
+                if (!colon) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                config.work_us = static_cast<uint32_t>(std::max(0, std::atoi(optarg))) & ~kWorkUnordered;
+                config.work_ratio = std::min(1.0, std::max(0.0, std::atof(colon + 1)));
+                break;
+            }
+            case 'o':
+                config.work_unordered = true;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc) {
+        config.host = argv[optind];
+    }
+    if (optind + 1 < argc) {
+        config.port = static_cast<uint16_t>(std::atoi(argv[optind + 1]));
+    }
     
-    if (argc > 1) {
-        host = argv[1];
+    if (bench) {
+        return RunBenchmark(config);
     }
-    if (argc > 2) {
-        port = static_cast<uint16_t>(std::atoi(argv[2]));
+    
+    std::cout << "Echo Client Starting..." << std::endl;
+    
+    const char* host = config.host.c_str();
+    uint16_t port = config.port;
+    
+    Endpoint endpoint;
+    if (!Endpoint::FromHostPort(host, port, &endpoint)) {
+        std::cerr << "Invalid address: " << host << std::endl;
+        return 1;
     }
     
     // 创建socket
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int sock = socket(endpoint.family(), SOCK_STREAM, 0);
     if (sock < 0) {
         std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
         return 1;
     }
     
     // 连接服务器
-    sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    
-    if (inet_pton(AF_INET, host, &server_addr.sin_addr) <= 0) {
-        std::cerr << "Invalid address: " << host << std::endl;
-        close(sock);
-        return 1;
-    }
-    
-    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+    if (connect(sock, endpoint.addr(), endpoint.addr_len()) < 0) {
         std::cerr << "Failed to connect: " << strerror(errno) << std::endl;
         close(sock);
         return 1;
     }
     
-    std::cout << "Connected to " << host << ":" << port << std::endl;
+    std::cout << "Connected to " << endpoint.ToString() << std::endl;
     
     // 发送几个测试包
     for (int i = 1; i <= 3; i++) {
@@ -0,0 +1,60 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <bit>
+
+LatencyHistogram::LatencyHistogram() : counts_(kBucketCount, 0), count_(0), sum_(0), min_(UINT64_MAX), max_(0) {}
+
+size_t LatencyHistogram::IndexOf(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    // 最高位在第 k 位：取其下 kSubBucketBits 位作为子桶号
+    unsigned k = static_cast<unsigned>(std::bit_width(value)) - 1;
+    unsigned shift = k - kSubBucketBits;
+    size_t sub = static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::UpperBoundOf(size_t index) {
+    size_t bucket = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    if (bucket == 0) {
+        return sub;
+    }
+    unsigned shift = static_cast<unsigned>(bucket - 1);
+    uint64_t lower = (kSubBuckets + sub) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    counts_[IndexOf(value)]++;
+    count_++;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(UpperBoundOf(i), max_);
+        }
+    }
+    return max_;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LatencyHistogram 类定义
+// 对数-线性分桶：每个 2 的幂区间再等分为 64 个子桶，相对误差不超过约 1.6%，
+// 覆盖 0 ~ 2^64 纳秒。压测线程各持一份，结束后合并。
+
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    
+    void Record(uint64_t value);
+    void Merge(const LatencyHistogram& other);
+    
+    // 分位数（q 取 0~1），返回所在子桶的上界，不超过 max
+    uint64_t Percentile(double q) const;
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+private:
+    static constexpr unsigned kSubBucketBits = 6;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+    
+    static size_t IndexOf(uint64_t value);
+    static uint64_t UpperBoundOf(size_t index);
+    
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
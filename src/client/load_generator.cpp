@@ -0,0 +1,762 @@
+#include "load_generator.h"
+#include "../include/common/packet_header.h"
+#include "../include/common/crc32c.h"
+#include "../include/net/endpoint.h"
+#include "../include/net/shm_ring.h"
+#include "../include/net/udp_epoller.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <fcntl.h>
+#include <sched.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kReadChunk = 65536;
+// UDP 模式下每次 sendmmsg/recvmmsg 的报文数
+constexpr size_t kDatagramBatch = 64;
+// UDP 模式下请求发出后超过该时长仍无应答即视为丢失
+constexpr uint64_t kDatagramLossNs = 1000000000;
+// 共享内存环模式下最后一次收发之后继续轮询的时长，之后才在门铃上休眠
+constexpr uint64_t kRingSpinNs = 200000;
+// 共享内存环模式下 socket 事件的标记，与门铃事件区分
+constexpr uint64_t kSocketEventTag = uint64_t(1) << 63;
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+struct Request {
+    // 开环模式下为计划发送时间（协调遗漏修正），闭环模式下为实际发送时间
+    uint64_t start_ns;
+    uint32_t seq;
+    uint32_t size;
+    bool work;
+};
+
+struct Connection {
+    int fd = -1;
+    std::vector<uint8_t> out;
+    size_t out_offset = 0;
+    // UDP 模式下 out 中各报文的长度，datagram_next 之前的已发出
+    std::vector<uint32_t> datagrams;
+    size_t datagram_next = 0;
+    // 共享内存环模式下代替 socket 收发
+    std::unique_ptr<ShmRing> ring;
+    std::vector<uint8_t> in;
+    size_t in_offset = 0;
+    std::deque<Request> outstanding;
+    uint32_t next_seq = 0;
+    uint64_t next_send_ns = 0;
+    bool want_write = false;
+    std::mt19937_64 rng;
+};
+
+class Worker {
+public:
+    Worker(const LoadConfig& config, size_t index, const std::vector<uint8_t>& pattern)
+        : config_(config), index_(index), pattern_(pattern), epoll_fd_(-1), interval_ns_(0),
+          ring_yield_(std::thread::hardware_concurrency() <= config.threads) {}
+    
+    ~Worker() {
+        for (Connection& conn : connections_) {
+            if (conn.fd >= 0) {
+                close(conn.fd);
+            }
+        }
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+    
+    bool Connect();
+    void Run(uint64_t start_ns, uint64_t warmup_end_ns, uint64_t end_ns);
+    const LoadResult& result() const { return result_; }
+
+private:
+    void Enqueue(Connection& conn, uint64_t start_ns);
+    void Flush(Connection& conn);
+    void SendDatagrams(Connection& conn);
+    void ReadResponses(Connection& conn, uint64_t warmup_end_ns);
+    void ReceiveDatagrams(Connection& conn);
+    // UDP 模式：把超时未应答的请求移出在途队列并计为丢失，闭环时补发
+    void ExpireDatagrams(Connection& conn, uint64_t now, uint64_t warmup_end_ns);
+    void Fail(Connection& conn);
+    // 共享内存环模式：所有环都没有数据时置位等待标志，返回 false 表示不能休眠（已撤销）
+    bool ArmRings();
+    void DisarmRings();
+    
+    const LoadConfig& config_;
+    size_t index_;
+    const std::vector<uint8_t>& pattern_;
+    int epoll_fd_;
+    // 开环模式下每个连接的请求间隔
+    uint64_t interval_ns_;
+    std::vector<Connection> connections_;
+    // UDP 模式下 recvmmsg 的接收槽位
+    std::vector<uint8_t> datagram_buffer_;
+    size_t datagram_slot_ = 0;
+    // 共享内存环模式下累计收发的字节数，用于判断本轮轮询是否有进展
+    uint64_t ring_bytes_ = 0;
+    // 压测线程占满所有核时轮询之间让出 CPU，否则服务端要等本线程的时间片用完才能处理请求
+    bool ring_yield_;
+    LoadResult result_;
+};
+
+bool Worker::Connect() {
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ < 0) {
+        std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    Endpoint endpoint;
+    if (!Endpoint::FromHostPort(config_.host.c_str(), config_.port, &endpoint)) {
+        std::cerr << "Invalid address: " << config_.host << std::endl;
+        return false;
+    }
+    
+    if (config_.udp) {
+        datagram_slot_ = config_.wire_format->max_header_size + config_.sizes.max();
+        datagram_buffer_.resize(kDatagramBatch * datagram_slot_);
+    }
+    connections_.resize(config_.connections);
+    for (size_t i = 0; i < connections_.size(); i++) {
+        Connection& conn = connections_[i];
+        // 每个连接独立播种，相同 seed 下负载序列可复现
+        conn.rng.seed(config_.seed * 1000003 + index_ * config_.connections + i);
+        conn.fd = socket(endpoint.family(), config_.udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+        if (conn.fd < 0 || connect(conn.fd, endpoint.addr(), endpoint.addr_len()) < 0) {
+            std::cerr << "Failed to connect: " << strerror(errno) << std::endl;
+            return false;
+        }
+        // 共享内存环先在阻塞 socket 上协商，之后的 magic 字节与请求都经环发送
+        if (config_.shm) {
+            conn.ring = endpoint.is_unix() ? ShmRing::Negotiate(conn.fd) : nullptr;
+            if (!conn.ring) {
+                std::cerr << "Failed to set up shared ring with " << endpoint.ToString() << std::endl;
+                return false;
+            }
+        }
+        // 需要协商的格式：首字节随第一批请求发出
+        if (config_.wire_format->magic != 0) {
+            conn.out.push_back(config_.wire_format->magic);
+        }
+        if (config_.checksum) {
+            conn.out.push_back(kChecksumMagic);
+        }
+        if (!endpoint.is_unix() && !config_.udp) {
+            int one = 1;
+            setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        fcntl(conn.fd, F_SETFL, fcntl(conn.fd, F_GETFL) | O_NONBLOCK);
+        
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        if (conn.ring) {
+            // 门铃驱动收发；socket 只会在服务端关闭时可读
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn.ring->doorbell_fd(), &ev);
+            ev.data.u64 = i | kSocketEventTag;
+        }
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn.fd, &ev);
+    }
+    return true;
+}
+
+void Worker::Enqueue(Connection& conn, uint64_t start_ns) {
+    uint32_t size = config_.sizes.Sample(conn.rng);
+    bool work = config_.work_ratio > 0 && std::uniform_real_distribution<double>(0, 1)(conn.rng) < config_.work_ratio;
+    PacketHeader header{};
+    header.command = static_cast<uint32_t>(work ? PacketHeaderCommand::WORK : PacketHeaderCommand::DEFAULT);
+    header.length = size;
+    header.extra1 = conn.next_seq;
+    if (work) {
+        header.extra2 = config_.work_us | (config_.work_unordered ? kWorkUnordered : 0);
+    }
+    
+    uint8_t header_bytes[kMaxWireHeaderSize];
+    size_t header_size = config_.wire_format->encode(header, header_bytes);
+    conn.out.insert(conn.out.end(), header_bytes, header_bytes + header_size);
+    conn.out.insert(conn.out.end(), pattern_.begin(), pattern_.begin() + size);
+    if (config_.checksum) {
+        uint8_t trailer[kChecksumSize];
+        wire::Store<4, ByteOrder::LITTLE>(trailer, Crc32c(Crc32c(0, pattern_.data(), size), header_bytes, header_size));
+        conn.out.insert(conn.out.end(), trailer, trailer + kChecksumSize);
+    }
+    if (config_.udp) {
+        conn.datagrams.push_back(static_cast<uint32_t>(header_size + size));
+    }
+    conn.outstanding.push_back(Request{start_ns, conn.next_seq, size, work});
+    conn.next_seq++;
+}
+
+void Worker::Flush(Connection& conn) {
+    if (config_.udp) {
+        SendDatagrams(conn);
+    }
+    if (conn.ring && conn.out_offset < conn.out.size()) {
+        iovec iov{conn.out.data() + conn.out_offset, conn.out.size() - conn.out_offset};
+        ssize_t n = conn.ring->Write(&iov, 1);
+        if (n < 0) {
+            Fail(conn);
+            return;
+        }
+        conn.out_offset += static_cast<size_t>(n);
+        ring_bytes_ += static_cast<size_t>(n);
+    }
+    while (conn.fd >= 0 && conn.out_offset < conn.out.size() && !config_.udp && !conn.ring) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.out_offset, conn.out.size() - conn.out_offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            Fail(conn);
+            return;
+        }
+        conn.out_offset += static_cast<size_t>(n);
+    }
+    if (conn.fd < 0) {
+        return;
+    }
+    if (conn.out_offset == conn.out.size()) {
+        conn.out.clear();
+        conn.out_offset = 0;
+        conn.datagrams.clear();
+        conn.datagram_next = 0;
+    }
+    if (conn.ring) {
+        return;
+    }
+    
+    bool want_write = !conn.out.empty();
+    if (want_write != conn.want_write) {
+        epoll_event ev{};
+        ev.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        ev.data.u64 = static_cast<uint64_t>(&conn - connections_.data());
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.want_write = want_write;
+    }
+}
+
+void Worker::SendDatagrams(Connection& conn) {
+    mmsghdr msgs[kDatagramBatch];
+    iovec iov[kDatagramBatch];
+    while (conn.fd >= 0 && conn.datagram_next < conn.datagrams.size()) {
+        size_t count = std::min(kDatagramBatch, conn.datagrams.size() - conn.datagram_next);
+        size_t offset = conn.out_offset;
+        for (size_t i = 0; i < count; i++) {
+            iov[i].iov_base = conn.out.data() + offset;
+            iov[i].iov_len = conn.datagrams[conn.datagram_next + i];
+            msgs[i] = mmsghdr{};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            offset += iov[i].iov_len;
+        }
+        int n = sendmmsg(conn.fd, msgs, static_cast<unsigned>(count), 0);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Fail(conn);
+            }
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            conn.out_offset += iov[i].iov_len;
+        }
+        conn.datagram_next += static_cast<size_t>(n);
+    }
+}
+
+void Worker::ReceiveDatagrams(Connection& conn) {
+    mmsghdr msgs[kDatagramBatch];
+    iovec iov[kDatagramBatch];
+    while (conn.fd >= 0) {
+        for (size_t i = 0; i < kDatagramBatch; i++) {
+            iov[i].iov_base = datagram_buffer_.data() + i * datagram_slot_;
+            iov[i].iov_len = datagram_slot_;
+            msgs[i] = mmsghdr{};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(conn.fd, msgs, kDatagramBatch, 0, nullptr);
+        if (n < 0) {
+            // 已连接的 UDP socket 上 ECONNREFUSED 表示服务端端口未监听
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Fail(conn);
+            }
+            return;
+        }
+        // 报文依次拼入接收缓冲区，按流式帧同样解析
+        for (int i = 0; i < n; i++) {
+            const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+            conn.in.insert(conn.in.end(), data, data + msgs[i].msg_len);
+        }
+        if (static_cast<size_t>(n) < kDatagramBatch) {
+            return;
+        }
+    }
+}
+
+void Worker::ReadResponses(Connection& conn, uint64_t warmup_end_ns) {
+    uint8_t chunk[kReadChunk];
+    if (config_.udp) {
+        ReceiveDatagrams(conn);
+    }
+    while (conn.ring) {
+        ssize_t n = conn.ring->Read(chunk, sizeof(chunk));
+        if (n < 0) {
+            Fail(conn);
+            return;
+        }
+        if (n == 0) {
+            break;
+        }
+        conn.in.insert(conn.in.end(), chunk, chunk + n);
+        ring_bytes_ += n;
+    }
+    while (conn.fd >= 0 && !config_.udp && !conn.ring) {
+        ssize_t n = recv(conn.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            conn.in.insert(conn.in.end(), chunk, chunk + n);
+            continue;
+        }
+        if (n == 0) {
+            Fail(conn);
+            return;
+        }
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Fail(conn);
+            }
+            break;
+        }
+    }
+    
+    uint64_t now = NowNs();
+    size_t trailer_size = config_.checksum ? kChecksumSize : 0;
+    while (conn.fd >= 0) {
+        PacketHeader header;
+        size_t available = conn.in.size() - conn.in_offset;
+        const uint8_t* frame = conn.in.data() + conn.in_offset;
+        int header_size = config_.wire_format->decode(frame, available, &header);
+        if (header_size <= 0 || available < header_size + header.length + trailer_size) {
+            break;
+        }
+        const uint8_t* payload = frame + header_size;
+        size_t frame_size = header_size + header.length + trailer_size;
+        conn.in_offset += frame_size;
+        if (config_.checksum) {
+            uint32_t crc = Crc32c(Crc32c(0, payload, header.length), frame, header_size);
+            if (crc != wire::Load<4, ByteOrder::LITTLE>(payload + header.length)) {
+                Fail(conn);
+                return;
+            }
+        }
+        
+        // 回射保持顺序：应答必须与最早的在途请求一一对应；允许乱序的 WORK 应答可能先到，按 extra1 查找。
+        // UDP 报文可能丢失或乱序，同样按 extra1 查找；找不到的是已计为丢失的请求迟到的应答，忽略
+        auto it = conn.outstanding.begin();
+        if (config_.work_unordered || config_.udp) {
+            it = std::find_if(conn.outstanding.begin(), conn.outstanding.end(),
+                              [&header](const Request& request) { return request.seq == header.extra1; });
+        }
+        if (it == conn.outstanding.end()) {
+            if (config_.udp) {
+                continue;
+            }
+            Fail(conn);
+            return;
+        }
+        Request request = *it;
+        conn.outstanding.erase(it);
+        if (header.extra1 != request.seq || header.length != request.size ||
+            std::memcmp(payload, pattern_.data(), header.length) != 0) {
+            Fail(conn);
+            return;
+        }
+        
+        if (now >= warmup_end_ns) {
+            if (request.work) {
+                result_.work_latency.Record(now - request.start_ns);
+                result_.work_completed++;
+            } else {
+                result_.latency.Record(now - request.start_ns);
+            }
+            result_.completed++;
+            result_.bytes += header.length;
+            result_.wire_bytes += frame_size;
+        }
+        if (config_.rate <= 0) {
+            // 闭环：收到一个应答立即补发一个
+            Enqueue(conn, now);
+        }
+    }
+    
+    if (conn.in_offset == conn.in.size()) {
+        conn.in.clear();
+        conn.in_offset = 0;
+    } else if (conn.in_offset > kReadChunk) {
+        conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<std::ptrdiff_t>(conn.in_offset));
+        conn.in_offset = 0;
+    }
+}
+
+void Worker::ExpireDatagrams(Connection& conn, uint64_t now, uint64_t warmup_end_ns) {
+    // 在途队列按发送顺序排列，只需检查队首
+    size_t expired = 0;
+    while (!conn.outstanding.empty() && now - std::min(now, conn.outstanding.front().start_ns) >= kDatagramLossNs) {
+        if (conn.outstanding.front().start_ns >= warmup_end_ns) {
+            result_.lost++;
+        }
+        conn.outstanding.pop_front();
+        expired++;
+    }
+    if (expired > 0 && config_.rate <= 0) {
+        for (size_t i = 0; i < expired; i++) {
+            Enqueue(conn, now);
+        }
+        Flush(conn);
+    }
+}
+
+void Worker::Fail(Connection& conn) {
+    result_.errors++;
+    if (conn.ring) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.ring->doorbell_fd(), nullptr);
+        conn.ring.reset();
+    }
+    if (conn.fd >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+        close(conn.fd);
+        conn.fd = -1;
+    }
+    conn.outstanding.clear();
+}
+
+bool Worker::ArmRings() {
+    for (Connection& conn : connections_) {
+        if (!conn.ring) {
+            continue;
+        }
+        bool armed = conn.ring->ArmReadable();
+        if (armed && conn.out_offset < conn.out.size()) {
+            armed = conn.ring->ArmWritable();
+        }
+        if (!armed) {
+            DisarmRings();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Worker::DisarmRings() {
+    for (Connection& conn : connections_) {
+        if (conn.ring) {
+            conn.ring->Disarm();
+        }
+    }
+}
+
+void Worker::Run(uint64_t start_ns, uint64_t warmup_end_ns, uint64_t end_ns) {
+    bool open_loop = config_.rate > 0;
+    if (open_loop) {
+        double per_connection = config_.rate / static_cast<double>(config_.threads * config_.connections);
+        interval_ns_ = static_cast<uint64_t>(1e9 / per_connection);
+        // 各连接的首个发送时间错开，避免同时起跳
+        for (Connection& conn : connections_) {
+            conn.next_send_ns = start_ns + conn.rng() % std::max<uint64_t>(interval_ns_, 1);
+        }
+    } else {
+        for (Connection& conn : connections_) {
+            for (size_t i = 0; i < config_.pipeline; i++) {
+                Enqueue(conn, start_ns);
+            }
+            Flush(conn);
+        }
+    }
+    
+    std::vector<epoll_event> events(std::max<size_t>(2 * connections_.size(), 1));
+    uint64_t last_ring_ns = start_ns;
+    while (true) {
+        uint64_t now = NowNs();
+        if (now >= end_ns) {
+            break;
+        }
+        
+        uint64_t next_due = end_ns;
+        if (open_loop) {
+            for (Connection& conn : connections_) {
+                if (conn.fd < 0) {
+                    continue;
+                }
+                // 计划时间已到但在途请求已满时不补发，等应答腾出空位；
+                // 延迟仍从计划时间算起，排队时间不会被遗漏
+                while (conn.next_send_ns <= now && conn.outstanding.size() < config_.pipeline) {
+                    Enqueue(conn, conn.next_send_ns);
+                    conn.next_send_ns += interval_ns_;
+                }
+                Flush(conn);
+                if (conn.outstanding.size() < config_.pipeline) {
+                    next_due = std::min(next_due, conn.next_send_ns);
+                }
+            }
+        }
+        
+        // 亚毫秒的等待退化为忙轮询，保证开环发送时间的精度
+        int timeout = static_cast<int>(std::min<uint64_t>((next_due - std::min(next_due, now)) / 1000000, 100));
+        if (config_.shm) {
+            // 共享内存环：直接轮询每个连接，最近有收发时不进入 epoll_wait
+            uint64_t before = ring_bytes_;
+            for (Connection& conn : connections_) {
+                if (conn.ring) {
+                    ReadResponses(conn, warmup_end_ns);
+                    Flush(conn);
+                }
+            }
+            if (ring_bytes_ != before) {
+                last_ring_ns = now;
+                continue;
+            }
+            if (now - last_ring_ns < kRingSpinNs || !ArmRings()) {
+                if (ring_yield_) {
+                    sched_yield();
+                }
+                continue;
+            }
+        }
+        int n = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (config_.shm) {
+            DisarmRings();
+            for (int i = 0; i < n; i++) {
+                Connection& conn = connections_[events[i].data.u64 & ~kSocketEventTag];
+                if (events[i].data.u64 & kSocketEventTag) {
+                    // 协商之后服务端不再经 socket 发送，可读只可能是关闭
+                    Fail(conn);
+                } else if (conn.ring) {
+                    conn.ring->DrainDoorbell();
+                }
+            }
+            last_ring_ns = NowNs();
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            Connection& conn = connections_[events[i].data.u64];
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                ReadResponses(conn, warmup_end_ns);
+            }
+            Flush(conn);
+        }
+        if (config_.udp) {
+            now = NowNs();
+            for (Connection& conn : connections_) {
+                if (conn.fd >= 0) {
+                    ExpireDatagrams(conn, now, warmup_end_ns);
+                }
+            }
+        }
+    }
+    result_.measured_sec = static_cast<double>(end_ns - warmup_end_ns) / 1e9;
+}
+
+}  // namespace
+
+SizeDistribution::SizeDistribution() : spec_("64"), low_(64), high_(64), max_(64) {}
+
+bool SizeDistribution::Parse(const std::string& spec) {
+    sizes_.clear();
+    cumulative_.clear();
+    
+    if (spec.find(':') != std::string::npos) {
+        double total = 0;
+        size_t pos = 0;
+        while (pos < spec.size()) {
+            size_t comma = spec.find(',', pos);
+            std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t colon = item.find(':');
+            if (colon == std::string::npos) {
+                return false;
+            }
+            double weight = std::atof(item.c_str() + colon + 1);
+            if (weight <= 0) {
+                return false;
+            }
+            total += weight;
+            sizes_.push_back(static_cast<uint32_t>(std::strtoul(item.c_str(), nullptr, 10)));
+            cumulative_.push_back(total);
+            if (comma == std::string::npos) {
+                break;
+            }
+            pos = comma + 1;
+        }
+        if (sizes_.empty()) {
+            return false;
+        }
+        for (double& c : cumulative_) {
+            c /= total;
+        }
+        max_ = *std::max_element(sizes_.begin(), sizes_.end());
+    } else {
+        size_t dash = spec.find('-');
+        low_ = static_cast<uint32_t>(std::strtoul(spec.c_str(), nullptr, 10));
+        high_ = dash == std::string::npos ? low_ : static_cast<uint32_t>(std::strtoul(spec.c_str() + dash + 1, nullptr, 10));
+        if (high_ < low_) {
+            return false;
+        }
+        max_ = high_;
+    }
+    spec_ = spec;
+    return true;
+}
+
+uint32_t SizeDistribution::Sample(std::mt19937_64& rng) const {
+    if (!sizes_.empty()) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t i = static_cast<size_t>(std::lower_bound(cumulative_.begin(), cumulative_.end(), u) - cumulative_.begin());
+        return sizes_[std::min(i, sizes_.size() - 1)];
+    }
+    if (low_ == high_) {
+        return low_;
+    }
+    return std::uniform_int_distribution<uint32_t>(low_, high_)(rng);
+}
+
+bool RunLoad(const LoadConfig& config, LoadResult* result) {
+    if (config.udp && config.shm) {
+        std::cerr << "UDP and shared ring modes are exclusive" << std::endl;
+        return false;
+    }
+    if (config.udp) {
+        // 报文模式没有连接开头，无法协商；一帧必须装进服务端的接收槽位
+        if (config.checksum || config.wire_format->magic != 0) {
+            std::cerr << "UDP mode supports neither -k nor negotiated formats" << std::endl;
+            return false;
+        }
+        if (config.work_ratio > 0) {
+            std::cerr << "UDP mode does not support WORK requests" << std::endl;
+            return false;
+        }
+        if (config.wire_format->max_header_size + config.sizes.max() > UdpEpoller::kDefaultMaxDatagram) {
+            std::cerr << "UDP frames are limited to " << UdpEpoller::kDefaultMaxDatagram << " bytes" << std::endl;
+            return false;
+        }
+    }
+    
+    // 负载内容固定为可校验的字节序列
+    std::vector<uint8_t> pattern(config.sizes.max());
+    for (size_t i = 0; i < pattern.size(); i++) {
+        pattern[i] = static_cast<uint8_t>('a' + i % 26);
+    }
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (size_t i = 0; i < config.threads; i++) {
+        workers.push_back(std::make_unique<Worker>(config, i, pattern));
+        if (!workers.back()->Connect()) {
+            return false;
+        }
+    }
+    
+    // 所有连接建立后统一开始计时
+    uint64_t start_ns = NowNs();
+    uint64_t warmup_end_ns = start_ns + static_cast<uint64_t>(config.warmup_sec * 1e9);
+    uint64_t end_ns = warmup_end_ns + static_cast<uint64_t>(config.duration_sec * 1e9);
+    
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker, start_ns, warmup_end_ns, end_ns] { worker->Run(start_ns, warmup_end_ns, end_ns); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    *result = LoadResult{};
+    for (auto& worker : workers) {
+        const LoadResult& part = worker->result();
+        result->latency.Merge(part.latency);
+        result->work_latency.Merge(part.work_latency);
+        result->work_completed += part.work_completed;
+        result->completed += part.completed;
+        result->bytes += part.bytes;
+        result->wire_bytes += part.wire_bytes;
+        result->errors += part.errors;
+        result->lost += part.lost;
+        result->measured_sec = part.measured_sec;
+    }
+    return true;
+}
+
+void PrintLoadResult(const LoadConfig& config, const LoadResult& result) {
+    double seconds = result.measured_sec > 0 ? result.measured_sec : 1;
+    double throughput = static_cast<double>(result.completed) / seconds;
+    double mbps = static_cast<double>(result.bytes) / seconds / (1 << 20);
+    double wire_mbps = static_cast<double>(result.wire_bytes) / seconds / (1 << 20);
+    const LatencyHistogram& latency = result.latency;
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    
+    char line[1024];
+    if (config.json) {
+        snprintf(line, sizeof(line),
+                 "{\"mode\":\"%s\",\"transport\":\"%s\",\"format\":\"%s\",\"checksum\":%s,\"threads\":%zu,\"connections\":%zu,\"pipeline\":%zu,\"sizes\":\"%s\","
+                 "\"rate\":%.0f,\"duration_s\":%.3f,\"warmup_s\":%.3f,\"seed\":%llu,"
+                 "\"requests\":%llu,\"errors\":%llu,\"lost\":%llu,\"throughput_rps\":%.1f,\"throughput_mib_s\":%.3f,\"wire_mib_s\":%.3f,"
+                 "\"latency_us\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f,\"mean\":%.1f}",
+                 config.rate > 0 ? "open" : "closed", config.udp ? "udp" : (config.shm ? "shm" : "stream"), config.wire_format->name, config.checksum ? "true" : "false", config.threads,
+                 config.threads * config.connections, config.pipeline, config.sizes.spec().c_str(), config.rate, seconds,
+                 config.warmup_sec, static_cast<unsigned long long>(config.seed),
+                 static_cast<unsigned long long>(result.completed), static_cast<unsigned long long>(result.errors),
+                 static_cast<unsigned long long>(result.lost), throughput, mbps, wire_mbps, us(latency.Percentile(0.5)),
+                 us(latency.Percentile(0.9)), us(latency.Percentile(0.99)), us(latency.Percentile(0.999)),
+                 us(latency.max()), latency.mean() / 1000.0);
+        std::cout << line;
+        if (config.work_ratio > 0) {
+            const LatencyHistogram& work = result.work_latency;
+            snprintf(line, sizeof(line),
+                     ",\"work\":{\"us\":%u,\"ratio\":%g,\"unordered\":%s,\"requests\":%llu,"
+                     "\"latency_us\":{\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f}}",
+                     config.work_us, config.work_ratio, config.work_unordered ? "true" : "false",
+                     static_cast<unsigned long long>(result.work_completed), us(work.Percentile(0.5)),
+                     us(work.Percentile(0.99)), us(work.max()));
+            std::cout << line;
+        }
+        std::cout << "}" << std::endl;
+        return;
+    }
+    
+    snprintf(line, sizeof(line),
+             "mode=%s transport=%s format=%s checksum=%s threads=%zu connections=%zu pipeline=%zu sizes=%s rate=%.0f duration=%.1fs warmup=%.1fs\n"
+             "requests=%llu errors=%llu lost=%llu throughput=%.1f req/s (%.2f MiB/s payload, %.2f MiB/s on wire)\n"
+             "latency(us): p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f mean=%.1f",
+             config.rate > 0 ? "open" : "closed", config.udp ? "udp" : (config.shm ? "shm" : "stream"), config.wire_format->name, config.checksum ? "on" : "off", config.threads,
+             config.threads * config.connections, config.pipeline, config.sizes.spec().c_str(), config.rate, seconds,
+             config.warmup_sec, static_cast<unsigned long long>(result.completed),
+             static_cast<unsigned long long>(result.errors), static_cast<unsigned long long>(result.lost), throughput, mbps, wire_mbps, us(latency.Percentile(0.5)), us(latency.Percentile(0.9)), us(latency.Percentile(0.99)),
+             us(latency.Percentile(0.999)), us(latency.max()), latency.mean() / 1000.0);
+    std::cout << line << std::endl;
+    // 上面的延迟只含普通回射请求
+    if (config.work_ratio > 0) {
+        const LatencyHistogram& work = result.work_latency;
+        snprintf(line, sizeof(line), "work(us): cost=%u ratio=%g order=%s requests=%llu p50=%.1f p99=%.1f max=%.1f",
+                 config.work_us, config.work_ratio, config.work_unordered ? "unordered" : "in-order",
+                 static_cast<unsigned long long>(result.work_completed), us(work.Percentile(0.5)),
+                 us(work.Percentile(0.99)), us(work.max()));
+        std::cout << line << std::endl;
+    }
+}
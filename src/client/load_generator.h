@@ -0,0 +1,81 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include "../include/common/wire_codec.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// 负载大小分布：固定值 "64"、均匀区间 "64-4096"，或加权离散 "64:90,1024:9,65536:1"
+class SizeDistribution {
+public:
+    SizeDistribution();
+    
+    bool Parse(const std::string& spec);
+    uint32_t Sample(std::mt19937_64& rng) const;
+    uint32_t max() const { return max_; }
+    const std::string& spec() const { return spec_; }
+
+private:
+    std::string spec_;
+    // 均匀区间 [low_, high_]；sizes_ 非空时为加权离散分布
+    uint32_t low_;
+    uint32_t high_;
+    std::vector<uint32_t> sizes_;
+    std::vector<double> cumulative_;
+    uint32_t max_;
+};
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 8888;
+    size_t threads = 1;
+    // 每个线程的连接数
+    size_t connections = 1;
+    // 每个连接最多在途的请求数
+    size_t pipeline = 1;
+    SizeDistribution sizes;
+    // 总请求速率（次/秒）；0 表示闭环：每收到一个应答立即补发一个
+    double rate = 0;
+    double duration_sec = 10;
+    double warmup_sec = 2;
+    uint64_t seed = 1;
+    bool json = false;
+    // 包头线上格式，须与服务端一致
+    const WireFormat* wire_format = &WireFormat::Native();
+    // 每帧附带 CRC32C 校验尾部（连接开头发送 kChecksumMagic 协商），应答的尾部不符计为错误
+    bool checksum = false;
+    // 使用 UDP：每个请求一个报文，不做首字节协商；应答可能乱序，按 extra1 匹配。
+    // 不重传：超过 1 秒未收到应答的请求计为丢失，并让出在途名额
+    bool udp = false;
+    // 经 Unix 域 socket 协商改用共享内存环（host 为 unix:...），收发时忙轮询，空闲后才在门铃上休眠
+    bool shm = false;
+    // 按 work_ratio 的比例发送 WORK 请求，服务端为每个占用 work_us 微秒 CPU；其延迟单独统计，latency 只含普通回射
+    uint32_t work_us = 0;
+    double work_ratio = 0;
+    // WORK 请求带 kWorkUnordered，允许应答先于更早的请求返回，按 extra1 匹配在途请求
+    bool work_unordered = false;
+};
+
+struct LoadResult {
+    LatencyHistogram latency;
+    // 统计窗口（预热之后）内完成的请求与回射字节
+    uint64_t completed = 0;
+    uint64_t bytes = 0;
+    // 同一窗口内收到的线上字节数（含包头与校验尾部），衡量帧格式的开销
+    uint64_t wire_bytes = 0;
+    // 应答内容/顺序/校验不符或连接错误
+    uint64_t errors = 0;
+    // UDP 模式下统计窗口内超时未收到应答的请求
+    uint64_t lost = 0;
+    double measured_sec = 0;
+    // WORK 请求的延迟与完成数（已计入 completed）
+    LatencyHistogram work_latency;
+    uint64_t work_completed = 0;
+};
+
+// 按配置运行压测并汇总各线程结果；连接失败时返回 false
+bool RunLoad(const LoadConfig& config, LoadResult* result);
+// 输出结果：默认可读文本，json 为单行 JSON
+void PrintLoadResult(const LoadConfig& config, const LoadResult& result);
@@ -0,0 +1,77 @@
+#include "../include/common/buffer.h"
+
+Buffer::Buffer() : block_(nullptr), read_index_(0), write_index_(0) {}
+
+Buffer::~Buffer() {
+    if (block_) {
+        block_->Unref();
+    }
+}
+
+void Buffer::Retrieve(size_t n) {
+    if (n >= ReadableBytes()) {
+        RetrieveAll();
+        return;
+    }
+    read_index_ += n;
+}
+
+void Buffer::RetrieveAll() {
+    // 存储仍被切片引用时不能从头覆盖，下次写入换用新块
+    if (block_ && !block_->unique()) {
+        block_->Unref();
+        block_ = nullptr;
+    }
+    read_index_ = 0;
+    write_index_ = 0;
+}
+
+Data Buffer::Take(size_t n) {
+    if (n == 0) {
+        return Data();
+    }
+    if (n > ReadableBytes()) {
+        n = ReadableBytes();
+    }
+    Data data(block_, read_index_, n);
+    Retrieve(n);
+    return data;
+}
+
+void Buffer::Append(const void* data, size_t n) {
+    EnsureWritable(n);
+    std::memcpy(BeginWrite(), data, n);
+    HasWritten(n);
+}
+
+void Buffer::EnsureWritable(size_t n) {
+    if (WritableBytes() >= n) {
+        return;
+    }
+    
+    size_t readable = ReadableBytes();
+    if (block_ && block_->unique() && read_index_ + WritableBytes() >= n) {
+        // 已消费区域足够且无人引用，把可读数据搬到头部
+        std::memmove(block_->bytes(), block_->bytes() + read_index_, readable);
+    } else {
+        DataBlock* grown = DataBlock::Create(readable + n);
+        if (readable > 0) {
+            std::memcpy(grown->bytes(), block_->bytes() + read_index_, readable);
+        }
+        if (block_) {
+            block_->Unref();
+        }
+        block_ = grown;
+    }
+    read_index_ = 0;
+    write_index_ = readable;
+}
+
+void Buffer::ReleaseIfEmpty() {
+    if (block_ && ReadableBytes() == 0) {
+        block_->Unref();
+        block_ = nullptr;
+        read_index_ = 0;
+        write_index_ = 0;
+    }
+}
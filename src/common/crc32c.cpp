@@ -0,0 +1,247 @@
+#include "../include/common/crc32c.h"
+#include <array>
+#include <bit>
+#include <cstring>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace {
+
+// 反射形式的 Castagnoli 多项式
+constexpr uint32_t kPoly = 0x82F63B78;
+
+using ByteTable = std::array<uint32_t, 256>;
+
+// slice-by-8 查表：kTables[k][b] 为字节 b 之后再跟 k 个零字节时寄存器的变化
+constexpr std::array<ByteTable, 8> MakeTables() {
+    std::array<ByteTable, 8> tables{};
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (kPoly & (0u - (crc & 1)));
+        }
+        tables[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = tables[0][n];
+        for (size_t k = 1; k < 8; k++) {
+            crc = tables[0][crc & 0xFF] ^ (crc >> 8);
+            tables[k][n] = crc;
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<ByteTable, 8> kTables = MakeTables();
+
+// 寄存器后接若干零字节是 GF(2) 上的线性变换，用 32 列的矩阵表示；
+// 三路交错计算后用它把前一路的结果移到后一路之后再合并
+using Matrix = std::array<uint32_t, 32>;
+
+constexpr uint32_t MatrixTimes(const Matrix& matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (size_t i = 0; vector != 0; i++, vector >>= 1) {
+        sum ^= matrix[i] & (0u - (vector & 1));
+    }
+    return sum;
+}
+
+constexpr Matrix MatrixSquare(const Matrix& matrix) {
+    Matrix square{};
+    for (size_t i = 0; i < 32; i++) {
+        square[i] = MatrixTimes(matrix, matrix[i]);
+    }
+    return square;
+}
+
+// length（2 的幂）个零字节对应的变换，按字节拆成 4 张表，运行时 4 次查表完成一次移位
+constexpr std::array<ByteTable, 4> MakeShiftTables(size_t length) {
+    Matrix op{};
+    op[0] = kPoly;
+    for (size_t i = 1; i < 32; i++) {
+        op[i] = uint32_t(1) << (i - 1);
+    }
+    // 一个零位平方三次得到一个零字节，之后每次平方长度翻倍
+    for (int i = 0; i < 3; i++) {
+        op = MatrixSquare(op);
+    }
+    for (; length > 1; length >>= 1) {
+        op = MatrixSquare(op);
+    }
+    std::array<ByteTable, 4> tables{};
+    for (uint32_t n = 0; n < 256; n++) {
+        for (size_t k = 0; k < 4; k++) {
+            tables[k][n] = MatrixTimes(op, n << (8 * k));
+        }
+    }
+    return tables;
+}
+
+// 三路交错的块长：大负载用长块摊薄合并开销，剩余部分用短块
+constexpr size_t kLongBlock = 8192;
+constexpr size_t kShortBlock = 256;
+
+[[maybe_unused]] constexpr std::array<ByteTable, 4> kLongShift = MakeShiftTables(kLongBlock);
+[[maybe_unused]] constexpr std::array<ByteTable, 4> kShortShift = MakeShiftTables(kShortBlock);
+
+[[maybe_unused]] inline uint32_t Shift(const std::array<ByteTable, 4>& tables, uint32_t crc) {
+    return tables[0][crc & 0xFF] ^ tables[1][(crc >> 8) & 0xFF] ^ tables[2][(crc >> 16) & 0xFF] ^ tables[3][crc >> 24];
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) inline uint64_t Sse42Word(uint64_t crc, const uint8_t* in) {
+    uint64_t word;
+    std::memcpy(&word, in, sizeof(word));
+    return _mm_crc32_u64(crc, word);
+}
+
+// 三条独立依赖链各算 block 字节：crc32 指令延迟 3 周期、吞吐每周期 1 条，单链只能用到三分之一
+__attribute__((target("sse4.2"))) inline uint64_t Sse42Triple(uint64_t crc0, const uint8_t* in, size_t block,
+                                                             const std::array<ByteTable, 4>& shift) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    const uint8_t* end = in + block;
+    do {
+        crc0 = Sse42Word(crc0, in);
+        crc1 = Sse42Word(crc1, in + block);
+        crc2 = Sse42Word(crc2, in + 2 * block);
+        in += 8;
+    } while (in < end);
+    crc0 = Shift(shift, static_cast<uint32_t>(crc0)) ^ crc1;
+    return Shift(shift, static_cast<uint32_t>(crc0)) ^ crc2;
+}
+
+__attribute__((target("sse4.2"))) uint32_t Crc32cSse42(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    uint64_t crc0 = ~crc;
+    while (length >= 3 * kLongBlock) {
+        crc0 = Sse42Triple(crc0, in, kLongBlock, kLongShift);
+        in += 3 * kLongBlock;
+        length -= 3 * kLongBlock;
+    }
+    while (length >= 3 * kShortBlock) {
+        crc0 = Sse42Triple(crc0, in, kShortBlock, kShortShift);
+        in += 3 * kShortBlock;
+        length -= 3 * kShortBlock;
+    }
+    while (length >= 8) {
+        crc0 = Sse42Word(crc0, in);
+        in += 8;
+        length -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc0);
+    while (length > 0) {
+        crc32 = _mm_crc32_u8(crc32, *in++);
+        length--;
+    }
+    return ~crc32;
+}
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crc"))) inline uint32_t ArmWord(uint32_t crc, const uint8_t* in) {
+    uint64_t word;
+    std::memcpy(&word, in, sizeof(word));
+    return __crc32cd(crc, word);
+}
+
+__attribute__((target("+crc"))) inline uint32_t ArmTriple(uint32_t crc0, const uint8_t* in, size_t block,
+                                                          const std::array<ByteTable, 4>& shift) {
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    const uint8_t* end = in + block;
+    do {
+        crc0 = ArmWord(crc0, in);
+        crc1 = ArmWord(crc1, in + block);
+        crc2 = ArmWord(crc2, in + 2 * block);
+        in += 8;
+    } while (in < end);
+    crc0 = Shift(shift, crc0) ^ crc1;
+    return Shift(shift, crc0) ^ crc2;
+}
+
+__attribute__((target("+crc"))) uint32_t Crc32cArm(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    uint32_t crc0 = ~crc;
+    while (length >= 3 * kLongBlock) {
+        crc0 = ArmTriple(crc0, in, kLongBlock, kLongShift);
+        in += 3 * kLongBlock;
+        length -= 3 * kLongBlock;
+    }
+    while (length >= 3 * kShortBlock) {
+        crc0 = ArmTriple(crc0, in, kShortBlock, kShortShift);
+        in += 3 * kShortBlock;
+        length -= 3 * kShortBlock;
+    }
+    while (length >= 8) {
+        crc0 = ArmWord(crc0, in);
+        in += 8;
+        length -= 8;
+    }
+    while (length > 0) {
+        crc0 = __crc32cb(crc0, *in++);
+        length--;
+    }
+    return ~crc0;
+}
+
+#endif
+
+struct Implementation {
+    const char* name;
+    uint32_t (*function)(uint32_t crc, const void* data, size_t length);
+};
+
+Implementation SelectImplementation() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return {"sse4.2", &Crc32cSse42};
+    }
+#elif defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        return {"armv8-crc", &Crc32cArm};
+    }
+#endif
+    return {"table", &Crc32cPortable};
+}
+
+const Implementation g_implementation = SelectImplementation();
+
+}  // namespace
+
+uint32_t Crc32c(uint32_t crc, const void* data, size_t length) {
+    return g_implementation.function(crc, data, length);
+}
+
+uint32_t Crc32cPortable(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    if constexpr (std::endian::native == std::endian::little) {
+        while (length >= 8) {
+            uint64_t word;
+            std::memcpy(&word, in, sizeof(word));
+            word ^= crc;
+            crc = kTables[7][word & 0xFF] ^ kTables[6][(word >> 8) & 0xFF] ^ kTables[5][(word >> 16) & 0xFF] ^
+                  kTables[4][(word >> 24) & 0xFF] ^ kTables[3][(word >> 32) & 0xFF] ^ kTables[2][(word >> 40) & 0xFF] ^
+                  kTables[1][(word >> 48) & 0xFF] ^ kTables[0][word >> 56];
+            in += 8;
+            length -= 8;
+        }
+    }
+    while (length > 0) {
+        crc = kTables[0][(crc ^ *in++) & 0xFF] ^ (crc >> 8);
+        length--;
+    }
+    return ~crc;
+}
+
+const char* Crc32cImplementation() {
+    return g_implementation.name;
+}
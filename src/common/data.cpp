@@ -1,23 +1,45 @@
 #include "../include/common/data.h"
+#include <utility>
 
-Data::Data() : data_(nullptr), length_(0) {}
+Data::Data() : block_(nullptr), offset_(0), length_(0) {}
 
-Data::Data(size_t length) : data_(std::make_unique<uint8_t[]>(length)), length_(length) {}
+Data::Data(size_t length)
+    : block_(length > 0 ? DataBlock::Create(length) : nullptr), offset_(0), length_(length) {}
 
 Data::Data(const void* ptr, size_t length) : Data(length) {
     if (ptr && length > 0) {
-        std::memcpy(data_.get(), ptr, length);
+        std::memcpy(block_->bytes(), ptr, length);
     }
 }
 
-Data::Data(const Data& other) : Data(other.data_.get(), other.length_) {}
+Data::Data(DataBlock* block, size_t offset, size_t length)
+    : block_(block), offset_(offset), length_(length) {
+    if (block_) {
+        block_->Ref();
+    }
+}
+
+Data::Data(const Data& other) : Data(other.block_, other.offset_, other.length_) {}
 
 Data::Data(Data&& other) noexcept 
-    : data_(std::move(other.data_)), length_(other.length_) {
+    : block_(other.block_), offset_(other.offset_), length_(other.length_) {
+    other.block_ = nullptr;
+    other.offset_ = 0;
     other.length_ = 0;
 }
 
-Data::~Data() = default;
+Data::~Data() {
+    Reset();
+}
+
+void Data::Reset() {
+    if (block_) {
+        block_->Unref();
+        block_ = nullptr;
+    }
+    offset_ = 0;
+    length_ = 0;
+}
 
 Data& Data::operator=(const Data& other) {
     if (this != &other) {
@@ -28,10 +50,24 @@ Data& Data::operator=(const Data& other) {
 
 Data& Data::operator=(Data&& other) noexcept {
     if (this != &other) {
-        data_ = std::move(other.data_);
-        length_ = other.length_;
-        other.length_ = 0;
+        Reset();
+        block_ = std::exchange(other.block_, nullptr);
+        offset_ = std::exchange(other.offset_, 0);
+        length_ = std::exchange(other.length_, 0);
     }
     return *this;
 }
 
+Data Data::Clone() const {
+    return Data(ptr(), length_);
+}
+
+Data Data::Slice(size_t offset, size_t length) const {
+    if (offset >= length_) {
+        return Data();
+    }
+    if (length > length_ - offset) {
+        length = length_ - offset;
+    }
+    return Data(block_, offset_ + offset, length);
+}
@@ -0,0 +1,20 @@
+#include "../include/common/data_block.h"
+#include "../include/common/slab_allocator.h"
+#include <new>
+
+static_assert(sizeof(DataBlock) <= SlabAllocator::kSlotHeader, "DataBlock header must fit in a slab slot header");
+
+DataBlock* DataBlock::Create(size_t capacity) {
+    // 实际容量向上取整到 size class，多出的空间对 Buffer 同样可用
+    size_t class_capacity = 0;
+    void* memory = SlabAllocator::Allocate(capacity, &class_capacity);
+    return new (memory) DataBlock(class_capacity);
+}
+
+void DataBlock::Unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        size_t capacity = capacity_;
+        this->~DataBlock();
+        SlabAllocator::Deallocate(this, capacity);
+    }
+}
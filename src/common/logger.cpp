@@ -0,0 +1,370 @@
+#include "../include/common/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kRecordText = 240;
+
+struct LogRecord {
+    int64_t time_ns;
+    uint32_t tid;
+    uint16_t length;
+    uint8_t level;
+    char text[kRecordText];
+};
+
+// 单生产者（所属线程）单消费者（写线程）环形缓冲区
+class LogRing {
+public:
+    explicit LogRing(size_t slots) : slots_(slots), mask_(slots - 1), records_(new LogRecord[slots]) {}
+    
+    bool Push(LogLevel level, const char* text, size_t length, uint32_t tid, int64_t time_ns) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= slots_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        LogRecord& record = records_[tail & mask_];
+        record.time_ns = time_ns;
+        record.tid = tid;
+        record.level = static_cast<uint8_t>(level);
+        record.length = static_cast<uint16_t>(std::min(length, kRecordText));
+        std::memcpy(record.text, text, record.length);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    template <typename Fn>
+    size_t Drain(Fn&& fn) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        for (uint64_t i = head; i != tail; i++) {
+            fn(records_[i & mask_]);
+        }
+        head_.store(tail, std::memory_order_release);
+        return static_cast<size_t>(tail - head);
+    }
+    
+    bool Empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    uint64_t TakeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+    
+    // 所属线程退出后置位，写线程排空后回收
+    std::atomic<bool> abandoned{false};
+
+private:
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    size_t slots_;
+    size_t mask_;
+    std::unique_ptr<LogRecord[]> records_;
+};
+
+struct LoggerState {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<LogRing>> rings;
+    std::condition_variable cond;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    bool stop = false;
+    FILE* out = nullptr;
+    size_t ring_slots = 4096;
+    std::atomic<uint64_t> dropped{0};
+};
+
+LoggerState& GetState() {
+    static LoggerState state;
+    return state;
+}
+
+const char* LevelName(int level) {
+    static const char* const kNames[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR"};
+    return level >= 0 && level < 5 ? kNames[level] : "?    ";
+}
+
+int64_t NowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint32_t CurrentTid() {
+    static thread_local uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+// 线程退出时把环标记为可回收，已写入的记录仍会被写线程取出
+struct RingHolder {
+    std::shared_ptr<LogRing> ring;
+    
+    ~RingHolder() {
+        if (ring) {
+            ring->abandoned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+LogRing* ThreadRing() {
+    static thread_local RingHolder holder;
+    if (!holder.ring) {
+        LoggerState& state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        holder.ring = std::make_shared<LogRing>(state.ring_slots);
+        state.rings.push_back(holder.ring);
+    }
+    return holder.ring.get();
+}
+
+// 按秒缓存时间前缀，避免每条记录都调用 localtime_r
+class TimeFormatter {
+public:
+    size_t Format(int64_t time_ns, char* out) {
+        time_t seconds = static_cast<time_t>(time_ns / 1000000000);
+        if (seconds != cached_seconds_) {
+            tm local;
+            localtime_r(&seconds, &local);
+            strftime(cached_, sizeof(cached_), "%Y-%m-%d %H:%M:%S", &local);
+            cached_seconds_ = seconds;
+        }
+        int n = snprintf(out, 32, "%s.%06d", cached_, static_cast<int>((time_ns % 1000000000) / 1000));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+private:
+    time_t cached_seconds_ = -1;
+    char cached_[24] = {};
+};
+
+void AppendRecord(std::string* out, TimeFormatter* formatter, int64_t time_ns, uint32_t tid, int level,
+                  const char* text, size_t length) {
+    char prefix[96];
+    size_t n = formatter->Format(time_ns, prefix);
+    int m = snprintf(prefix + n, sizeof(prefix) - n, " %s [%u] ", LevelName(level), tid);
+    if (m > 0) {
+        n += static_cast<size_t>(m);
+    }
+    out->append(prefix, n);
+    out->append(text, length);
+    out->push_back('\n');
+}
+
+void WriterLoop() {
+    LoggerState& state = GetState();
+    TimeFormatter formatter;
+    std::string out;
+    out.reserve(1 << 16);
+    
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (true) {
+        bool stopping = state.stop;
+        uint64_t dropped = 0;
+        for (auto& ring : state.rings) {
+            ring->Drain([&](const LogRecord& record) {
+                AppendRecord(&out, &formatter, record.time_ns, record.tid, record.level, record.text, record.length);
+            });
+            dropped += ring->TakeDropped();
+        }
+        // 回收已退出线程的空环
+        state.rings.erase(std::remove_if(state.rings.begin(), state.rings.end(),
+                                         [](const std::shared_ptr<LogRing>& ring) {
+                                             return ring->abandoned.load(std::memory_order_acquire) && ring->Empty();
+                                         }),
+                          state.rings.end());
+        
+        if (dropped > 0) {
+            state.dropped.fetch_add(dropped, std::memory_order_relaxed);
+            std::string note = "log ring full, dropped " + std::to_string(dropped) + " records";
+            AppendRecord(&out, &formatter, NowNs(), CurrentTid(), static_cast<int>(LogLevel::WARN), note.data(),
+                         note.size());
+        }
+        
+        if (!out.empty()) {
+            // 写文件时不持锁，注册新线程的环不被阻塞
+            lock.unlock();
+            fwrite(out.data(), 1, out.size(), state.out);
+            fflush(state.out);
+            out.clear();
+            lock.lock();
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        // 生产者不做通知以保持无锁，这里按固定间隔轮询
+        state.cond.wait_for(lock, std::chrono::milliseconds(5));
+    }
+}
+
+}  // namespace
+
+bool Logger::Start(const LogConfig& config) {
+    LoggerState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.running.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    FILE* out = stderr;
+    if (!config.file.empty()) {
+        out = fopen(config.file.c_str(), "a");
+        if (!out) {
+            fprintf(stderr, "Failed to open log file %s: %s\n", config.file.c_str(), strerror(errno));
+            return false;
+        }
+    }
+    
+    size_t slots = 1;
+    while (slots < config.ring_slots) {
+        slots <<= 1;
+    }
+    state.ring_slots = slots;
+    state.out = out;
+    state.stop = false;
+    SetLevel(config.level);
+    state.writer = std::thread(WriterLoop);
+    state.running.store(true, std::memory_order_release);
+    return true;
+}
+
+void Logger::Stop() {
+    LoggerState& state = GetState();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.running.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // 之后的日志改为同步写 stderr
+        state.running.store(false, std::memory_order_release);
+        state.stop = true;
+    }
+    state.cond.notify_one();
+    state.writer.join();
+    
+    if (state.out && state.out != stderr) {
+        fclose(state.out);
+    }
+    state.out = nullptr;
+}
+
+void Logger::SetLevel(LogLevel level) {
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::GetLevel() {
+    return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+}
+
+void Logger::Write(LogLevel level, const char* text, size_t length) {
+    LoggerState& state = GetState();
+    int64_t now = NowNs();
+    if (state.running.load(std::memory_order_acquire)) {
+        ThreadRing()->Push(level, text, length, CurrentTid(), now);
+        return;
+    }
+    
+    // 未启动：同步写 stderr，单行一次 fwrite 保证行不交错
+    static thread_local TimeFormatter formatter;
+    std::string line;
+    AppendRecord(&line, &formatter, now, CurrentTid(), static_cast<int>(level), text, length);
+    fwrite(line.data(), 1, line.size(), stderr);
+}
+
+uint64_t Logger::Dropped() {
+    return GetState().dropped.load(std::memory_order_relaxed);
+}
+
+bool Logger::ParseLevel(const char* name, LogLevel* level) {
+    static const struct {
+        const char* name;
+        LogLevel level;
+    } kLevels[] = {
+        {"trace", LogLevel::TRACE}, {"debug", LogLevel::DEBUG}, {"info", LogLevel::INFO},
+        {"warn", LogLevel::WARN},   {"error", LogLevel::ERROR}, {"off", LogLevel::OFF},
+    };
+    for (const auto& entry : kLevels) {
+        if (strcmp(name, entry.name) == 0) {
+            *level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+LogLine::LogLine(LogLevel level, const char* file, int line, uint32_t suppressed)
+    : level_(level), suppressed_(suppressed), length_(0) {
+    *this << file << ':' << line << ' ';
+}
+
+LogLine::~LogLine() {
+    if (suppressed_ > 0) {
+        *this << " (suppressed " << suppressed_ << " similar)";
+    }
+    Logger::Write(level_, buf_, length_);
+}
+
+LogLine& LogLine::operator<<(std::string_view text) {
+    size_t n = std::min(text.size(), kMaxLength - length_);
+    std::memcpy(buf_ + length_, text.data(), n);
+    length_ += n;
+    return *this;
+}
+
+LogLine& LogLine::operator<<(char c) {
+    if (length_ < kMaxLength) {
+        buf_[length_++] = c;
+    }
+    return *this;
+}
+
+LogLine& LogLine::operator<<(double value) {
+    auto result = std::to_chars(buf_ + length_, buf_ + kMaxLength, value, std::chars_format::fixed, 3);
+    if (result.ec == std::errc()) {
+        length_ = static_cast<size_t>(result.ptr - buf_);
+    }
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const void* ptr) {
+    return *this << "0x" << LogHex(reinterpret_cast<uintptr_t>(ptr));
+}
+
+LogLine& LogLine::operator<<(LogHex hex) {
+    auto result = std::to_chars(buf_ + length_, buf_ + kMaxLength, hex.value, 16);
+    if (result.ec == std::errc()) {
+        length_ = static_cast<size_t>(result.ptr - buf_);
+    }
+    return *this;
+}
+
+bool LogRateLimiter::Allow(uint32_t per_second) {
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    if (now_ms - window_start_ms_ >= 1000) {
+        window_start_ms_ = now_ms;
+        count_ = 0;
+    }
+    if (count_ >= per_second) {
+        suppressed_++;
+        return false;
+    }
+    count_++;
+    return true;
+}
+
+uint32_t LogRateLimiter::TakeSuppressed() {
+    uint32_t suppressed = suppressed_;
+    suppressed_ = 0;
+    return suppressed;
+}
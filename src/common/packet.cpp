@@ -1,25 +1,28 @@
 #include "../include/common/packet.h"
 
-Packet::Packet() : header_(), data_() {}
+Packet::Packet() : header_(), payload_crc_(0), data_(), received_ns_(0), has_payload_crc_(false) {}
 
 Packet::Packet(const PacketHeader& header, const Data& data) 
-    : header_(header), data_(data) {}
+    : header_(header), payload_crc_(0), data_(data), received_ns_(0), has_payload_crc_(false) {}
 
 Packet::Packet(const PacketHeader& header, Data&& data) 
-    : header_(header), data_(std::move(data)) {}
+    : header_(header), payload_crc_(0), data_(std::move(data)), received_ns_(0), has_payload_crc_(false) {}
 
 Packet::Packet(const Packet& other) 
-    : header_(other.header_), data_(other.data_) {}
+    : header_(other.header_), payload_crc_(other.payload_crc_), data_(other.data_), received_ns_(other.received_ns_), has_payload_crc_(other.has_payload_crc_) {}
 
 Packet::Packet(Packet&& other) noexcept 
-    : header_(other.header_), data_(std::move(other.data_)) {}
+    : header_(other.header_), payload_crc_(other.payload_crc_), data_(std::move(other.data_)), received_ns_(other.received_ns_), has_payload_crc_(other.has_payload_crc_) {}
 
 Packet::~Packet() = default;
 
 Packet& Packet::operator=(const Packet& other) {
     if (this != &other) {
         header_ = other.header_;
+        payload_crc_ = other.payload_crc_;
         data_ = other.data_;
+        received_ns_ = other.received_ns_;
+        has_payload_crc_ = other.has_payload_crc_;
     }
     return *this;
 }
@@ -27,15 +30,29 @@ Packet& Packet::operator=(const Packet& other) {
 Packet& Packet::operator=(Packet&& other) noexcept {
     if (this != &other) {
         header_ = other.header_;
+        payload_crc_ = other.payload_crc_;
         data_ = std::move(other.data_);
+        received_ns_ = other.received_ns_;
+        has_payload_crc_ = other.has_payload_crc_;
     }
     return *this;
 }
 
+Packet Packet::Clone() const {
+    Packet copy(header_, data_.Clone());
+    copy.received_ns_ = received_ns_;
+    copy.payload_crc_ = payload_crc_;
+    copy.has_payload_crc_ = has_payload_crc_;
+    return copy;
+}
+
 Packet Packet::Ack() const {
     PacketHeader ack_header = header_;
     ack_header.command = static_cast<uint32_t>(PacketHeaderCommand::ACK);
-    return Packet(ack_header, data_);
+    Packet ack(ack_header, data_);
+    ack.payload_crc_ = payload_crc_;
+    ack.has_payload_crc_ = has_payload_crc_;
+    return ack;
 }
 
 void Packet::Send() {
@@ -0,0 +1,177 @@
+#include "../include/common/slab_allocator.h"
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxClasses = 32;
+
+SlabConfig g_config;
+
+size_t ClassIndex(size_t capacity) {
+    if (capacity <= g_config.min_class_size) {
+        return 0;
+    }
+    return std::bit_width(capacity - 1) - std::bit_width(g_config.min_class_size - 1);
+}
+
+size_t ClassCapacity(size_t index) {
+    return g_config.min_class_size << index;
+}
+
+// 单写者计数器：只由所属线程更新，其他线程读取时用 relaxed load 聚合
+struct Counter {
+    std::atomic<uint64_t> value{0};
+    
+    void Add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void Sub(uint64_t n) { value.store(value.load(std::memory_order_relaxed) - n, std::memory_order_relaxed); }
+    uint64_t Load() const { return value.load(std::memory_order_relaxed); }
+};
+
+struct FreeSlot {
+    FreeSlot* next;
+};
+
+class ThreadCache;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCache*> caches;
+    SlabStats retired;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+class ThreadCache {
+public:
+    ThreadCache() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.caches.push_back(this);
+    }
+    
+    ~ThreadCache() {
+        for (size_t i = 0; i < kMaxClasses; i++) {
+            while (free_[i]) {
+                FreeSlot* slot = free_[i];
+                free_[i] = slot->next;
+                ::operator delete(slot);
+            }
+        }
+        
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired.hits += hits.Load();
+        registry.retired.misses += misses.Load();
+        registry.retired.oversized += oversized.Load();
+        registry.retired.releases += releases.Load();
+        for (size_t i = 0; i < registry.caches.size(); i++) {
+            if (registry.caches[i] == this) {
+                registry.caches.erase(registry.caches.begin() + i);
+                break;
+            }
+        }
+    }
+    
+    void* Allocate(size_t index) {
+        FreeSlot* slot = free_[index];
+        if (slot) {
+            free_[index] = slot->next;
+            count_[index]--;
+            cached_bytes_ -= ClassCapacity(index);
+            bytes_pooled.Sub(ClassCapacity(index));
+            hits.Add(1);
+            return slot;
+        }
+        misses.Add(1);
+        return ::operator new(SlabAllocator::kSlotHeader + ClassCapacity(index));
+    }
+    
+    void Deallocate(void* memory, size_t index) {
+        size_t capacity = ClassCapacity(index);
+        if (count_[index] >= g_config.max_cached_per_class ||
+            cached_bytes_ + capacity > g_config.max_cached_bytes) {
+            releases.Add(1);
+            ::operator delete(memory);
+            return;
+        }
+        FreeSlot* slot = static_cast<FreeSlot*>(memory);
+        slot->next = free_[index];
+        free_[index] = slot;
+        count_[index]++;
+        cached_bytes_ += capacity;
+        bytes_pooled.Add(capacity);
+    }
+    
+    Counter hits;
+    Counter misses;
+    Counter oversized;
+    Counter releases;
+    Counter bytes_pooled;
+    
+private:
+    FreeSlot* free_[kMaxClasses] = {};
+    size_t count_[kMaxClasses] = {};
+    size_t cached_bytes_ = 0;
+};
+
+ThreadCache& LocalCache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+}  // namespace
+
+void SlabAllocator::Configure(const SlabConfig& config) {
+    g_config = config;
+    // 保证 class 大小为 2 的幂且数量不超过 kMaxClasses
+    g_config.min_class_size = std::bit_ceil(std::max<size_t>(g_config.min_class_size, sizeof(FreeSlot)));
+    g_config.max_class_size = std::bit_ceil(std::max(g_config.max_class_size, g_config.min_class_size));
+    if (ClassIndex(g_config.max_class_size) >= kMaxClasses) {
+        g_config.max_class_size = ClassCapacity(kMaxClasses - 1);
+    }
+}
+
+const SlabConfig& SlabAllocator::config() {
+    return g_config;
+}
+
+void* SlabAllocator::Allocate(size_t capacity, size_t* class_capacity) {
+    if (capacity > g_config.max_class_size) {
+        LocalCache().oversized.Add(1);
+        *class_capacity = capacity;
+        return ::operator new(kSlotHeader + capacity);
+    }
+    size_t index = ClassIndex(capacity);
+    *class_capacity = ClassCapacity(index);
+    return LocalCache().Allocate(index);
+}
+
+void SlabAllocator::Deallocate(void* slot, size_t class_capacity) {
+    if (class_capacity > g_config.max_class_size) {
+        ::operator delete(slot);
+        return;
+    }
+    LocalCache().Deallocate(slot, ClassIndex(class_capacity));
+}
+
+SlabStats SlabAllocator::Stats() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    SlabStats stats = registry.retired;
+    for (ThreadCache* cache : registry.caches) {
+        stats.hits += cache->hits.Load();
+        stats.misses += cache->misses.Load();
+        stats.oversized += cache->oversized.Load();
+        stats.releases += cache->releases.Load();
+        stats.bytes_pooled += cache->bytes_pooled.Load();
+    }
+    return stats;
+}
@@ -0,0 +1,32 @@
+#include "../include/common/wire_codec.h"
+#include <cstring>
+
+namespace {
+constexpr WireFormat kNativeFormat = MakeWireFormat<NativeHeaderLayout>("native");
+constexpr WireFormat kNetworkFormat = MakeWireFormat<NetworkHeaderLayout>("network");
+constexpr WireFormat kSlimFormat = MakeWireFormat<SlimHeaderLayout>("slim");
+constexpr WireFormat kCompactFormat = MakeWireFormat<CompactHeaderCodec>("compact");
+
+constexpr const WireFormat* kFormats[] = {&kNativeFormat, &kNetworkFormat, &kSlimFormat, &kCompactFormat};
+
+static_assert(NativeHeaderLayout::kHostLayout || std::endian::native == std::endian::big,
+              "native layout must match PacketHeader on little-endian hosts");
+static_assert(SlimHeaderLayout::kMinSize == 9 && SlimHeaderLayout::kMaxSize == 21);
+}  // namespace
+
+const WireFormat& WireFormat::Native() {
+    return kNativeFormat;
+}
+
+const WireFormat& WireFormat::Compact() {
+    return kCompactFormat;
+}
+
+const WireFormat* WireFormat::Find(const char* name) {
+    for (const WireFormat* format : kFormats) {
+        if (std::strcmp(format->name, name) == 0) {
+            return format;
+        }
+    }
+    return nullptr;
+}
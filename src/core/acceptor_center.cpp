@@ -0,0 +1,24 @@
+#include "../include/core/acceptor_center.h"
+#include "../include/core/placement_policy.h"
+#include "../include/net/epoller.h"
+#include <unistd.h>
+
+AcceptorCenter::AcceptorCenter(const std::vector<std::unique_ptr<Center>>& workers, PlacementPolicy& placement)
+    : Center(), workers_(workers), placement_(placement) {}
+
+AcceptorCenter::~AcceptorCenter() = default;
+
+void AcceptorCenter::HandleAccepted(int fd) {
+    if (workers_.empty()) {
+        close(fd);
+        return;
+    }
+    
+    // 连接状态只在目标 Worker 线程中创建与访问
+    size_t index = placement_.Select(workers_);
+    workers_[index]->PostConnection(fd);
+}
+
+std::unique_ptr<Epoller> AcceptorCenter::NewConnectionEpoller(int) {
+    return nullptr;
+}
@@ -1,97 +1,177 @@
 #include "../include/core/center.h"
 #include "../include/net/epoller.h"
-#include <iostream>
+#include "../include/common/logger.h"
+#include "../include/core/placement_policy.h"
+#include "../include/core/offload_pool.h"
 #include <unistd.h>
+#include <algorithm>
 #include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
 #include <cstring>
 #include <cerrno>
 
 #ifndef _WIN32
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #endif
 
-Center::Center() : listen_fd_(-1), epoll_fd_(-1), running_(false) {}
+Center::Center()
+    : epoll_fd_(-1), wakeup_fd_(-1), reuse_port_(false), edge_triggered_(false), deferred_flush_(false),
+      ring_enabled_(false), ring_poll_us_(50), offload_pool_(nullptr), stop_requested_(false), ready_lists_(), io_budgets_(),
+      bulk_frame_bytes_(64 << 10), posted_count_(0), connection_count_(0), timers_(MonotonicNs() / 1000000) {
+    io_budgets_[static_cast<size_t>(IoPriority::BULK)] = IoBudget{64 << 10, 16};
+    MetricsRegistry::Register(&metrics_);
+}
 
 Center::~Center() {
-    Stop();
+    MetricsRegistry::Unregister(&metrics_);
+    Shutdown();
 }
 
-bool Center::Listen(const char* host, uint16_t port) {
-    // 创建监听socket
-    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (listen_fd_ < 0) {
-        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+bool Center::Init() {
+    if (epoll_fd_ >= 0) {
+        return true;
+    }
+    
+    // 创建epoll实例
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ < 0) {
+        LOG_ERROR << "Failed to create epoll: " << strerror(errno);
         return false;
     }
     
-    // 设置socket选项
-    int reuse = 1;
-    if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
-        std::cerr << "Failed to set SO_REUSEADDR: " << strerror(errno) << std::endl;
-        close(listen_fd_);
-        listen_fd_ = -1;
+    if (!InitWakeup()) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
         return false;
     }
     
-    // 绑定地址
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) < 0) {
+        LOG_ERROR << "Failed to add eventfd to epoll: " << strerror(errno);
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+        return false;
+    }
     
-    if (host == nullptr || strlen(host) == 0 || strcmp(host, "0.0.0.0") == 0) {
-        addr.sin_addr.s_addr = INADDR_ANY;
-    } else {
-        if (inet_pton(AF_INET, host, &addr.sin_addr) <= 0) {
-            std::cerr << "Invalid address: " << host << std::endl;
-            close(listen_fd_);
-            listen_fd_ = -1;
-            return false;
-        }
+    return true;
+}
+
+bool Center::InitWakeup() {
+    if (wakeup_fd_ >= 0) {
+        return true;
     }
     
-    if (bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        std::cerr << "Failed to bind: " << strerror(errno) << std::endl;
-        close(listen_fd_);
-        listen_fd_ = -1;
+    // 创建唤醒用的eventfd，Stop()与跨线程投递通过它打断事件等待
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        LOG_ERROR << "Failed to create eventfd: " << strerror(errno);
         return false;
     }
-    
-    // 开始监听
-    if (listen(listen_fd_, SOMAXCONN) < 0) {
-        std::cerr << "Failed to listen: " << strerror(errno) << std::endl;
-        close(listen_fd_);
-        listen_fd_ = -1;
+    return true;
+}
+
+bool Center::Listen(const Endpoint& endpoint) {
+    if (endpoint.is_datagram()) {
+        return ListenDatagram(endpoint);
+    }
+    if (!Init()) {
         return false;
     }
-    
-    // 创建epoll实例
-    epoll_fd_ = epoll_create1(0);
-    if (epoll_fd_ < 0) {
-        std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;
-        close(listen_fd_);
-        listen_fd_ = -1;
+    int fd = endpoint.OpenListenSocket(reuse_port_);
+    if (fd < 0 || !AddListenSocket(fd, nullptr, nullptr)) {
         return false;
     }
-    
+    if (endpoint.is_unix()) {
+        socket_files_.push_back(endpoint);
+    }
+    return true;
+}
+
+bool Center::Listen(const Endpoint& endpoint, const std::vector<std::unique_ptr<Center>>& peers,
+                    PlacementPolicy& placement) {
+    if (!Init()) {
+        return false;
+    }
+    // 只有本 Center 绑定该地址，不需要 SO_REUSEPORT
+    int fd = endpoint.OpenListenSocket(false);
+    if (fd < 0 || !AddListenSocket(fd, &peers, &placement)) {
+        return false;
+    }
+    if (endpoint.is_unix()) {
+        socket_files_.push_back(endpoint);
+    }
+    return true;
+}
+
+bool Center::ListenDatagram(const Endpoint& endpoint) {
+    if (!SupportsDatagram()) {
+        LOG_ERROR << "UDP endpoints are not supported by this I/O backend: " << endpoint.ToString();
+        return false;
+    }
+    if (!Init()) {
+        return false;
+    }
+    int fd = endpoint.OpenDatagramSocket(reuse_port_);
+    if (fd < 0) {
+        return false;
+    }
+    auto epoller = NewDatagramEpoller(fd);
+    if (!epoller) {
+        LOG_ERROR << "No datagram handler for " << endpoint.ToString();
+        close(fd);
+        return false;
+    }
+    AddEpoller(std::move(epoller));
+    if (epollers_.find(fd) == epollers_.end()) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool Center::Listen(const char* host, uint16_t port) {
+    Endpoint endpoint;
+    if (!Endpoint::FromHostPort(host, port, &endpoint)) {
+        LOG_ERROR << "Invalid address: " << (host ? host : "");
+        return false;
+    }
+    return Listen(endpoint);
+}
+
+bool Center::AddListenSocket(int fd, const std::vector<std::unique_ptr<Center>>* peers, PlacementPolicy* placement) {
+    listen_sockets_.push_back(ListenSocket{fd, peers, placement});
+    if (!RegisterListenSocket(listen_sockets_.size() - 1)) {
+        close(fd);
+        listen_sockets_.pop_back();
+        return false;
+    }
+    return true;
+}
+
+bool Center::RegisterListenSocket(size_t index) {
     // 将监听socket加入epoll
+    int fd = listen_sockets_[index].fd;
     epoll_event ev{};
     ev.events = EPOLLIN;
-    ev.data.fd = listen_fd_;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) < 0) {
-        std::cerr << "Failed to add listen fd to epoll: " << strerror(errno) << std::endl;
-        close(epoll_fd_);
-        close(listen_fd_);
-        epoll_fd_ = -1;
-        listen_fd_ = -1;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        LOG_ERROR << "Failed to add listen fd to epoll: " << strerror(errno);
         return false;
     }
-    
-    std::cout << "Listening on " << (host ? host : "0.0.0.0") << ":" << port << std::endl;
     return true;
 }
 
+int Center::FindListenSocket(int fd) const {
+    for (size_t i = 0; i < listen_sockets_.size(); i++) {
+        if (listen_sockets_[i].fd == fd) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
 int Center::GetFd(const Epoller* epoller) const {
     return epoller ? epoller->GetFd() : -1;
 }
@@ -102,17 +182,41 @@ void Center::AddEpoller(std::unique_ptr<Epoller> epoller) {
         return;
     }
     
+    epoller->center_ = this;
+    epoller->metrics_ = &metrics_;
+    epoller->edge_triggered_ = edge_triggered_;
+    if (!RegisterEpoller(epoller.get())) {
+        epoller->center_ = nullptr;
+        epoller->metrics_ = Epoller::DetachedMetrics();
+        return;
+    }
+    metrics_.connections_accepted.Add(1);
+    
+    Epoller* added = epoller.get();
+    epollers_[fd] = std::move(epoller);
+    connection_count_.store(epollers_.size(), std::memory_order_relaxed);
+    added->OnRegistered();
+}
+
+bool Center::RegisterEpoller(Epoller* epoller) {
     // 将fd加入epoll
+    uint32_t events = epoller->Events();
     epoll_event ev{};
-    ev.events = EPOLLIN;
-    ev.data.ptr = epoller.get();
+    ev.events = edge_triggered_ ? (events | EPOLLET) : events;
+    ev.data.ptr = epoller;
     
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
-        std::cerr << "Failed to add fd to epoll: " << strerror(errno) << std::endl;
-        return;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, epoller->GetFd(), &ev) < 0) {
+        LOG_ERROR << "Failed to add fd to epoll: " << strerror(errno);
+        return false;
     }
     
-    epollers_[fd] = std::move(epoller);
+    epoller->registered_events_ = events;
+    return true;
+}
+
+void Center::UnregisterEpoller(Epoller* epoller) {
+    // 从epoll中移除
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, epoller->GetFd(), nullptr);
 }
 
 void Center::RemoveEpoller(Epoller* epoller) {
@@ -121,84 +225,282 @@ void Center::RemoveEpoller(Epoller* epoller) {
     }
     
     int fd = epoller->GetFd();
+    Unschedule(epoller);
+    UnregisterEpoller(epoller);
     
-    // 从epoll中移除
-    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    // 从map中移除；同一批事件中可能还有它的其他事件源（如共享内存环的门铃），本轮结束后再析构
+    auto it = epollers_.find(fd);
+    if (it != epollers_.end()) {
+        closed_epollers_.push_back(std::move(it->second));
+        epollers_.erase(it);
+    }
+    epoller->fd_ = -1;
+    connection_count_.store(epollers_.size(), std::memory_order_relaxed);
+    metrics_.connections_closed.Add(1);
+    
+    LOG_DEBUG << "Removed epoller for fd: " << fd;
+}
+
+void Center::UpdateEpoller(Epoller* epoller) {
+    int fd = GetFd(epoller);
+    if (fd < 0) {
+        return;
+    }
     
-    // 从map中移除
-    epollers_.erase(fd);
+    uint32_t events = epoller->Events();
+    if (events == epoller->registered_events_) {
+        return;
+    }
     
-    std::cout << "Removed epoller for fd: " << fd << std::endl;
+    epoll_event ev{};
+    ev.events = epoller->edge_triggered_ ? (events | EPOLLET) : events;
+    ev.data.ptr = epoller;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        LOG_ERROR << "Failed to modify fd in epoll: " << strerror(errno);
+        return;
+    }
+    epoller->registered_events_ = events;
+}
+
+void Center::OnEpollerClosed(Epoller* epoller, int fd) {
+    // 关闭可能发生在 Epoller 自身的 In()/Out() 调用栈中，不能立即析构：
+    // 先移出连接表（fd 随后可能被新连接复用），本轮事件处理结束后再回收
+    auto it = epollers_.find(fd);
+    if (it == epollers_.end() || it->second.get() != epoller) {
+        return;
+    }
+    Unschedule(epoller);
+    closed_epollers_.push_back(std::move(it->second));
+    epollers_.erase(it);
+    connection_count_.store(epollers_.size(), std::memory_order_relaxed);
+    metrics_.connections_closed.Add(1);
+    LOG_DEBUG << "Removed epoller for fd: " << fd;
+}
+
+bool Center::SubmitSend(Epoller*, msghdr*, size_t) {
+    // epoll 后端由 Epoller 直接同步发送
+    return false;
+}
+
+bool Center::WatchReadable(Epoller* epoller, int fd) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = epoller;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        LOG_ERROR << "Failed to add fd " << fd << " to epoll: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void Center::UnwatchReadable(int fd) {
+    // epoll 按打开的文件而非 fd 登记，文件仍被其他进程持有时关闭 fd 不会自动移除
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void Center::SetIoBudget(IoPriority priority, const IoBudget& budget) {
+    // 预算为 0 的连接永远读不到数据
+    IoBudget& target = io_budgets_[static_cast<size_t>(priority)];
+    target.bytes = std::max<size_t>(budget.bytes, 1);
+    target.packets = std::max<size_t>(budget.packets, 1);
+}
+
+int Center::WaitTimeoutMs() const {
+    for (const auto& list : ready_lists_) {
+        if (!list.empty()) {
+            return 0;
+        }
+    }
+    return timers_.NextTimeoutMs();
+}
+
+void Center::AdvanceTimers() {
+    // 没有定时器时也要推进，否则之后启动的定时器会以过时的时刻为起点
+    timers_.Advance(MonotonicNs() / 1000000);
+}
+
+void Center::ReapClosedEpollers() {
+    if (closed_epollers_.empty()) {
+        return;
+    }
+    // 仍有未完成异步操作的 Epoller 留到之后再回收
+    size_t kept = 0;
+    for (auto& epoller : closed_epollers_) {
+        if (epoller->inflight_ops_ > 0) {
+            closed_epollers_[kept++] = std::move(epoller);
+        }
+    }
+    closed_epollers_.resize(kept);
+}
+
+void Center::SetAsyncIo(Epoller* epoller, bool async_io) {
+    epoller->async_io_ = async_io;
+}
+
+void Center::AddInflight(Epoller* epoller, int delta) {
+    epoller->inflight_ops_ += delta;
+}
+
+uint32_t Center::RegisteredEvents(const Epoller* epoller) {
+    return epoller->registered_events_;
+}
+
+void Center::SetRegisteredEvents(Epoller* epoller, uint32_t events) {
+    epoller->registered_events_ = events;
+}
+
+bool Center::RecvArmed(const Epoller* epoller) {
+    return epoller->recv_armed_;
+}
+
+void Center::SetRecvArmed(Epoller* epoller, bool armed) {
+    epoller->recv_armed_ = armed;
+}
+
+void Center::ScheduleIfPending(Epoller* epoller) {
+    if (epoller->in_ready_list_ || epoller->GetFd() < 0) {
+        return;
+    }
+    if (epoller->HasPendingIn() || epoller->HasPendingOut()) {
+        epoller->in_ready_list_ = true;
+        ready_lists_[static_cast<size_t>(epoller->priority())].push_back(epoller);
+    }
+}
+
+void Center::Unschedule(Epoller* epoller) {
+    if (epoller->in_flush_list_) {
+        auto it = std::find(flush_list_.begin(), flush_list_.end(), epoller);
+        if (it != flush_list_.end()) {
+            *it = nullptr;
+        }
+        epoller->in_flush_list_ = false;
+    }
+    if (!epoller->in_ready_list_) {
+        return;
+    }
+    // 入列后优先级可能被调整过，各列表都找一遍
+    for (auto& list : ready_lists_) {
+        auto it = std::find(list.begin(), list.end(), epoller);
+        if (it != list.end()) {
+            list.erase(it);
+            break;
+        }
+    }
+    epoller->in_ready_list_ = false;
+}
+
+void Center::ScheduleFlush(Epoller* epoller) {
+    if (epoller->in_flush_list_) {
+        return;
+    }
+    epoller->in_flush_list_ = true;
+    flush_list_.push_back(epoller);
+}
+
+void Center::FlushDirty() {
+    // 写出过程中可能有连接再次入队（如 AllSendedImpl 中继续 Send），按下标遍历以包含新加入的项；
+    // 被移除的连接在列表中置空
+    for (size_t i = 0; i < flush_list_.size(); i++) {
+        Epoller* epoller = flush_list_[i];
+        if (!epoller) {
+            continue;
+        }
+        epoller->in_flush_list_ = false;
+        if (epoller->GetFd() < 0) {
+            continue;
+        }
+        epoller->Out();
+        ScheduleIfPending(epoller);
+    }
+    flush_list_.clear();
+}
+
+void Center::RunReadyList() {
+    // 各列表只处理本轮开始时已在其中的连接，期间重新入列的留到下一轮，保证轮转公平；
+    // 高优先级的列表先服务，低优先级只是排在后面、预算更小，每轮都会轮到，不会饿死
+    std::array<size_t, kIoPriorityCount> counts;
+    for (size_t p = 0; p < kIoPriorityCount; p++) {
+        counts[p] = ready_lists_[p].size();
+    }
+    for (size_t p = 0; p < kIoPriorityCount; p++) {
+        std::deque<Epoller*>& list = ready_lists_[p];
+        for (size_t i = 0; i < counts[p] && !list.empty(); i++) {
+            Epoller* epoller = list.front();
+            list.pop_front();
+            epoller->in_ready_list_ = false;
+            
+            if (epoller->GetFd() < 0) {
+                continue;
+            }
+            if (epoller->HasPendingIn()) {
+                epoller->In();
+            }
+            if (epoller->GetFd() >= 0 && epoller->HasPendingOut()) {
+                epoller->Out();
+            }
+            ScheduleIfPending(epoller);
+        }
+    }
 }
 
 void Center::Run() {
-    if (listen_fd_ < 0 || epoll_fd_ < 0) {
-        std::cerr << "Server not listening" << std::endl;
+    // Worker Center 没有监听socket，只需已初始化epoll
+    if (epoll_fd_ < 0) {
+        LOG_ERROR << "Center not initialized";
         return;
     }
     
-    running_ = true;
     epoll_event events[MAX_EVENTS];
     
-    std::cout << "Starting event loop..." << std::endl;
+    LOG_INFO << "Starting event loop...";
     
-    while (running_) {
-        int num_events = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        // 就绪列表非空时不阻塞，处理完新事件后继续调度未完成的连接
+        int num_events = epoll_wait(epoll_fd_, events, MAX_EVENTS, WaitTimeoutMs());
         
         if (num_events < 0) {
             if (errno == EINTR) {
                 continue;
             }
-            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            LOG_ERROR << "epoll_wait failed: " << strerror(errno);
             break;
         }
+        if (num_events > 0) {
+            metrics_.events_per_wakeup.Record(static_cast<uint64_t>(num_events));
+        }
+        // 先推进定时轮：处理事件时新启动的定时器以本次唤醒的时刻为起点
+        AdvanceTimers();
         
         for (int i = 0; i < num_events; i++) {
             uint32_t event_flags = events[i].events;
             
+            // 唤醒事件：Stop()、跨线程投递的新连接或任务
+            if (events[i].data.fd == wakeup_fd_) {
+                DrainWakeup();
+                DrainPostedConnections();
+                DrainQueuedTasks();
+                continue;
+            }
+            
             // 判断是否是监听socket：监听socket使用data.fd，其他使用data.ptr
-            if (events[i].data.fd == listen_fd_) {
-                while (true) {
-                    sockaddr_in client_addr{};
-                    socklen_t addr_len = sizeof(client_addr);
-                    int client_fd = accept4(listen_fd_, 
-                                            (struct sockaddr*)&client_addr, 
-                                            &addr_len, 
-                                            SOCK_NONBLOCK);
-                    
-                    if (client_fd < 0) {
-                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                            break;
-                        }
-                        std::cerr << "Accept failed: " << strerror(errno) << std::endl;
-                        break;
-                    }
-                    
-                    // 创建新的Epoller
-                    auto epoller = NewConnectionEpoller(client_fd);
-                    if (epoller) {
-                        AddEpoller(std::move(epoller));
-                        
-                        char ip_str[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &client_addr.sin_addr, ip_str, sizeof(ip_str));
-                        std::cout << "New connection from " << ip_str 
-                                  << ":" << ntohs(client_addr.sin_port) 
-                                  << " (fd: " << client_fd << ")" << std::endl;
-                    } else {
-                        close(client_fd);
-                    }
-                }
+            int listen_index = FindListenSocket(events[i].data.fd);
+            if (listen_index >= 0) {
+                AcceptPending(static_cast<size_t>(listen_index));
             } else {
                 // 处理已连接socket的事件 - 使用data.ptr获取Epoller指针
                 Epoller* epoller = static_cast<Epoller*>(events[i].data.ptr);
                 if (epoller) {
                     int fd = epoller->GetFd();
+                    // 本轮已被定时器关闭
+                    if (fd < 0) {
+                        continue;
+                    }
                     
-                    std::cout << "Event on fd " << fd << ": flags=" << std::hex << event_flags << std::dec << std::endl;
+                    LOG_TRACE << "Event on fd " << fd << ": flags=" << LogHex(event_flags);
                     
                     // 错误或挂断
                     if (event_flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
-                        std::cout << "Connection closed or error on fd: " << fd << std::endl;
+                        LOG_DEBUG << "Connection closed or error on fd: " << fd;
                         RemoveEpoller(epoller);
                         close(fd);
                         continue;
@@ -210,35 +512,204 @@ void Center::Run() {
                     }
                     
                     // 写事件
-                    if (event_flags & EPOLLOUT) {
+                    if ((event_flags & EPOLLOUT) && epoller->GetFd() >= 0) {
                         epoller->Out();
                     }
+                    
+                    ScheduleIfPending(epoller);
                 } else {
-                    std::cerr << "Epoller pointer is null" << std::endl;
+                    LOG_ERROR << "Epoller pointer is null";
                 }
             }
         }
+        
+        RunReadyList();
+        FlushDirty();
+        ReapClosedEpollers();
     }
     
-    std::cout << "Event loop stopped" << std::endl;
+    LOG_INFO << "Event loop stopped";
+}
+
+void Center::AcceptPending(size_t index) {
+    while (true) {
+        sockaddr_storage client_addr{};
+        socklen_t addr_len = sizeof(client_addr);
+        int client_fd = accept4(listen_sockets_[index].fd, 
+                                (struct sockaddr*)&client_addr, 
+                                &addr_len, 
+                                SOCK_NONBLOCK);
+        
+        if (client_fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Accept failed: " << strerror(errno);
+            break;
+        }
+        
+        DispatchAccepted(index, client_fd);
+        
+        // 地址格式化只在 DEBUG 开启时进行
+        if (Logger::IsEnabled(LogLevel::DEBUG)) {
+            LOG_DEBUG << "New connection from "
+                      << Endpoint::FormatAddress((struct sockaddr*)&client_addr, addr_len)
+                      << " (fd: " << client_fd << ")";
+        }
+    }
+}
+
+void Center::HandleAccepted(int fd) {
+    AcceptConnection(fd);
+}
+
+std::unique_ptr<Epoller> Center::NewDatagramEpoller(int) {
+    return nullptr;
+}
+
+void Center::DispatchAccepted(size_t index, int fd) {
+    const ListenSocket& listen_socket = listen_sockets_[index];
+    if (!listen_socket.peers) {
+        HandleAccepted(fd);
+        return;
+    }
+    const auto& peers = *listen_socket.peers;
+    Center* target = peers[listen_socket.placement->Select(peers)].get();
+    if (target == this) {
+        HandleAccepted(fd);
+    } else {
+        target->PostConnection(fd);
+    }
+}
+
+void Center::AcceptConnection(int fd) {
+    // 创建新的Epoller
+    auto epoller = NewConnectionEpoller(fd);
+    if (epoller) {
+        AddEpoller(std::move(epoller));
+    } else {
+        close(fd);
+    }
+}
+
+void Center::PostConnection(int fd) {
+    posted_count_.fetch_add(1, std::memory_order_relaxed);
+    posted_fds_.Push(fd);
+    Wakeup();
+}
+
+void Center::DrainPostedConnections() {
+    int fd;
+    while (posted_fds_.Pop(fd)) {
+        AcceptConnection(fd);
+        posted_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void Center::QueueInLoop(std::function<void()> task) {
+    queued_tasks_.Push(std::move(task));
+    Wakeup();
+}
+
+void Center::DrainQueuedTasks() {
+    std::function<void()> task;
+    while (queued_tasks_.Pop(task)) {
+        task();
+    }
+}
+
+bool Center::Offload(Epoller* epoller, std::function<void()> work, std::function<void()> done) {
+    if (offload_pool_ == nullptr) {
+        return false;
+    }
+    // 借用异步操作计数：完成回调执行前 Epoller 即使关闭也留在 closed_epollers_ 中
+    AddInflight(epoller, 1);
+    bool submitted = offload_pool_->Submit([this, epoller, work = std::move(work), done = std::move(done)]() {
+        work();
+        QueueInLoop([this, epoller, done]() {
+            AddInflight(epoller, -1);
+            done();
+            if (epoller->GetFd() >= 0) {
+                ScheduleIfPending(epoller);
+            }
+        });
+    });
+    if (!submitted) {
+        AddInflight(epoller, -1);
+        metrics_.offload_rejected.Add(1);
+        return false;
+    }
+    metrics_.offload_tasks.Add(1);
+    return true;
+}
+
+size_t Center::ConnectionCount() const {
+    return connection_count_.load(std::memory_order_relaxed) +
+           posted_count_.load(std::memory_order_relaxed);
 }
 
 void Center::Stop() {
-    running_ = false;
-    
+    stop_requested_.store(true, std::memory_order_release);
+    Wakeup();
+}
+
+void Center::Wakeup() {
+    if (wakeup_fd_ >= 0) {
+        uint64_t one = 1;
+        // write 是异步信号安全的，可在信号处理函数中使用
+        ssize_t n = write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void Center::DrainWakeup() {
+    uint64_t count = 0;
+    ssize_t n = read(wakeup_fd_, &count, sizeof(count));
+    (void)n;
+}
+
+void Center::Shutdown() {
     // 清理所有连接
     for (auto& pair : epollers_) {
-        close(pair.first);
+        if (pair.second->GetFd() >= 0) {
+            close(pair.first);
+        }
     }
     epollers_.clear();
+    closed_epollers_.clear();
+    for (auto& list : ready_lists_) {
+        list.clear();
+    }
+    flush_list_.clear();
+    connection_count_.store(0, std::memory_order_relaxed);
+    
+    // 尚未接入的投递连接
+    int fd;
+    while (posted_fds_.Pop(fd)) {
+        close(fd);
+    }
+    posted_count_.store(0, std::memory_order_relaxed);
+    // 未执行的完成回调引用的 Epoller 已析构，直接丢弃
+    std::function<void()> task;
+    while (queued_tasks_.Pop(task)) {
+    }
+    
+    if (wakeup_fd_ >= 0) {
+        close(wakeup_fd_);
+        wakeup_fd_ = -1;
+    }
     
     if (epoll_fd_ >= 0) {
         close(epoll_fd_);
         epoll_fd_ = -1;
     }
     
-    if (listen_fd_ >= 0) {
-        close(listen_fd_);
-        listen_fd_ = -1;
+    for (const ListenSocket& listen_socket : listen_sockets_) {
+        close(listen_socket.fd);
+    }
+    listen_sockets_.clear();
+    for (const Endpoint& endpoint : socket_files_) {
+        endpoint.RemoveSocketFile();
     }
+    socket_files_.clear();
 }
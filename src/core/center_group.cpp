@@ -0,0 +1,134 @@
+#include "../include/core/center_group.h"
+#include "../include/core/acceptor_center.h"
+#include "../include/common/logger.h"
+#include <thread>
+
+CenterGroup::CenterGroup(Factory factory, size_t thread_count,
+                         ThreadingModel model, std::unique_ptr<PlacementPolicy> placement)
+    : model_(model), placement_(std::move(placement)) {
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    
+    centers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        centers_.push_back(factory());
+    }
+    
+    if (model_ == ThreadingModel::ACCEPTOR) {
+        if (!placement_) {
+            placement_ = std::make_unique<RoundRobinPlacement>();
+        }
+        acceptor_ = std::make_unique<AcceptorCenter>(centers_, *placement_);
+    }
+}
+
+CenterGroup::~CenterGroup() {
+    // Acceptor 引用了 centers_，需先于 Worker 析构
+    acceptor_.reset();
+}
+
+bool CenterGroup::Listen(const char* host, uint16_t port) {
+    Endpoint endpoint;
+    if (!Endpoint::FromHostPort(host, port, &endpoint)) {
+        LOG_ERROR << "Invalid address: " << (host ? host : "");
+        return false;
+    }
+    return Listen(std::vector<Endpoint>{endpoint});
+}
+
+bool CenterGroup::Listen(const std::vector<Endpoint>& endpoints) {
+    if (model_ == ThreadingModel::ACCEPTOR) {
+        // Worker 不监听，只需准备好 epoll 与唤醒 eventfd 以接收投递的连接
+        for (auto& center : centers_) {
+            if (!center->Init()) {
+                return false;
+            }
+        }
+        for (const Endpoint& endpoint : endpoints) {
+            if (!endpoint.is_datagram()) {
+                if (!acceptor_->Listen(endpoint)) {
+                    return false;
+                }
+                continue;
+            }
+            // 数据报没有接入环节，每个 Worker 各绑定一个 SO_REUSEPORT 的 UDP socket
+            for (auto& center : centers_) {
+                center->SetReusePort(centers_.size() > 1);
+                if (!center->Listen(endpoint)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    // 单线程时保持原有行为，不开启 SO_REUSEPORT
+    bool reuse_port = centers_.size() > 1;
+    for (auto& center : centers_) {
+        center->SetReusePort(reuse_port);
+    }
+    for (const Endpoint& endpoint : endpoints) {
+        if (!reuse_port || endpoint.supports_reuse_port()) {
+            for (auto& center : centers_) {
+                if (!center->Listen(endpoint)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+        // 不能 SO_REUSEPORT 的地址只由第一个 Center 接入，再按 PlacementPolicy 分给各 Center；
+        // 只监听这类地址时其他 Center 没有经过 Listen，需先初始化才能接收投递的连接
+        for (auto& center : centers_) {
+            if (!center->Init()) {
+                return false;
+            }
+        }
+        if (!placement_) {
+            placement_ = std::make_unique<RoundRobinPlacement>();
+        }
+        if (!centers_[0]->Listen(endpoint, centers_, *placement_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CenterGroup::Run() {
+    if (centers_.empty()) {
+        return;
+    }
+    
+    LOG_INFO << "Running " << centers_.size() << " event loop(s)"
+             << (acceptor_ ? " behind an acceptor thread" : "");
+    
+    // ACCEPTOR 模式下所有 Worker 都在新线程中运行，调用线程运行 Acceptor
+    size_t first_threaded = acceptor_ ? 0 : 1;
+    std::vector<std::thread> threads;
+    threads.reserve(centers_.size());
+    for (size_t i = first_threaded; i < centers_.size(); i++) {
+        Center* center = centers_[i].get();
+        threads.emplace_back([center] { center->Run(); });
+    }
+    
+    if (acceptor_) {
+        acceptor_->Run();
+    } else {
+        centers_[0]->Run();
+    }
+    
+    // 任意一个事件循环退出都视为整体停止
+    Stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void CenterGroup::Stop() {
+    if (acceptor_) {
+        acceptor_->Stop();
+    }
+    for (auto& center : centers_) {
+        center->Stop();
+    }
+}
@@ -0,0 +1,154 @@
+#include "../include/core/io_uring.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int SysSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void* arg = nullptr, size_t argsz = 0) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz));
+}
+
+}  // namespace
+
+IoUring::IoUring()
+    : ring_fd_(-1), entries_(0), sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0),
+      sqes_(nullptr), sqes_size_(0), sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(nullptr), sqe_tail_(0),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(nullptr), cqes_(nullptr) {}
+
+IoUring::~IoUring() {
+    Close();
+}
+
+bool IoUring::Init(unsigned entries) {
+    io_uring_params params{};
+    // CQ 放大为 SQ 的 4 倍：多次触发的 accept/recv 会产生远多于提交数的完成事件
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = entries * 4;
+    ring_fd_ = SysSetup(entries, &params);
+    if (ring_fd_ < 0 && errno == EINVAL) {
+        // 旧内核不支持 COOP_TASKRUN
+        params = io_uring_params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ring_fd_ = SysSetup(entries, &params);
+    }
+    if (ring_fd_ < 0) {
+        return false;
+    }
+    // EXT_ARG 用于带超时的等待，驱动 Center 的定时轮
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) ||
+        !(params.features & IORING_FEAT_EXT_ARG)) {
+        Close();
+        errno = ENOTSUP;
+        return false;
+    }
+    entries_ = params.sq_entries;
+    
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (cq_ring_size_ > sq_ring_size_) {
+        sq_ring_size_ = cq_ring_size_;
+    }
+    cq_ring_size_ = sq_ring_size_;
+    
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        Close();
+        return false;
+    }
+    // SINGLE_MMAP：SQ 与 CQ 共用一次映射
+    cq_ring_ = sq_ring_;
+    
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+    
+    uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    // SQ 索引数组固定为恒等映射，提交时只需推进尾指针
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        sq_array[i] = i;
+    }
+    sqe_tail_ = *sq_tail_;
+    
+    uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+void IoUring::Close() {
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (sq_ring_) {
+        munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = nullptr;
+        cq_ring_ = nullptr;
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+unsigned IoUring::SpaceLeft() const {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    return entries_ - (sqe_tail_ - head);
+}
+
+io_uring_sqe* IoUring::GetSqe() {
+    if (SpaceLeft() == 0) {
+        return nullptr;
+    }
+    io_uring_sqe* sqe = &sqes_[sqe_tail_ & *sq_mask_];
+    sqe_tail_++;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::Submit(unsigned wait_nr, int timeout_ms) {
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    // 包括上次未被内核消费完的 SQE
+    unsigned to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (to_submit == 0 && wait_nr == 0) {
+        return 0;
+    }
+    int ret;
+    if (wait_nr > 0 && timeout_ms >= 0) {
+        __kernel_timespec ts{};
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+        io_uring_getevents_arg arg{};
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        ret = SysEnter(ring_fd_, to_submit, wait_nr, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    } else {
+        ret = SysEnter(ring_fd_, to_submit, wait_nr, flags);
+    }
+    return ret < 0 ? -errno : ret;
+}
+
+int IoUring::Register(unsigned opcode, void* arg, unsigned nr_args) {
+    int ret = static_cast<int>(syscall(__NR_io_uring_register, ring_fd_, opcode, arg, nr_args));
+    return ret < 0 ? -errno : ret;
+}
@@ -0,0 +1,536 @@
+#include "../include/core/io_uring_center.h"
+#include "../include/net/epoller.h"
+#include "../include/common/logger.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// user_data 低 3 位为操作类型，其余位为 Epoller 指针（按 8 字节对齐）；accept 的其余位为监听socket下标
+enum Operation : uint64_t {
+    OP_ACCEPT = 1,
+    OP_WAKEUP = 2,
+    OP_CANCEL = 3,
+    OP_RECV = 4,
+    OP_SEND = 5,
+    OP_PROVIDE = 6
+};
+
+constexpr uint64_t kOperationMask = 0x7;
+
+uint64_t EncodeUserData(Epoller* epoller, Operation op) {
+    return reinterpret_cast<uint64_t>(epoller) | op;
+}
+
+// 功能探测：部分内核能注册提供缓冲区环却不从中取缓冲区，
+// 用一次 socketpair 收包确认环真正可用
+bool BufferRingWorks() {
+    IoUring ring;
+    if (!ring.Init(4)) {
+        return false;
+    }
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* mem = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return false;
+    }
+    int sv[2] = {-1, -1};
+    bool works = false;
+    
+    io_uring_buf_ring* br = static_cast<io_uring_buf_ring*>(mem);
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(mem);
+    reg.ring_entries = 1;
+    reg.bgid = 0;
+    char buf[64];
+    if (ring.Register(IORING_REGISTER_PBUF_RING, &reg, 1) >= 0 &&
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0 && write(sv[1], "x", 1) == 1) {
+        br->bufs[0].addr = reinterpret_cast<uint64_t>(buf);
+        br->bufs[0].len = sizeof(buf);
+        br->bufs[0].bid = 0;
+        std::atomic_ref<uint16_t>(br->tail).store(1, std::memory_order_release);
+        
+        io_uring_sqe* sqe = ring.GetSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = sv[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        if (ring.Submit(1) >= 0) {
+            ring.ForEachCqe([&works](const io_uring_cqe& cqe) { works = cqe.res == 1; });
+        }
+    }
+    
+    ring.Close();
+    munmap(mem, page);
+    if (sv[0] >= 0) {
+        close(sv[0]);
+        close(sv[1]);
+    }
+    return works;
+}
+
+// 功能探测：操作码存在不代表支持 multishot（accept 需 5.19+，recv 需 6.0+，旧内核提交时才以 -EINVAL 失败），
+// 在一对 Unix 域 socket 上实际提交一次 multishot accept 与带提供缓冲区的 multishot recv，两者都带 F_MORE 完成才算支持
+bool MultishotWorks() {
+    IoUring ring;
+    if (!ring.Init(4)) {
+        return false;
+    }
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    int client_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    int accepted_fd = -1;
+    sockaddr_un addr{};
+    socklen_t addr_len = sizeof(addr);
+    // 只给出地址族时自动绑定到抽象命名空间中的随机名字
+    sa_family_t family = AF_UNIX;
+    bool ready = listen_fd >= 0 && client_fd >= 0 &&
+                 bind(listen_fd, reinterpret_cast<const sockaddr*>(&family), sizeof(family)) == 0 &&
+                 listen(listen_fd, 1) == 0 && getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0 &&
+                 connect(client_fd, reinterpret_cast<const sockaddr*>(&addr), addr_len) == 0;
+    
+    bool accept_works = false;
+    if (ready) {
+        io_uring_sqe* sqe = ring.GetSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        if (ring.Submit(1) >= 0) {
+            ring.ForEachCqe([&](const io_uring_cqe& cqe) {
+                accepted_fd = cqe.res;
+                accept_works = cqe.res >= 0 && (cqe.flags & IORING_CQE_F_MORE);
+            });
+        }
+    }
+    
+    bool recv_works = false;
+    char buf[64];
+    if (accept_works && write(client_fd, "x", 1) == 1) {
+        io_uring_sqe* sqe = ring.GetSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = 1;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = sizeof(buf);
+        sqe->buf_group = 0;
+        sqe->user_data = OP_PROVIDE;
+        sqe = ring.GetSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = accepted_fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->user_data = OP_RECV;
+        if (ring.Submit(2) >= 0) {
+            ring.ForEachCqe([&recv_works](const io_uring_cqe& cqe) {
+                if (cqe.user_data == OP_RECV) {
+                    recv_works = cqe.res == 1 && (cqe.flags & IORING_CQE_F_MORE);
+                }
+            });
+        }
+    }
+    
+    // 先关闭环，挂着的 multishot 操作随之取消，之后才能释放缓冲区
+    ring.Close();
+    for (int fd : {listen_fd, client_fd, accepted_fd}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    return accept_works && recv_works;
+}
+
+}  // namespace
+
+IoUringCenter::IoUringCenter()
+    : Center(), buf_ring_(nullptr), buf_ring_size_(0), buffers_(nullptr), buffers_size_(0), buf_tail_(0) {}
+
+IoUringCenter::~IoUringCenter() {
+    // 先关闭环，内核停止使用缓冲区后再释放
+    ring_.Close();
+    if (buf_ring_) {
+        munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+    }
+    if (buffers_) {
+        munmap(buffers_, buffers_size_);
+        buffers_ = nullptr;
+    }
+}
+
+bool IoUringCenter::IsSupported() {
+    IoUring ring;
+    if (!ring.Init(8)) {
+        return false;
+    }
+    // 确认所需操作码均可用，再实际提交 multishot 操作确认内核支持
+    const size_t probe_size = sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op);
+    std::vector<uint8_t> storage(probe_size, 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (ring.Register(IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+        return false;
+    }
+    for (uint8_t op : {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_POLL_ADD,
+                       IORING_OP_ASYNC_CANCEL, IORING_OP_PROVIDE_BUFFERS}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return MultishotWorks();
+}
+
+bool IoUringCenter::Init() {
+    if (ring_.IsOpen()) {
+        return true;
+    }
+    
+    if (!ring_.Init(kRingEntries)) {
+        LOG_ERROR << "Failed to create io_uring: " << strerror(errno);
+        return false;
+    }
+    
+    if (!InitBufferRing()) {
+        LOG_ERROR << "Failed to register buffer ring: " << strerror(errno);
+        ring_.Close();
+        return false;
+    }
+    
+    if (!InitWakeup()) {
+        ring_.Close();
+        return false;
+    }
+    ArmWakeup();
+    return true;
+}
+
+bool IoUringCenter::InitBufferRing() {
+    buffers_size_ = kBufferCount * kBufferSize;
+    void* buffers = mmap(nullptr, buffers_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+        buffers_ = nullptr;
+        return false;
+    }
+    buffers_ = static_cast<uint8_t*>(buffers);
+    
+    // 探测结果对所有线程相同，只做一次
+    static const bool ring_works = [] {
+        bool works = BufferRingWorks();
+        if (!works) {
+            LOG_WARN << "Provided buffer ring unavailable, using legacy provided buffers";
+        }
+        return works;
+    }();
+    if (!ring_works) {
+        // 退回 IORING_OP_PROVIDE_BUFFERS：一次性提供全部缓冲区，归还时逐个重新提供
+        io_uring_sqe* sqe = NextSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(kBufferCount);
+        sqe->addr = reinterpret_cast<uint64_t>(buffers_);
+        sqe->len = kBufferSize;
+        sqe->buf_group = kBufferGroup;
+        sqe->off = 0;
+        sqe->user_data = OP_PROVIDE;
+        return true;
+    }
+    
+    buf_ring_size_ = kBufferCount * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        return false;
+    }
+    buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+    
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = kBufferCount;
+    reg.bgid = kBufferGroup;
+    int ret = ring_.Register(IORING_REGISTER_PBUF_RING, &reg, 1);
+    if (ret < 0) {
+        errno = -ret;
+        return false;
+    }
+    
+    buf_tail_ = 0;
+    for (uint16_t bid = 0; bid < kBufferCount; bid++) {
+        RecycleBuffer(bid);
+    }
+    return true;
+}
+
+void IoUringCenter::RecycleBuffer(uint16_t bid) {
+    uint8_t* addr = buffers_ + static_cast<size_t>(bid) * kBufferSize;
+    if (!buf_ring_) {
+        io_uring_sqe* sqe = NextSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = 1;
+        sqe->addr = reinterpret_cast<uint64_t>(addr);
+        sqe->len = kBufferSize;
+        sqe->buf_group = kBufferGroup;
+        sqe->off = bid;
+        sqe->user_data = OP_PROVIDE;
+        return;
+    }
+    
+    io_uring_buf* buf = &buf_ring_->bufs[buf_tail_ & (kBufferCount - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(addr);
+    buf->len = kBufferSize;
+    buf->bid = bid;
+    buf_tail_++;
+    // 发布新的尾指针，内核随后即可复用该缓冲区
+    std::atomic_ref<uint16_t>(buf_ring_->tail).store(buf_tail_, std::memory_order_release);
+}
+
+bool IoUringCenter::RegisterListenSocket(size_t index) {
+    ArmAccept(index);
+    return true;
+}
+
+io_uring_sqe* IoUringCenter::NextSqe() {
+    io_uring_sqe* sqe = ring_.GetSqe();
+    while (!sqe) {
+        // 提交队列已满：先把已准备的提交出去
+        int ret = ring_.Submit();
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            LOG_ERROR << "io_uring submit failed: " << strerror(-ret);
+        }
+        sqe = ring_.GetSqe();
+    }
+    return sqe;
+}
+
+void IoUringCenter::ArmAccept(size_t index) {
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd(index);
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK;
+    // 监听socket下标放在操作类型之上，multishot 结束时据此重新挂起
+    sqe->user_data = (static_cast<uint64_t>(index) << 3) | OP_ACCEPT;
+}
+
+void IoUringCenter::ArmWakeup() {
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeup_fd();
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = OP_WAKEUP;
+}
+
+void IoUringCenter::ArmRecv(Epoller* epoller) {
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = epoller->GetFd();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = EncodeUserData(epoller, OP_RECV);
+    AddInflight(epoller, 1);
+    SetRecvArmed(epoller, true);
+}
+
+void IoUringCenter::CancelOperation(Epoller* epoller, uint64_t op) {
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = EncodeUserData(epoller, static_cast<Operation>(op));
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = OP_CANCEL;
+}
+
+void IoUringCenter::CancelEpoller(Epoller* epoller) {
+    // 取消该连接所有在途的 recv/send，它们的完成事件到达后 Epoller 才能回收
+    CancelOperation(epoller, OP_RECV);
+    CancelOperation(epoller, OP_SEND);
+}
+
+bool IoUringCenter::RegisterEpoller(Epoller* epoller) {
+    SetAsyncIo(epoller, true);
+    ArmRecv(epoller);
+    SetRegisteredEvents(epoller, EPOLLIN);
+    return true;
+}
+
+void IoUringCenter::UpdateEpoller(Epoller* epoller) {
+    if (epoller->GetFd() < 0) {
+        return;
+    }
+    uint32_t events = epoller->Events();
+    bool want_in = events & EPOLLIN;
+    bool armed = RegisteredEvents(epoller) & EPOLLIN;
+    if (want_in && !armed) {
+        // 上一个 recv 已请求取消但最终完成事件未到时不能立即挂起新的：两个 recv 同时在途会瓜分数据、打乱顺序。
+        // 由 HandleRecv 在最终完成事件到达后重新挂起
+        if (!RecvArmed(epoller)) {
+            ArmRecv(epoller);
+        }
+    } else if (!want_in && armed) {
+        // 取消前已收到的数据仍会经 InData 交付
+        CancelOperation(epoller, OP_RECV);
+    }
+    SetRegisteredEvents(epoller, events);
+}
+
+void IoUringCenter::UnregisterEpoller(Epoller* epoller) {
+    CancelEpoller(epoller);
+}
+
+void IoUringCenter::OnEpollerClosed(Epoller* epoller, int fd) {
+    Center::OnEpollerClosed(epoller, fd);
+    CancelEpoller(epoller);
+}
+
+bool IoUringCenter::SubmitSend(Epoller* epoller, msghdr* msgs, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    // 链接的 SQE 必须在同一次提交中，空间不足时先提交已有的
+    if (ring_.SpaceLeft() < count) {
+        ring_.Submit();
+        if (ring_.SpaceLeft() < count) {
+            return false;
+        }
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        io_uring_sqe* sqe = ring_.GetSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = epoller->GetFd();
+        sqe->addr = reinterpret_cast<uint64_t>(&msgs[i]);
+        sqe->len = 1;
+        // MSG_WAITALL：流式 socket 的短写由内核续写，短写即视为失败并中断链
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->user_data = EncodeUserData(epoller, OP_SEND);
+        // 按顺序执行；前一个短写时后续以 ECANCELED 结束
+        if (i + 1 < count) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+        AddInflight(epoller, 1);
+    }
+    return true;
+}
+
+void IoUringCenter::Run() {
+    if (!ring_.IsOpen()) {
+        LOG_ERROR << "Center not initialized";
+        return;
+    }
+    
+    LOG_INFO << "Starting io_uring event loop...";
+    
+    while (!stop_requested()) {
+        int ret = ring_.Submit(1, WaitTimeoutMs());
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY && ret != -ETIME) {
+            LOG_ERROR << "io_uring_enter failed: " << strerror(-ret);
+            break;
+        }
+        
+        AdvanceTimers();
+        unsigned completions = ring_.ForEachCqe([this](const io_uring_cqe& cqe) { HandleCompletion(cqe); });
+        if (completions > 0) {
+            metrics().events_per_wakeup.Record(completions);
+        }
+        FlushDirty();
+        ReapClosedEpollers();
+    }
+    
+    LOG_INFO << "Event loop stopped";
+}
+
+void IoUringCenter::HandleCompletion(const io_uring_cqe& cqe) {
+    Operation op = static_cast<Operation>(cqe.user_data & kOperationMask);
+    Epoller* epoller = reinterpret_cast<Epoller*>(cqe.user_data & ~kOperationMask);
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+    
+    switch (op) {
+        case OP_ACCEPT:
+            if (cqe.res >= 0) {
+                DispatchAccepted(cqe.user_data >> 3, cqe.res);
+                LOG_DEBUG << "New connection (fd: " << cqe.res << ")";
+            } else if (cqe.res != -ECANCELED) {
+                LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Accept failed: " << strerror(-cqe.res);
+            }
+            if (!more && !stop_requested()) {
+                // 只在暂时性错误后重新挂起：不支持 multishot 的内核每次都返回 -EINVAL，重新挂起只会空转
+                if (cqe.res >= 0 || cqe.res == -ENOBUFS || cqe.res == -EINTR || cqe.res == -ECANCELED ||
+                    cqe.res == -ECONNABORTED) {
+                    ArmAccept(cqe.user_data >> 3);
+                } else {
+                    LOG_ERROR << "Accept stopped on listener " << (cqe.user_data >> 3) << ": " << strerror(-cqe.res);
+                }
+            }
+            break;
+            
+        case OP_WAKEUP:
+            DrainWakeup();
+            DrainPostedConnections();
+            DrainQueuedTasks();
+            if (!more && !stop_requested()) {
+                ArmWakeup();
+            }
+            break;
+            
+        case OP_RECV:
+            HandleRecv(epoller, cqe);
+            break;
+            
+        case OP_SEND:
+            AddInflight(epoller, -1);
+            epoller->OutCompleted(cqe.res);
+            break;
+            
+        case OP_PROVIDE:
+            if (cqe.res < 0) {
+                LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Provide buffers failed: " << strerror(-cqe.res);
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void IoUringCenter::HandleRecv(Epoller* epoller, const io_uring_cqe& cqe) {
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+    
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (cqe.res > 0 && epoller->GetFd() >= 0) {
+            epoller->InData(buffers_ + static_cast<size_t>(bid) * kBufferSize, static_cast<size_t>(cqe.res));
+        }
+        RecycleBuffer(bid);
+    }
+    
+    bool rearm = false;
+    if (cqe.res == 0) {
+        // 对端关闭
+        if (epoller->GetFd() >= 0) {
+            epoller->InData(nullptr, 0);
+        }
+    } else if (cqe.res < 0) {
+        if (cqe.res == -ENOBUFS || cqe.res == -EINTR || cqe.res == -ECANCELED) {
+            // 缓冲区暂时耗尽，已处理的缓冲区归还后重新挂起；取消（暂停读取）期间又恢复了读取时同样重新挂起
+            rearm = true;
+        } else if (epoller->GetFd() >= 0) {
+            LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Recv error on fd " << epoller->GetFd() << ": " << strerror(-cqe.res);
+            epoller->InData(nullptr, 0);
+        }
+    } else if (!more) {
+        // multishot 被内核终止但连接仍正常，重新挂起
+        rearm = true;
+    }
+    
+    if (!more) {
+        AddInflight(epoller, -1);
+        SetRecvArmed(epoller, false);
+        // 暂停读取期间不重新挂起，恢复时由 UpdateEpoller 挂起
+        if (rearm && epoller->GetFd() >= 0 && (RegisteredEvents(epoller) & EPOLLIN)) {
+            ArmRecv(epoller);
+        }
+    }
+}
@@ -0,0 +1,232 @@
+#include "../include/core/metrics.h"
+#include "../include/net/flow_control.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ReactorMetrics*> reactors;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+HistogramSnapshot SnapshotOf(const LogHistogram& histogram) {
+    HistogramSnapshot snapshot;
+    for (size_t i = 0; i < LogHistogram::kBuckets; i++) {
+        snapshot.buckets[i] = histogram.buckets[i].Load();
+    }
+    snapshot.count = histogram.count.Load();
+    snapshot.sum = histogram.sum.Load();
+    snapshot.max = histogram.max.Load();
+    return snapshot;
+}
+
+void AppendLine(std::string* out, const char* name, const char* labels, uint64_t value) {
+    char line[160];
+    int n = snprintf(line, sizeof(line), "%s%s %llu\n", name, labels, static_cast<unsigned long long>(value));
+    if (n > 0) {
+        out->append(line, std::min(static_cast<size_t>(n), sizeof(line) - 1));
+    }
+}
+
+void AppendSnapshot(std::string* out, const MetricsSnapshot& snapshot, const char* labels) {
+    AppendLine(out, "echo_connections_accepted_total", labels, snapshot.connections_accepted);
+    AppendLine(out, "echo_connections_closed_total", labels, snapshot.connections_closed);
+    AppendLine(out, "echo_connections_timed_out_total", labels, snapshot.connections_timed_out);
+    AppendLine(out, "echo_connections", labels, snapshot.connections_accepted - snapshot.connections_closed);
+    AppendLine(out, "echo_packets_in_total", labels, snapshot.packets_in);
+    AppendLine(out, "echo_packets_out_total", labels, snapshot.packets_out);
+    AppendLine(out, "echo_bytes_in_total", labels, snapshot.bytes_in);
+    AppendLine(out, "echo_bytes_out_total", labels, snapshot.bytes_out);
+    AppendLine(out, "echo_read_eagain_total", labels, snapshot.read_eagain);
+    AppendLine(out, "echo_write_eagain_total", labels, snapshot.write_eagain);
+    AppendLine(out, "echo_send_queue_depth", labels, snapshot.send_queue_depth);
+    AppendLine(out, "echo_send_queue_bytes", labels, snapshot.send_queue_bytes);
+    AppendLine(out, "echo_read_pauses_total", labels, snapshot.read_pauses);
+    AppendLine(out, "echo_checksum_errors_total", labels, snapshot.checksum_errors);
+    AppendLine(out, "echo_datagrams_received_total", labels, snapshot.datagrams_received);
+    AppendLine(out, "echo_datagrams_sent_total", labels, snapshot.datagrams_sent);
+    AppendLine(out, "echo_datagrams_dropped_total", labels, snapshot.datagrams_dropped);
+    AppendLine(out, "echo_gso_sends_total", labels, snapshot.gso_sends);
+    AppendLine(out, "echo_ring_connections_total", labels, snapshot.ring_connections);
+    AppendLine(out, "echo_ring_doorbells_total", labels, snapshot.ring_doorbells);
+    AppendLine(out, "echo_offload_tasks_total", labels, snapshot.offload_tasks);
+    AppendLine(out, "echo_offload_rejected_total", labels, snapshot.offload_rejected);
+    AppendLine(out, "echo_budget_yields_total", labels, snapshot.budget_yields);
+}
+
+// 直方图以 summary 形式输出：分位数 + count/sum/max
+void AppendSummary(std::string* out, const char* name, const HistogramSnapshot& histogram) {
+    static const struct {
+        const char* label;
+        double q;
+    } kQuantiles[] = {{"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+    
+    std::string metric;
+    for (const auto& quantile : kQuantiles) {
+        std::string labels = std::string("{quantile=\"") + quantile.label + "\"}";
+        AppendLine(out, name, labels.c_str(), histogram.Percentile(quantile.q));
+    }
+    metric = std::string(name) + "_count";
+    AppendLine(out, metric.c_str(), "", histogram.count);
+    metric = std::string(name) + "_sum";
+    AppendLine(out, metric.c_str(), "", histogram.sum);
+    metric = std::string(name) + "_max";
+    AppendLine(out, metric.c_str(), "", histogram.max);
+}
+
+}  // namespace
+
+void LogHistogram::Record(uint64_t value) {
+    buckets[std::bit_width(value)].Add(1);
+    count.Add(1);
+    sum.Add(value);
+    if (value > max.Load()) {
+        max.value.store(value, std::memory_order_relaxed);
+    }
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < LogHistogram::kBuckets; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t HistogramSnapshot::Percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LogHistogram::kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = i >= 64 ? UINT64_MAX : (uint64_t(1) << i) - 1;
+            return std::min(upper, max);
+        }
+    }
+    return max;
+}
+
+MetricsSnapshot MetricsSnapshot::From(const ReactorMetrics& metrics) {
+    MetricsSnapshot snapshot;
+    snapshot.connections_accepted = metrics.connections_accepted.Load();
+    snapshot.connections_closed = metrics.connections_closed.Load();
+    snapshot.connections_timed_out = metrics.connections_timed_out.Load();
+    snapshot.packets_in = metrics.packets_in.Load();
+    snapshot.packets_out = metrics.packets_out.Load();
+    snapshot.bytes_in = metrics.bytes_in.Load();
+    snapshot.bytes_out = metrics.bytes_out.Load();
+    snapshot.read_eagain = metrics.read_eagain.Load();
+    snapshot.write_eagain = metrics.write_eagain.Load();
+    snapshot.send_queue_depth = metrics.send_queue_depth.Load();
+    snapshot.send_queue_bytes = metrics.send_queue_bytes.Load();
+    snapshot.read_pauses = metrics.read_pauses.Load();
+    snapshot.checksum_errors = metrics.checksum_errors.Load();
+    snapshot.datagrams_received = metrics.datagrams_received.Load();
+    snapshot.datagrams_sent = metrics.datagrams_sent.Load();
+    snapshot.datagrams_dropped = metrics.datagrams_dropped.Load();
+    snapshot.gso_sends = metrics.gso_sends.Load();
+    snapshot.ring_connections = metrics.ring_connections.Load();
+    snapshot.ring_doorbells = metrics.ring_doorbells.Load();
+    snapshot.offload_tasks = metrics.offload_tasks.Load();
+    snapshot.offload_rejected = metrics.offload_rejected.Load();
+    snapshot.budget_yields = metrics.budget_yields.Load();
+    snapshot.events_per_wakeup = SnapshotOf(metrics.events_per_wakeup);
+    snapshot.echo_latency_ns = SnapshotOf(metrics.echo_latency_ns);
+    return snapshot;
+}
+
+void MetricsSnapshot::Merge(const MetricsSnapshot& other) {
+    connections_accepted += other.connections_accepted;
+    connections_closed += other.connections_closed;
+    connections_timed_out += other.connections_timed_out;
+    packets_in += other.packets_in;
+    packets_out += other.packets_out;
+    bytes_in += other.bytes_in;
+    bytes_out += other.bytes_out;
+    read_eagain += other.read_eagain;
+    write_eagain += other.write_eagain;
+    send_queue_depth += other.send_queue_depth;
+    send_queue_bytes += other.send_queue_bytes;
+    read_pauses += other.read_pauses;
+    checksum_errors += other.checksum_errors;
+    datagrams_received += other.datagrams_received;
+    datagrams_sent += other.datagrams_sent;
+    datagrams_dropped += other.datagrams_dropped;
+    gso_sends += other.gso_sends;
+    ring_connections += other.ring_connections;
+    ring_doorbells += other.ring_doorbells;
+    offload_tasks += other.offload_tasks;
+    offload_rejected += other.offload_rejected;
+    budget_yields += other.budget_yields;
+    events_per_wakeup.Merge(other.events_per_wakeup);
+    echo_latency_ns.Merge(other.echo_latency_ns);
+}
+
+void MetricsRegistry::Register(ReactorMetrics* metrics) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.reactors.push_back(metrics);
+}
+
+void MetricsRegistry::Unregister(ReactorMetrics* metrics) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.reactors.erase(std::remove(registry.reactors.begin(), registry.reactors.end(), metrics),
+                            registry.reactors.end());
+}
+
+std::vector<MetricsSnapshot> MetricsRegistry::Collect() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<MetricsSnapshot> snapshots;
+    snapshots.reserve(registry.reactors.size());
+    for (ReactorMetrics* metrics : registry.reactors) {
+        snapshots.push_back(MetricsSnapshot::From(*metrics));
+    }
+    return snapshots;
+}
+
+std::string MetricsRegistry::Format() {
+    std::vector<MetricsSnapshot> snapshots = Collect();
+    MetricsSnapshot total;
+    for (const MetricsSnapshot& snapshot : snapshots) {
+        total.Merge(snapshot);
+    }
+    
+    std::string out;
+    out.reserve(4096);
+    AppendLine(&out, "echo_reactors", "", snapshots.size());
+    // 未设置内存预算时不记账，也不输出
+    if (FlowControl::config().memory_budget != 0) {
+        AppendLine(&out, "echo_memory_budget_bytes", "", FlowControl::config().memory_budget);
+        AppendLine(&out, "echo_memory_budget_used_bytes", "", FlowControl::BufferedBytes());
+    }
+    AppendSnapshot(&out, total, "");
+    AppendSummary(&out, "echo_events_per_wakeup", total.events_per_wakeup);
+    AppendSummary(&out, "echo_latency_ns", total.echo_latency_ns);
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "{reactor=\"%zu\"}", i);
+        AppendSnapshot(&out, snapshots[i], labels);
+    }
+    return out;
+}
+
+uint64_t MonotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
+}
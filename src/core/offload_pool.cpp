@@ -0,0 +1,118 @@
+#include "../include/core/offload_pool.h"
+#include "../include/common/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kDefaultCapacityPerThread = 1024;
+
+}  // namespace
+
+OffloadPool::OffloadPool(size_t threads, size_t capacity, int nice)
+    : capacity_(capacity != 0 ? capacity : std::max<size_t>(threads, 1) * kDefaultCapacityPerThread), nice_(nice),
+      inflight_(0), queued_(0), next_worker_(0), sleeping_(0), stopping_(false) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    // 全部队列建好后再启动线程，窃取时不会看到未构造的 Worker
+    for (size_t i = 0; i < threads; i++) {
+        workers_[i]->thread = std::thread(&OffloadPool::WorkerLoop, this, i);
+        std::string name = "offload-" + std::to_string(i);
+        pthread_setname_np(workers_[i]->thread.native_handle(), name.c_str());
+    }
+    LOG_INFO << "Offload pool started: threads=" << threads << " capacity=" << capacity_ << " nice=" << nice_;
+}
+
+OffloadPool::~OffloadPool() {
+    Stop();
+}
+
+bool OffloadPool::Submit(std::function<void()> task) {
+    if (stopping_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (inflight_.fetch_add(1, std::memory_order_relaxed) >= capacity_) {
+        inflight_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    Worker& worker = *workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    // 与 WorkerLoop 中先登记 sleeping_ 再检查 queued_ 的顺序配对（均为 seq_cst）：
+    // 要么线程看到了新任务不休眠，要么这里看到有线程休眠并唤醒它
+    queued_.fetch_add(1);
+    if (sleeping_.load() > 0) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_one();
+    }
+    return true;
+}
+
+void OffloadPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        stopping_.store(true);
+        idle_cv_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.clear();
+    }
+}
+
+bool OffloadPool::TakeTask(size_t index, std::function<void()>* task) {
+    size_t count = workers_.size();
+    for (size_t i = 0; i < count; i++) {
+        Worker& worker = *workers_[(index + i) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            *task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        } else {
+            *task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        queued_.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void OffloadPool::WorkerLoop(size_t index) {
+    // Linux 上 setpriority 的 PRIO_PROCESS 作用于单个线程
+    if (nice_ != 0 && setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice_) < 0) {
+        LOG_WARN << "Failed to set offload thread priority: " << strerror(errno);
+    }
+    while (!stopping_.load(std::memory_order_acquire)) {
+        std::function<void()> task;
+        if (TakeTask(index, &task)) {
+            task();
+            inflight_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleeping_.fetch_add(1);
+        idle_cv_.wait(lock, [this] { return stopping_.load() || queued_.load() > 0; });
+        sleeping_.fetch_sub(1);
+    }
+}
@@ -0,0 +1,24 @@
+#include "../include/core/placement_policy.h"
+#include "../include/core/center.h"
+
+size_t RoundRobinPlacement::Select(const std::vector<std::unique_ptr<Center>>& workers) {
+    if (workers.empty()) {
+        return 0;
+    }
+    size_t index = next_ % workers.size();
+    next_ = index + 1;
+    return index;
+}
+
+size_t LeastConnectionsPlacement::Select(const std::vector<std::unique_ptr<Center>>& workers) {
+    size_t best = 0;
+    size_t best_count = static_cast<size_t>(-1);
+    for (size_t i = 0; i < workers.size(); i++) {
+        size_t count = workers[i]->ConnectionCount();
+        if (count < best_count) {
+            best = i;
+            best_count = count;
+        }
+    }
+    return best;
+}
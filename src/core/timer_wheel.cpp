@@ -0,0 +1,183 @@
+#include "../include/core/timer_wheel.h"
+#include <algorithm>
+#include <climits>
+
+Timer::Timer() : wheel_(nullptr), expire_tick_(0) {}
+
+Timer::Timer(std::function<void()> callback) : wheel_(nullptr), expire_tick_(0), callback_(std::move(callback)) {}
+
+Timer::~Timer() {
+    Cancel();
+}
+
+void Timer::Cancel() {
+    if (wheel_) {
+        wheel_->Cancel(this);
+    }
+}
+
+TimerWheel::TimerWheel(uint64_t now_ms) : base_ms_(now_ms), current_(0), size_(0) {
+    for (TimerLink& slot : near_) {
+        InitSlot(&slot);
+    }
+    for (auto& level : far_) {
+        for (TimerLink& slot : level) {
+            InitSlot(&slot);
+        }
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    // 持有者可能晚于时间轮析构，先断开所有定时器
+    auto detach = [](TimerLink* slot) {
+        while (slot->next != slot) {
+            Timer* timer = static_cast<Timer*>(slot->next);
+            Unlink(timer);
+            timer->wheel_ = nullptr;
+        }
+    };
+    for (TimerLink& slot : near_) {
+        detach(&slot);
+    }
+    for (auto& level : far_) {
+        for (TimerLink& slot : level) {
+            detach(&slot);
+        }
+    }
+}
+
+void TimerWheel::InitSlot(TimerLink* slot) {
+    slot->prev = slot;
+    slot->next = slot;
+}
+
+void TimerWheel::Link(TimerLink* slot, TimerLink* node) {
+    node->prev = slot->prev;
+    node->next = slot;
+    slot->prev->next = node;
+    slot->prev = node;
+}
+
+void TimerWheel::Unlink(TimerLink* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void TimerWheel::Arm(Timer* timer, uint64_t delay_ms) {
+    if (timer->wheel_) {
+        timer->wheel_->Cancel(timer);
+    }
+    // 至少下一个 tick 才到期，回调中重新启动的定时器不会在同一次推进中被反复触发
+    timer->expire_tick_ = current_ + std::clamp<uint64_t>(delay_ms, 1, kMaxDelay);
+    timer->wheel_ = this;
+    Insert(timer);
+    size_++;
+}
+
+void TimerWheel::Cancel(Timer* timer) {
+    if (timer->wheel_ != this) {
+        return;
+    }
+    Unlink(timer);
+    timer->wheel_ = nullptr;
+    size_--;
+}
+
+void TimerWheel::Insert(Timer* timer) {
+    uint64_t expire = timer->expire_tick_;
+    uint64_t delta = expire - current_;
+    if (delta < kNearSize) {
+        Link(&near_[expire & (kNearSize - 1)], timer);
+        return;
+    }
+    for (unsigned level = 0; level < kFarLevels; level++) {
+        unsigned shift = kNearBits + level * kFarBits;
+        if (delta < (uint64_t(1) << (shift + kFarBits)) || level + 1 == kFarLevels) {
+            Link(&far_[level][(expire >> shift) & (kFarSize - 1)], timer);
+            return;
+        }
+    }
+}
+
+void TimerWheel::Cascade(unsigned level, size_t index) {
+    // 把高层一个槽中的定时器按剩余时间重新放入更低的层
+    TimerLink pending;
+    InitSlot(&pending);
+    TimerLink* slot = &far_[level][index];
+    while (slot->next != slot) {
+        TimerLink* node = slot->next;
+        Unlink(node);
+        Link(&pending, node);
+    }
+    while (pending.next != &pending) {
+        Timer* timer = static_cast<Timer*>(pending.next);
+        Unlink(timer);
+        Insert(timer);
+    }
+}
+
+size_t TimerWheel::Fire(TimerLink* slot) {
+    // 先整体摘到本地链表：回调可能取消同批的其他定时器，或重新启动自己
+    TimerLink expired;
+    InitSlot(&expired);
+    while (slot->next != slot) {
+        TimerLink* node = slot->next;
+        Unlink(node);
+        Link(&expired, node);
+    }
+    size_t fired = 0;
+    while (expired.next != &expired) {
+        Timer* timer = static_cast<Timer*>(expired.next);
+        Unlink(timer);
+        timer->wheel_ = nullptr;
+        size_--;
+        fired++;
+        if (timer->callback_) {
+            timer->callback_();
+        }
+    }
+    return fired;
+}
+
+size_t TimerWheel::Advance(uint64_t now_ms) {
+    uint64_t target = now_ms > base_ms_ ? now_ms - base_ms_ : 0;
+    size_t fired = 0;
+    while (current_ < target) {
+        if (size_ == 0) {
+            // 空轮直接跳到目标时刻，长时间空闲后不必逐 tick 推进
+            current_ = target;
+            break;
+        }
+        current_++;
+        size_t index = current_ & (kNearSize - 1);
+        if (index == 0) {
+            for (unsigned level = 0; level < kFarLevels; level++) {
+                size_t far_index = (current_ >> (kNearBits + level * kFarBits)) & (kFarSize - 1);
+                Cascade(level, far_index);
+                if (far_index != 0) {
+                    break;
+                }
+            }
+        }
+        fired += Fire(&near_[index]);
+    }
+    return fired;
+}
+
+int TimerWheel::NextTimeoutMs() const {
+    if (size_ == 0) {
+        return -1;
+    }
+    // 第 0 层内最近的非空槽；都为空时醒来做下一次高层迁移
+    size_t start = current_ & (kNearSize - 1);
+    size_t until_cascade = kNearSize - start;
+    for (size_t i = 1; i < until_cascade; i++) {
+        const TimerLink* slot = &near_[start + i];
+        if (slot->next != slot) {
+            return static_cast<int>(i);
+        }
+    }
+    return static_cast<int>(std::min<size_t>(until_cascade, INT_MAX));
+}
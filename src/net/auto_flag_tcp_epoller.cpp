@@ -6,3 +6,10 @@ AutoFlagTcpEpoller::AutoFlagTcpEpoller(int fd) : TcpEpoller(fd) {}
 
 AutoFlagTcpEpoller::~AutoFlagTcpEpoller() = default;
 
+void AutoFlagTcpEpoller::SetWantOut(bool want_out) {
+    if (want_out_ == want_out) {
+        return;
+    }
+    want_out_ = want_out;
+    UpdateEvents();
+}
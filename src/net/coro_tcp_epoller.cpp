@@ -0,0 +1,160 @@
+#include "../include/net/coro_tcp_epoller.h"
+#include "../include/net/flow_control.h"
+#include "../include/common/slab_allocator.h"
+#include <exception>
+
+ConnectionTask ConnectionTask::promise_type::get_return_object() noexcept {
+    return ConnectionTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+void ConnectionTask::promise_type::unhandled_exception() noexcept {
+    // 事件循环不处理异常，与回调路径中抛出异常的行为一致
+    std::terminate();
+}
+
+void* ConnectionTask::promise_type::operator new(size_t size) {
+    size_t capacity = 0;
+    void* slot = SlabAllocator::Allocate(size, &capacity);
+    // slot 头部放尺寸类别，释放时无需知道帧大小
+    *static_cast<size_t*>(slot) = capacity;
+    return static_cast<uint8_t*>(slot) + SlabAllocator::kSlotHeader;
+}
+
+void ConnectionTask::promise_type::operator delete(void* ptr) noexcept {
+    uint8_t* slot = static_cast<uint8_t*>(ptr) - SlabAllocator::kSlotHeader;
+    SlabAllocator::Deallocate(slot, *reinterpret_cast<size_t*>(slot));
+}
+
+ConnectionTask::ConnectionTask(ConnectionTask&& other) noexcept : handle_(other.handle_) {
+    other.handle_ = nullptr;
+}
+
+ConnectionTask& ConnectionTask::operator=(ConnectionTask&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            handle_.destroy();
+        }
+        handle_ = other.handle_;
+        other.handle_ = nullptr;
+    }
+    return *this;
+}
+
+ConnectionTask::~ConnectionTask() {
+    if (handle_) {
+        handle_.destroy();
+    }
+}
+
+void CoroTcpEpoller::ReadAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    handle_ = handle;
+    conn_->read_waiter_ = this;
+}
+
+std::optional<Packet> CoroTcpEpoller::ReadAwaiter::await_resume() {
+    if (result_) {
+        return std::move(result_);
+    }
+    if (conn_->inbox_.empty()) {
+        return std::nullopt;
+    }
+    std::optional<Packet> packet(std::move(conn_->inbox_.front()));
+    conn_->inbox_.pop_front();
+    return packet;
+}
+
+bool CoroTcpEpoller::SendAwaiter::await_ready() {
+    if (conn_->fd_ < 0) {
+        return true;
+    }
+    conn_->TcpEpoller::Send(std::move(packet_));
+    return !conn_->SendBlocked();
+}
+
+CoroTcpEpoller::CoroTcpEpoller(int fd, CoroHandler handler)
+    : AutoFlagTcpEpoller(fd), handler_(handler), read_waiter_(nullptr), finished_(false) {}
+
+CoroTcpEpoller::~CoroTcpEpoller() {
+    // 先销毁协程帧：帧内的局部变量可能引用本连接的成员
+    task_ = ConnectionTask();
+}
+
+void CoroTcpEpoller::OnRegistered() {
+    TcpEpoller::OnRegistered();
+    task_ = handler_(*this);
+    Resume(task_.handle());
+    // 处理函数可能先发送（如问候语），此时没有读事件会替它写出
+    if (fd_ >= 0 && !send_queue_.empty()) {
+        Out();
+    }
+}
+
+void CoroTcpEpoller::Resume(std::coroutine_handle<> handle) {
+    handle.resume();
+    if (!finished_ && task_.done()) {
+        finished_ = true;
+        if (fd_ >= 0 && send_queue_.empty() && sends_in_flight_ == 0) {
+            Close();
+        }
+    }
+}
+
+void CoroTcpEpoller::RecvImpl(Packet packet) {
+    // 协程正在等待时直接交付并就地恢复，随后的写出仍由 In() 末尾统一完成
+    if (read_waiter_) {
+        ReadAwaiter* waiter = read_waiter_;
+        read_waiter_ = nullptr;
+        waiter->result_ = std::move(packet);
+        Resume(waiter->handle_);
+        return;
+    }
+    inbox_.push_back(std::move(packet));
+}
+
+bool CoroTcpEpoller::SendBlocked() const {
+    size_t high_watermark = FlowControl::config().high_watermark;
+    return high_watermark != 0 && send_queue_bytes_ >= high_watermark;
+}
+
+void CoroTcpEpoller::ResumeSender() {
+    if (!send_waiter_ || (fd_ >= 0 && send_queue_bytes_ > FlowControl::config().low_watermark)) {
+        return;
+    }
+    std::coroutine_handle<> handle = send_waiter_;
+    send_waiter_ = nullptr;
+    Resume(handle);
+    if (fd_ >= 0 && !send_queue_.empty()) {
+        TcpEpoller::Out();
+    }
+}
+
+void CoroTcpEpoller::Out() {
+    TcpEpoller::Out();
+    ResumeSender();
+}
+
+void CoroTcpEpoller::OutCompleted(int result) {
+    TcpEpoller::OutCompleted(result);
+    ResumeSender();
+}
+
+void CoroTcpEpoller::AllSendedImpl() {
+    if (finished_ && fd_ >= 0) {
+        Close();
+    }
+}
+
+void CoroTcpEpoller::OnClosed() {
+    // 唤醒等待中的协程：ReadPacket 得到 std::nullopt，Send 返回 false
+    inbox_.clear();
+    if (read_waiter_) {
+        ReadAwaiter* waiter = read_waiter_;
+        read_waiter_ = nullptr;
+        Resume(waiter->handle_);
+    }
+    if (send_waiter_) {
+        std::coroutine_handle<> handle = send_waiter_;
+        send_waiter_ = nullptr;
+        Resume(handle);
+    }
+}
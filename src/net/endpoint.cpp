@@ -0,0 +1,280 @@
+#include "../include/net/endpoint.h"
+#include "../include/common/logger.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+bool ParsePort(const std::string& text, uint16_t* port) {
+    if (text.empty() || text.size() > 5 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    unsigned long value = std::strtoul(text.c_str(), nullptr, 10);
+    if (value > 65535) {
+        return false;
+    }
+    *port = static_cast<uint16_t>(value);
+    return true;
+}
+
+constexpr size_t kSunPathOffset = offsetof(sockaddr_un, sun_path);
+
+constexpr int kDatagramBufferSize = 4 << 20;
+
+// 路径上已有的 socket 文件：能连上说明有进程在监听，不能删除；连接被拒绝则是残留文件
+bool RemoveStaleSocketFile(const Endpoint& endpoint, const char* path) {
+    struct stat st;
+    if (stat(path, &st) < 0 || !S_ISSOCK(st.st_mode)) {
+        return true;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) {
+        return true;
+    }
+    int ret = connect(probe, endpoint.addr(), endpoint.addr_len());
+    int saved_errno = errno;
+    close(probe);
+    if (ret == 0) {
+        LOG_ERROR << "Socket " << path << " is in use by another process";
+        return false;
+    }
+    if (saved_errno == ECONNREFUSED) {
+        unlink(path);
+    }
+    return true;
+}
+
+}  // namespace
+
+Endpoint::Endpoint() : addr_{}, addr_len_(0), datagram_(false) {
+}
+
+bool Endpoint::Parse(const std::string& text, Endpoint* endpoint) {
+    if (text.compare(0, 5, "unix:") == 0) {
+        return ParseUnix(text.substr(5), endpoint);
+    }
+    if (text.compare(0, 4, "udp:") == 0) {
+        if (!Parse(text.substr(4), endpoint) || endpoint->is_unix()) {
+            return false;
+        }
+        endpoint->datagram_ = true;
+        return true;
+    }
+    
+    uint16_t port;
+    // [v6]:port
+    if (!text.empty() && text[0] == '[') {
+        size_t close = text.find("]:");
+        if (close == std::string::npos || !ParsePort(text.substr(close + 2), &port)) {
+            return false;
+        }
+        return FromHostPort(text.substr(1, close - 1).c_str(), port, endpoint) && endpoint->family() == AF_INET6;
+    }
+    
+    // 只有端口时监听所有 IPv4 地址；不带方括号的 IPv6 地址与端口无法区分，不接受
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos) {
+        return ParsePort(text, &port) && FromHostPort(nullptr, port, endpoint);
+    }
+    std::string host = text.substr(0, colon);
+    if (host.find(':') != std::string::npos || !ParsePort(text.substr(colon + 1), &port)) {
+        return false;
+    }
+    return FromHostPort(host.c_str(), port, endpoint);
+}
+
+bool Endpoint::FromHostPort(const char* host, uint16_t port, Endpoint* endpoint) {
+    *endpoint = Endpoint();
+    if (host != nullptr && strncmp(host, "unix:", 5) == 0) {
+        return ParseUnix(host + 5, endpoint);
+    }
+    
+    if (host != nullptr && strchr(host, ':') != nullptr) {
+        auto* addr = reinterpret_cast<sockaddr_in6*>(&endpoint->addr_);
+        addr->sin6_family = AF_INET6;
+        addr->sin6_port = htons(port);
+        if (inet_pton(AF_INET6, host, &addr->sin6_addr) <= 0) {
+            return false;
+        }
+        endpoint->addr_len_ = sizeof(sockaddr_in6);
+        return true;
+    }
+    
+    auto* addr = reinterpret_cast<sockaddr_in*>(&endpoint->addr_);
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    if (host == nullptr || strlen(host) == 0 || strcmp(host, "0.0.0.0") == 0) {
+        addr->sin_addr.s_addr = INADDR_ANY;
+    } else if (inet_pton(AF_INET, host, &addr->sin_addr) <= 0) {
+        return false;
+    }
+    endpoint->addr_len_ = sizeof(sockaddr_in);
+    return true;
+}
+
+bool Endpoint::ParseUnix(const std::string& path, Endpoint* endpoint) {
+    *endpoint = Endpoint();
+    auto* addr = reinterpret_cast<sockaddr_un*>(&endpoint->addr_);
+    // 抽象命名空间以 '@' 书写，地址中为首字节 '\0'，长度不含结尾 '\0'；文件系统路径需留出结尾 '\0'
+    bool abstract = !path.empty() && path[0] == '@';
+    if (path.empty() || (abstract && path.size() == 1)) {
+        return false;
+    }
+    if (path.size() + (abstract ? 0 : 1) > sizeof(addr->sun_path)) {
+        return false;
+    }
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path.data(), path.size());
+    if (abstract) {
+        addr->sun_path[0] = '\0';
+        endpoint->addr_len_ = static_cast<socklen_t>(kSunPathOffset + path.size());
+    } else {
+        endpoint->addr_len_ = static_cast<socklen_t>(kSunPathOffset + path.size() + 1);
+    }
+    return true;
+}
+
+int Endpoint::OpenListenSocket(bool reuse_port) const {
+    // 创建监听socket
+    int fd = socket(family(), SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        LOG_ERROR << "Failed to create socket for " << ToString() << ": " << strerror(errno);
+        return -1;
+    }
+    
+    int on = 1;
+    int off = 0;
+    if (is_unix()) {
+        const auto* addr = reinterpret_cast<const sockaddr_un*>(&addr_);
+        if (addr->sun_path[0] != '\0' && !RemoveStaleSocketFile(*this, addr->sun_path)) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0) {
+            LOG_ERROR << "Failed to set SO_REUSEADDR: " << strerror(errno);
+            close(fd);
+            return -1;
+        }
+        // 多 Reactor 模式：每个 Center 各自绑定同一端口，由内核在监听socket间分发连接
+        if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+            LOG_ERROR << "Failed to set SO_REUSEPORT: " << strerror(errno);
+            close(fd);
+            return -1;
+        }
+        // 双栈：不受 net.ipv6.bindv6only 默认值影响
+        if (family() == AF_INET6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) < 0) {
+            LOG_ERROR << "Failed to clear IPV6_V6ONLY: " << strerror(errno);
+            close(fd);
+            return -1;
+        }
+    }
+    
+    if (bind(fd, addr(), addr_len_) < 0) {
+        LOG_ERROR << "Failed to bind " << ToString() << ": " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    
+    // 开始监听
+    if (listen(fd, SOMAXCONN) < 0) {
+        LOG_ERROR << "Failed to listen on " << ToString() << ": " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    
+    LOG_INFO << "Listening on " << ToString();
+    return fd;
+}
+
+int Endpoint::OpenDatagramSocket(bool reuse_port) const {
+    if (is_unix()) {
+        LOG_ERROR << "Datagram sockets are only supported over UDP: " << ToString();
+        return -1;
+    }
+    int fd = socket(family(), SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        LOG_ERROR << "Failed to create socket for " << ToString() << ": " << strerror(errno);
+        return -1;
+    }
+    
+    int on = 1;
+    int off = 0;
+    // 多 Reactor 模式：每个 Center 各绑定一个，内核按对端地址哈希在它们之间分发报文
+    if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        LOG_ERROR << "Failed to set SO_REUSEPORT: " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    if (family() == AF_INET6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) < 0) {
+        LOG_ERROR << "Failed to clear IPV6_V6ONLY: " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    // 默认缓冲区只能容纳约一千个小报文，突发时直接丢包；超过 rmem_max/wmem_max 的部分由内核截断，失败不影响使用
+    int buffer_size = kDatagramBufferSize;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+    
+    if (bind(fd, addr(), addr_len_) < 0) {
+        LOG_ERROR << "Failed to bind " << ToString() << ": " << strerror(errno);
+        close(fd);
+        return -1;
+    }
+    
+    LOG_INFO << "Listening on " << ToString();
+    return fd;
+}
+
+void Endpoint::RemoveSocketFile() const {
+    if (!is_unix()) {
+        return;
+    }
+    const auto* addr = reinterpret_cast<const sockaddr_un*>(&addr_);
+    if (addr->sun_path[0] != '\0') {
+        unlink(addr->sun_path);
+    }
+}
+
+std::string Endpoint::ToString() const {
+    std::string text = datagram_ ? "udp:" : "";
+    return text + FormatAddress(addr(), addr_len_);
+}
+
+std::string Endpoint::FormatAddress(const sockaddr* addr, socklen_t addr_len) {
+    char ip_str[INET6_ADDRSTRLEN];
+    switch (addr->sa_family) {
+        case AF_INET: {
+            const auto* in = reinterpret_cast<const sockaddr_in*>(addr);
+            inet_ntop(AF_INET, &in->sin_addr, ip_str, sizeof(ip_str));
+            return std::string(ip_str) + ":" + std::to_string(ntohs(in->sin_port));
+        }
+        case AF_INET6: {
+            const auto* in6 = reinterpret_cast<const sockaddr_in6*>(addr);
+            inet_ntop(AF_INET6, &in6->sin6_addr, ip_str, sizeof(ip_str));
+            std::string text = "[";
+            text.append(ip_str).append("]:").append(std::to_string(ntohs(in6->sin6_port)));
+            return text;
+        }
+        case AF_UNIX: {
+            // accept 得到的客户端地址通常未绑定，长度只到 sun_path 之前
+            const auto* un = reinterpret_cast<const sockaddr_un*>(addr);
+            if (addr_len <= kSunPathOffset) {
+                return "unix:(unnamed)";
+            }
+            if (un->sun_path[0] == '\0') {
+                return "unix:@" + std::string(un->sun_path + 1, addr_len - kSunPathOffset - 1);
+            }
+            return "unix:" + std::string(un->sun_path, strnlen(un->sun_path, addr_len - kSunPathOffset));
+        }
+        default:
+            return "(unknown address family " + std::to_string(addr->sa_family) + ")";
+    }
+}
@@ -1,6 +1,54 @@
 #include "../include/net/epoller.h"
+#include "../include/core/center.h"
 
-Epoller::Epoller() : fd_(-1) {}
+Epoller::Epoller()
+    : fd_(-1), center_(nullptr), metrics_(DetachedMetrics()), registered_events_(0), edge_triggered_(false),
+      pending_in_(false), pending_out_(false), in_ready_list_(false), in_flush_list_(false),
+      immediate_flush_(false), async_io_(false), recv_armed_(false), priority_(IoPriority::NORMAL),
+      inflight_ops_(0) {}
 
 Epoller::~Epoller() = default;
 
+ReactorMetrics* Epoller::DetachedMetrics() {
+    static ReactorMetrics detached;
+    return &detached;
+}
+
+uint32_t Epoller::Events() const {
+    return EPOLLIN;
+}
+
+void Epoller::UpdateEvents() {
+    if (center_ && fd_ >= 0 && Events() != registered_events_) {
+        center_->UpdateEpoller(this);
+    }
+}
+
+bool Epoller::StartTimer(Timer* timer, uint64_t delay_ms) {
+    if (!center_) {
+        return false;
+    }
+    center_->timers().Arm(timer, delay_ms);
+    return true;
+}
+
+const IoBudget& Epoller::budget() const {
+    static const IoBudget kDetachedBudget;
+    return center_ ? center_->io_budget(priority_) : kDetachedBudget;
+}
+
+bool Epoller::DefersFlush() const {
+    return center_ && center_->deferred_flush() && !immediate_flush_;
+}
+
+void Epoller::ScheduleFlush() {
+    if (center_) {
+        center_->ScheduleFlush(this);
+    }
+}
+
+void Epoller::NotifyClosed(int closed_fd) {
+    if (center_) {
+        center_->OnEpollerClosed(this, closed_fd);
+    }
+}
@@ -0,0 +1,59 @@
+#include "../include/net/flow_control.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+FlowControlConfig g_config;
+
+// 所有线程已上报的待写字节数；各线程的未上报部分在 t_pending 中
+std::atomic<int64_t> g_buffered{0};
+
+// 本线程的未上报增量超过该值才更新全局计数，避免每个 Packet 一次跨核原子操作
+constexpr int64_t kFlushBytes = 64 * 1024;
+
+thread_local int64_t t_pending = 0;
+
+void Account(int64_t delta) {
+    t_pending += delta;
+    if (t_pending >= kFlushBytes || t_pending <= -kFlushBytes) {
+        g_buffered.fetch_add(t_pending, std::memory_order_relaxed);
+        t_pending = 0;
+    }
+}
+}  // namespace
+
+void FlowControl::Configure(const FlowControlConfig& config) {
+    g_config = config;
+    // 低水位不高于高水位，否则暂停后永远无法恢复
+    g_config.low_watermark = std::min(g_config.low_watermark, g_config.high_watermark);
+}
+
+const FlowControlConfig& FlowControl::config() {
+    return g_config;
+}
+
+void FlowControl::Charge(size_t bytes) {
+    // 未设置预算时不记账，快路径上只多一次比较
+    if (g_config.memory_budget != 0) {
+        Account(static_cast<int64_t>(bytes));
+    }
+}
+
+void FlowControl::Release(size_t bytes) {
+    if (g_config.memory_budget != 0) {
+        Account(-static_cast<int64_t>(bytes));
+    }
+}
+
+bool FlowControl::OverBudget() {
+    return g_config.memory_budget != 0 && BufferedBytes() > g_config.memory_budget;
+}
+
+bool FlowControl::Fits(size_t bytes) {
+    return g_config.memory_budget == 0 || BufferedBytes() + bytes <= g_config.memory_budget;
+}
+
+uint64_t FlowControl::BufferedBytes() {
+    int64_t buffered = g_buffered.load(std::memory_order_relaxed);
+    return buffered > 0 ? static_cast<uint64_t>(buffered) : 0;
+}
@@ -0,0 +1,332 @@
+#include "../include/net/shm_ring.h"
+#include "../include/common/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 一个方向的环：生产者只写 tail，消费者只写 head，各占一条缓存行；
+// 等待标志由休眠方置位、由对端在按门铃前清除
+struct ShmRing::Control {
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint32_t> consumer_sleeping;
+    std::atomic<uint32_t> producer_waiting;
+};
+
+namespace {
+
+constexpr uint32_t kLayoutMagic = 0x52494e47;
+constexpr uint32_t kLayoutVersion = 1;
+// 控制区之后从下一页开始依次是客户端到服务端、服务端到客户端的数据区
+constexpr size_t kDataOffset = 4096;
+constexpr size_t kRingFds = 3;
+
+struct SharedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+};
+
+// 两个进程通过共享内存上的原子量同步，必须免锁
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared ring needs lock-free 32-bit atomics");
+
+size_t MapSize(size_t capacity) {
+    return kDataOffset + 2 * capacity;
+}
+
+bool IsValidCapacity(uint64_t capacity) {
+    return capacity >= 4096 && (capacity & (capacity - 1)) == 0 && capacity <= (size_t(1) << 30);
+}
+
+void CloseAll(const int* fds, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+}  // namespace
+
+ShmRing::ShmRing(void* base, size_t map_size, bool server, int doorbell_fd, int peer_doorbell_fd)
+    : base_(base), map_size_(map_size), capacity_((map_size - kDataOffset) / 2), rx_(nullptr), tx_(nullptr),
+      rx_data_(nullptr), tx_data_(nullptr), rx_head_(0), tx_tail_(0), memfd_(-1), doorbell_fd_(doorbell_fd),
+      peer_doorbell_fd_(peer_doorbell_fd), read_armed_(false), write_armed_(false) {
+    Control* up = ControlAt(base, 0);
+    Control* down = ControlAt(base, 1);
+    uint8_t* up_data = static_cast<uint8_t*>(base) + kDataOffset;
+    uint8_t* down_data = up_data + capacity_;
+    rx_ = server ? up : down;
+    tx_ = server ? down : up;
+    rx_data_ = server ? up_data : down_data;
+    tx_data_ = server ? down_data : up_data;
+    rx_head_ = rx_->head.load(std::memory_order_relaxed);
+    tx_tail_ = tx_->tail.load(std::memory_order_relaxed);
+}
+
+ShmRing::Control* ShmRing::ControlAt(void* base, size_t index) {
+    static_assert(64 + 2 * sizeof(Control) <= kDataOffset, "ring control blocks must fit before the data");
+    return reinterpret_cast<Control*>(static_cast<uint8_t*>(base) + 64 + index * sizeof(Control));
+}
+
+size_t ShmRing::MapSizeFor(size_t capacity) {
+    return MapSize(capacity);
+}
+
+ShmRing::~ShmRing() {
+    munmap(base_, map_size_);
+    int fds[] = {memfd_, doorbell_fd_, peer_doorbell_fd_};
+    CloseAll(fds, kRingFds);
+}
+
+std::unique_ptr<ShmRing> ShmRing::Create(size_t capacity) {
+    if (!IsValidCapacity(capacity)) {
+        LOG_ERROR << "Invalid shared ring capacity " << capacity;
+        return nullptr;
+    }
+    size_t map_size = MapSize(capacity);
+    int fds[kRingFds] = {-1, -1, -1};
+    fds[0] = memfd_create("echo-ring", MFD_CLOEXEC);
+    if (fds[0] < 0 || ftruncate(fds[0], static_cast<off_t>(map_size)) < 0) {
+        LOG_ERROR << "Failed to create shared ring memory: " << strerror(errno);
+        CloseAll(fds, kRingFds);
+        return nullptr;
+    }
+    fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    fds[2] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fds[1] < 0 || fds[2] < 0) {
+        LOG_ERROR << "Failed to create ring doorbells: " << strerror(errno);
+        CloseAll(fds, kRingFds);
+        return nullptr;
+    }
+    // 预先建立页表，收发路径上不再缺页
+    void* base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fds[0], 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR << "Failed to map shared ring memory: " << strerror(errno);
+        CloseAll(fds, kRingFds);
+        return nullptr;
+    }
+    
+    // ftruncate 得到的内存已清零，原子量从 0 开始
+    auto* header = static_cast<SharedHeader*>(base);
+    header->magic = kLayoutMagic;
+    header->version = kLayoutVersion;
+    header->capacity = capacity;
+    for (size_t i = 0; i < 2; i++) {
+        new (ControlAt(base, i)) Control();
+    }
+    
+    std::unique_ptr<ShmRing> ring(new ShmRing(base, map_size, true, fds[1], fds[2]));
+    ring->memfd_ = fds[0];
+    return ring;
+}
+
+bool ShmRing::Offer(int socket_fd) {
+    uint8_t reply = kShmRingMagic;
+    iovec iov{&reply, 1};
+    int fds[kRingFds] = {memfd_, doorbell_fd_, peer_doorbell_fd_};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    
+    if (sendmsg(socket_fd, &msg, MSG_NOSIGNAL) != 1) {
+        LOG_WARN << "Failed to offer shared ring on fd " << socket_fd << ": " << strerror(errno);
+        return false;
+    }
+    close(memfd_);
+    memfd_ = -1;
+    return true;
+}
+
+bool ShmRing::Decline(int socket_fd) {
+    uint8_t reply = 0;
+    return send(socket_fd, &reply, 1, MSG_NOSIGNAL) == 1;
+}
+
+std::unique_ptr<ShmRing> ShmRing::Negotiate(int socket_fd) {
+    uint8_t request = kShmRingMagic;
+    if (send(socket_fd, &request, 1, MSG_NOSIGNAL) != 1) {
+        return nullptr;
+    }
+    
+    uint8_t reply = 0;
+    iovec iov{&reply, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(kRingFds * sizeof(int))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    
+    int fds[kRingFds] = {-1, -1, -1};
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    bool has_fds = n == 1 && cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+                   cmsg->cmsg_len == CMSG_LEN(sizeof(fds)) && !(msg.msg_flags & MSG_CTRUNC);
+    if (has_fds) {
+        std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+    if (n != 1 || reply != kShmRingMagic || !has_fds) {
+        CloseAll(fds, kRingFds);
+        if (n == 1 && reply == 0) {
+            LOG_INFO << "Server declined shared ring on fd " << socket_fd;
+        } else {
+            LOG_WARN << "Invalid shared ring reply on fd " << socket_fd;
+        }
+        return nullptr;
+    }
+    
+    // 按服务端写入的容量映射，先核对文件大小
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fds[0], &st) == 0 && static_cast<size_t>(st.st_size) >= kDataOffset) {
+        size_t map_size = static_cast<size_t>(st.st_size);
+        base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fds[0], 0);
+        if (base != MAP_FAILED) {
+            const auto* header = static_cast<const SharedHeader*>(base);
+            if (header->magic != kLayoutMagic || header->version != kLayoutVersion ||
+                !IsValidCapacity(header->capacity) || MapSize(header->capacity) != map_size) {
+                munmap(base, map_size);
+                base = MAP_FAILED;
+            }
+        }
+    }
+    if (base == MAP_FAILED) {
+        LOG_WARN << "Unusable shared ring memory on fd " << socket_fd;
+        CloseAll(fds, kRingFds);
+        return nullptr;
+    }
+    close(fds[0]);
+    // 服务端发来的顺序为 memfd、服务端门铃、客户端门铃
+    return std::unique_ptr<ShmRing>(new ShmRing(base, static_cast<size_t>(st.st_size), false, fds[2], fds[1]));
+}
+
+ssize_t ShmRing::Write(const iovec* iov, size_t count) {
+    // head 在对端可写的内存中：超出 [tx_tail_ - capacity_, tx_tail_] 时按协议错误处理，否则空间计算会下溢、复制越界
+    uint64_t used = tx_tail_ - tx_->head.load(std::memory_order_acquire);
+    if (used > capacity_) {
+        errno = EPROTO;
+        return -1;
+    }
+    size_t space = capacity_ - static_cast<size_t>(used);
+    size_t written = 0;
+    for (size_t i = 0; i < count && space > 0; i++) {
+        size_t length = std::min(iov[i].iov_len, space);
+        size_t offset = static_cast<size_t>(tx_tail_ + written) & (capacity_ - 1);
+        size_t first = std::min(length, capacity_ - offset);
+        const uint8_t* source = static_cast<const uint8_t*>(iov[i].iov_base);
+        std::memcpy(tx_data_ + offset, source, first);
+        std::memcpy(tx_data_, source + first, length - first);
+        written += length;
+        space -= length;
+    }
+    if (written == 0) {
+        return 0;
+    }
+    
+    // 发布与读取对端休眠标志之间必须是 StoreLoad 顺序，与 ArmReadable 配对，否则双方可能都在等待
+    tx_tail_ += written;
+    tx_->tail.store(tx_tail_, std::memory_order_seq_cst);
+    if (tx_->consumer_sleeping.load(std::memory_order_seq_cst) != 0 &&
+        tx_->consumer_sleeping.exchange(0, std::memory_order_acq_rel) != 0) {
+        RingPeer();
+    }
+    return static_cast<ssize_t>(written);
+}
+
+ssize_t ShmRing::Read(void* data, size_t length) {
+    // 同理校验对端发布的 tail：可读字节数不能超过环容量
+    uint64_t available = rx_->tail.load(std::memory_order_acquire) - rx_head_;
+    if (available > capacity_) {
+        errno = EPROTO;
+        return -1;
+    }
+    length = std::min(length, static_cast<size_t>(available));
+    if (length == 0) {
+        return 0;
+    }
+    size_t offset = static_cast<size_t>(rx_head_) & (capacity_ - 1);
+    size_t first = std::min(length, capacity_ - offset);
+    uint8_t* target = static_cast<uint8_t*>(data);
+    std::memcpy(target, rx_data_ + offset, first);
+    std::memcpy(target + first, rx_data_, length - first);
+    
+    rx_head_ += length;
+    rx_->head.store(rx_head_, std::memory_order_seq_cst);
+    if (rx_->producer_waiting.load(std::memory_order_seq_cst) != 0 &&
+        rx_->producer_waiting.exchange(0, std::memory_order_acq_rel) != 0) {
+        RingPeer();
+    }
+    return static_cast<ssize_t>(length);
+}
+
+bool ShmRing::Readable() const {
+    return rx_->tail.load(std::memory_order_acquire) != rx_head_;
+}
+
+bool ShmRing::ArmReadable() {
+    rx_->consumer_sleeping.store(1, std::memory_order_seq_cst);
+    read_armed_ = true;
+    if (rx_->tail.load(std::memory_order_seq_cst) != rx_head_) {
+        Disarm();
+        return false;
+    }
+    return true;
+}
+
+bool ShmRing::ArmWritable() {
+    tx_->producer_waiting.store(1, std::memory_order_seq_cst);
+    write_armed_ = true;
+    // 环未满，或对端写坏了 head（由随后的 Write 报错），都不能休眠
+    if (tx_tail_ - tx_->head.load(std::memory_order_seq_cst) != capacity_) {
+        Disarm();
+        return false;
+    }
+    return true;
+}
+
+void ShmRing::Disarm() {
+    // 只在置位过时写共享标志，轮询时不反复弄脏对端也在读的缓存行
+    if (read_armed_) {
+        rx_->consumer_sleeping.store(0, std::memory_order_relaxed);
+        read_armed_ = false;
+    }
+    if (write_armed_) {
+        tx_->producer_waiting.store(0, std::memory_order_relaxed);
+        write_armed_ = false;
+    }
+}
+
+uint64_t ShmRing::DrainDoorbell() {
+    uint64_t count = 0;
+    if (read(doorbell_fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+        return 0;
+    }
+    return count;
+}
+
+void ShmRing::RingPeer() {
+    uint64_t one = 1;
+    // 计数溢出前对端早已醒来；对端已退出时写入无害
+    ssize_t ignored = write(peer_doorbell_fd_, &one, sizeof(one));
+    (void)ignored;
+}
@@ -1,196 +1,943 @@
 #include "../include/net/tcp_epoller.h"
 #include "../include/common/packet.h"
 #include "../include/common/packet_header.h"
-#include <iostream>
+#include "../include/core/center.h"
+#include "../include/common/logger.h"
+#include "../include/common/crc32c.h"
+#include "../include/core/metrics.h"
+#include "../include/net/flow_control.h"
 #include <unistd.h>
-#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <algorithm>
 #include <cstring>
 #include <cerrno>
+#include <utility>
 
-TcpEpoller::TcpEpoller() : Epoller(), want_out_(false), read_state_(READING_HEADER), pending_data_read_(0) {
+TcpEpoller::TcpEpoller() : Epoller(), send_offset_(0), want_out_(false), send_queue_bytes_(0), read_paused_(false), wire_format_(&WireFormat::Native()),
+      negotiable_format_(nullptr), checksum_(false), negotiable_checksum_(false), negotiable_ring_(false),
+      offload_next_seq_(0), offload_emit_seq_(0), offload_parked_bytes_(0),
+      read_state_(READING_HEADER), decode_paused_(false), pending_header_(), pending_header_bytes_(), pending_header_size_(0), pending_crc_(0), crc_offset_(0),
+      recv_charged_(0), last_read_ns_(0), sends_in_flight_(0), close_after_send_(false), idle_timer_([this]() { OnIdleTimer(); }),
+      read_timer_([this]() { OnReadTimer(); }), write_timer_([this]() { OnWriteTimer(); }),
+      budget_timer_([this]() { OnBudgetTimer(); }), budget_stalled_ms_(0), activity_(0), frames_in_(0),
+      bytes_written_(0), idle_seen_(0), read_seen_(0), write_seen_(0) {
     fd_ = -1;
 }
 
-TcpEpoller::TcpEpoller(int fd) : Epoller(), want_out_(false), read_state_(READING_HEADER), pending_data_read_(0) {
+TcpEpoller::TcpEpoller(int fd) : Epoller(), send_offset_(0), want_out_(false), send_queue_bytes_(0), read_paused_(false), wire_format_(&WireFormat::Native()),
+      negotiable_format_(nullptr), checksum_(false), negotiable_checksum_(false), negotiable_ring_(false),
+      offload_next_seq_(0), offload_emit_seq_(0), offload_parked_bytes_(0),
+      read_state_(READING_HEADER), decode_paused_(false), pending_header_(), pending_header_bytes_(), pending_header_size_(0), pending_crc_(0), crc_offset_(0),
+      recv_charged_(0), last_read_ns_(0), sends_in_flight_(0), close_after_send_(false), idle_timer_([this]() { OnIdleTimer(); }),
+      read_timer_([this]() { OnReadTimer(); }), write_timer_([this]() { OnWriteTimer(); }),
+      budget_timer_([this]() { OnBudgetTimer(); }), budget_stalled_ms_(0), activity_(0), frames_in_(0),
+      bytes_written_(0), idle_seen_(0), read_seen_(0), write_seen_(0) {
     fd_ = fd;
 }
 
-TcpEpoller::~TcpEpoller() = default;
+TcpEpoller::~TcpEpoller() {
+    StopRing();
+    // 异步发送在途时 Close() 保留了队列，这里才真正出队
+    metrics().send_queue_depth.Sub(send_queue_.size());
+    metrics().send_queue_bytes.Sub(send_queue_bytes_);
+    FlowControl::Release(send_queue_bytes_);
+    FlowControl::Release(recv_charged_);
+}
+
+namespace {
+// 每次读之前接收缓冲区至少保证的可写空间，读入的负载直接被切片交给 RecvImpl
+constexpr size_t kMinReadSize = 16384;
+
+// 单次 readv 的栈上溢出缓冲区大小：接收缓冲区剩余空间不足时先读到这里再追加，
+// 保证一次系统调用也能读走大量流水线小包
+constexpr size_t kExtraReadSize = 65536;
+
+// 负载未收全时预留的空间不超过 max(已收到的字节数 × kFrameReserveFactor, kMinFrameReserve)：
+// 缓冲区随实际收到的数据成倍增长，而不是按包头声明的长度一次分配；倍数取大，大帧只扩容两三次
+constexpr size_t kMinFrameReserve = 256 * 1024;
+constexpr size_t kFrameReserveFactor = 8;
+
+// 因预算暂停读取期间复查的周期（毫秒）
+constexpr uint32_t kBudgetRecheckMs = 10;
+
+// 单次 sendmsg 最多聚合的 iovec 数（每个 Packet 占包头、负载两项，启用校验时再加尾部一项）
+constexpr size_t kMaxSendIov = 64;
+
+// FillSendIov 中每帧的暂存槽：编码后的包头与校验尾部
+constexpr size_t kFrameScratchSize = kMaxWireHeaderSize + kChecksumSize;
+
+// 完成式后端一次最多链接提交的 sendmsg 数
+constexpr size_t kMaxLinkedSends = 4;
+}
+
+size_t TcpEpoller::WireFrameSize(const Packet& packet) const {
+    size_t header_size = wire_format_->host_layout ? sizeof(PacketHeader) : wire_format_->encoded_size(packet.header());
+    return header_size + packet.data().length() + (checksum_ ? kChecksumSize : 0);
+}
 
 void TcpEpoller::ResetReadState() {
     read_state_ = READING_HEADER;
-    pending_data_.clear();
-    pending_data_read_ = 0;
+    pending_header_ = PacketHeader{};
+    pending_header_size_ = 0;
+    pending_crc_ = 0;
+    crc_offset_ = 0;
 }
 
-void TcpEpoller::In() {
-    if (fd_ < 0) {
-        return;
+ssize_t TcpEpoller::ReadSocket(size_t max_bytes) {
+    if (ring_) {
+        return ReadRing(max_bytes);
     }
+    uint8_t extra[kExtraReadSize];
+    recv_buffer_.EnsureWritable(kMinReadSize);
+    iovec iov[2];
+    // 为大帧预留的缓冲区可能有几 MB，一次读入量同样受预算限制
+    size_t writable = std::min(recv_buffer_.WritableBytes(), max_bytes);
+    iov[0].iov_base = recv_buffer_.BeginWrite();
+    iov[0].iov_len = writable;
+    iov[1].iov_base = extra;
+    iov[1].iov_len = std::min(sizeof(extra), max_bytes - writable);
     
-    std::cout << "TcpEpoller::In() called on fd: " << fd_ << ", state=" << (read_state_ == READING_HEADER ? "HEADER" : "DATA") << std::endl;
+    ssize_t n = readv(fd_, iov, 2);
+    if (n <= 0) {
+        return n;
+    }
+    last_read_ns_ = MonotonicNs();
+    metrics().bytes_in.Add(static_cast<uint64_t>(n));
     
-    // 根据状态读取包头或数据
-    if (read_state_ == READING_HEADER) {
-        // 读取包头
-        PacketHeader header;
-        size_t header_read = 0;
-        uint8_t* header_buf = reinterpret_cast<uint8_t*>(&header);
-        
-        while (header_read < sizeof(header)) {
-            ssize_t n = recv(fd_, header_buf + header_read, sizeof(header) - header_read, 0);
-            
-            if (n <= 0) {
-                if (n == 0) {
-                    std::cout << "Connection closed by peer on fd: " << fd_ << std::endl;
-                    Close();
-                    return;
-                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    std::cout << "Read header would block, waiting for more data (got " << header_read << "/" << sizeof(header) << " bytes)" << std::endl;
-                    return;
-                } else {
-                    std::cerr << "Read header error on fd " << fd_ << ": " << strerror(errno) << std::endl;
+    if (static_cast<size_t>(n) <= writable) {
+        recv_buffer_.HasWritten(n);
+    } else {
+        recv_buffer_.HasWritten(writable);
+        recv_buffer_.Append(extra, n - writable);
+    }
+    return n;
+}
+
+size_t TcpEpoller::DecodeFrames(size_t max_packets) {
+    size_t delivered = 0;
+    decode_paused_ = false;
+    // 首字节协商：连接开头的 magic 字节依次选择帧格式、启用校验尾部，遇到其他字节即结束
+    while ((negotiable_format_ || negotiable_checksum_ || negotiable_ring_) && recv_buffer_.ReadableBytes() > 0) {
+        uint8_t first = *recv_buffer_.Peek();
+        bool start_ring = false;
+        if (negotiable_ring_ && first == kShmRingMagic) {
+            negotiable_ring_ = false;
+            start_ring = true;
+        } else if (negotiable_format_ && first == negotiable_format_->magic) {
+            LOG_DEBUG << "fd " << fd_ << " negotiated wire format " << negotiable_format_->name;
+            wire_format_ = negotiable_format_;
+            negotiable_format_ = nullptr;
+        } else if (negotiable_checksum_ && first == kChecksumMagic) {
+            LOG_DEBUG << "fd " << fd_ << " negotiated frame checksums";
+            checksum_ = true;
+            negotiable_checksum_ = false;
+        } else {
+            negotiable_format_ = nullptr;
+            negotiable_checksum_ = false;
+            negotiable_ring_ = false;
+            break;
+        }
+        recv_buffer_.Retrieve(1);
+        // 之后的字节（包括其余 magic）都从环中读入
+        if (start_ring && !StartRing()) {
+            return delivered;
+        }
+    }
+    
+    // RecvImpl 中可能 Close()，每轮都检查 fd_
+    while (fd_ >= 0) {
+        if (delivered >= max_packets) {
+            // 余下的帧留在缓冲区中，下一次 In() 先处理它们再读
+            decode_paused_ = true;
+            break;
+        }
+        if (read_state_ == READING_HEADER) {
+            // 默认格式与结构体布局相同，直接复制；其他格式交给编译期生成的解码函数
+            size_t header_size = sizeof(PacketHeader);
+            if (wire_format_->host_layout) {
+                if (recv_buffer_.ReadableBytes() < sizeof(PacketHeader)) {
+                    break;
+                }
+                std::memcpy(&pending_header_, recv_buffer_.Peek(), sizeof(PacketHeader));
+            } else {
+                int decoded = wire_format_->decode(recv_buffer_.Peek(), recv_buffer_.ReadableBytes(), &pending_header_);
+                if (decoded == 0) {
+                    break;
+                }
+                if (decoded < 0) {
+                    LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Malformed " << wire_format_->name << " header on fd " << fd_;
                     Close();
-                    return;
+                    return delivered;
                 }
+                header_size = static_cast<size_t>(decoded);
+            }
+            if (checksum_) {
+                // 尾部最后才覆盖包头，先留一份线上字节
+                std::memcpy(pending_header_bytes_, recv_buffer_.Peek(), header_size);
+                pending_header_size_ = header_size;
+            }
+            size_t max_frame = FlowControl::config().max_frame_length;
+            if (max_frame != 0 && pending_header_.length > max_frame) {
+                LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Frame too large on fd " << fd_ << ": length=" << pending_header_.length
+                                                     << ", limit=" << max_frame;
+                Close();
+                return delivered;
+            }
+            recv_buffer_.Retrieve(header_size);
+            read_state_ = READING_DATA;
+            size_t bulk_bytes = GetCenter() ? GetCenter()->bulk_frame_bytes() : 0;
+            if (bulk_bytes != 0 && pending_header_.length >= bulk_bytes && priority() != IoPriority::BULK) {
+                LOG_DEBUG << "fd " << fd_ << " classified as bulk: frame length " << pending_header_.length;
+                SetPriority(IoPriority::BULK);
             }
             
-            header_read += n;
+            LOG_TRACE << "Read header: command=" << pending_header_.command << ", length=" << pending_header_.length;
         }
         
-        std::cout << "Read header: command=" << header.command << ", length=" << header.length << std::endl;
+        size_t length = pending_header_.length;
+        size_t frame_rest = length;
+        if (checksum_) {
+            // 校验与解帧合并：每批读入的负载趁刚写入缓存时累计进 CRC，不在帧收全后再整体读一遍
+            size_t covered = std::min(recv_buffer_.ReadableBytes(), length);
+            if (covered > crc_offset_) {
+                pending_crc_ = Crc32c(pending_crc_, recv_buffer_.Peek() + crc_offset_, covered - crc_offset_);
+                crc_offset_ = covered;
+            }
+            frame_rest += kChecksumSize;
+        }
+        if (recv_buffer_.ReadableBytes() < frame_rest) {
+            // 负载未收全：预留空间让下一次 readv 直接读进缓冲区，大帧按已收到的字节数逐步扩大
+            // 超出内存预算时不再成倍预留，缓冲区只随实际读入增长
+            size_t readable = recv_buffer_.ReadableBytes();
+            size_t reserve = FlowControl::OverBudget() ? kMinReadSize : std::max(readable * kFrameReserveFactor, kMinFrameReserve);
+            recv_buffer_.EnsureWritable(std::min(frame_rest - readable, reserve));
+            break;
+        }
+        if (checksum_ && !VerifyChecksum(length)) {
+            return delivered;
+        }
         
-        // 保存包头，准备读取数据
-        pending_header_ = header;
-        if (header.length > 0) {
-            pending_data_.resize(header.length);
-            pending_data_read_ = 0;
-            read_state_ = READING_DATA;
-        } else {
-            // 空数据包，直接处理
-            Data empty_data;
-            Packet packet(header, std::move(empty_data));
-            RecvImpl(std::move(packet));
-            ResetReadState();
+        // 创建Packet并调用RecvImpl：负载是接收缓冲区的切片，不复制
+        Packet packet(pending_header_, recv_buffer_.Take(length));
+        if (checksum_) {
+            recv_buffer_.Retrieve(kChecksumSize);
+            packet.set_payload_crc(pending_crc_);
+        }
+        packet.set_received_ns(last_read_ns_);
+        metrics().packets_in.Add(1);
+        
+        // 重置状态，准备读取下一个包
+        ResetReadState();
+        frames_in_++;
+        delivered++;
+        RecvImpl(std::move(packet));
+    }
+    return delivered;
+}
+
+bool TcpEpoller::VerifyChecksum(size_t length) {
+    uint32_t expected = wire::Load<4, ByteOrder::LITTLE>(recv_buffer_.Peek() + length);
+    uint32_t actual = Crc32c(pending_crc_, pending_header_bytes_, pending_header_size_);
+    if (actual == expected) {
+        return true;
+    }
+    // 帧边界也可能已被破坏，无法跳过这一帧继续解析
+    metrics().checksum_errors.Add(1);
+    LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Checksum mismatch on fd " << fd_ << ": command=" << pending_header_.command
+                                         << ", length=" << length;
+    Close();
+    return false;
+}
+
+void TcpEpoller::ChargeRecvBuffer() {
+    size_t held = recv_buffer_.ReadableBytes();
+    if (held > recv_charged_) {
+        FlowControl::Charge(held - recv_charged_);
+    } else if (held < recv_charged_) {
+        FlowControl::Release(recv_charged_ - held);
+    }
+    recv_charged_ = held;
+}
+
+void TcpEpoller::In() {
+    if (fd_ < 0) {
+        return;
+    }
+    if (ring_) {
+        // 不在就绪列表中说明是门铃唤醒，清空计数；醒着时撤销等待标志，对端不必再按门铃
+        if (!HasPendingIn()) {
+            metrics().ring_doorbells.Add(ring_->DrainDoorbell());
+        }
+        ring_->Disarm();
+        // 门铃也可能表示对端腾出了空间
+        if (want_out_) {
             Out();
-            return;
+            if (fd_ < 0) {
+                return;
+            }
         }
     }
+    SetPendingIn(false);
+    // 暂停读取前已取出的可读事件
+    if (read_paused_) {
+        return;
+    }
     
-    // 读取数据
-    if (read_state_ == READING_DATA) {
-        while (pending_data_read_ < pending_data_.size()) {
-            ssize_t n = recv(fd_, pending_data_.data() + pending_data_read_, 
-                           pending_data_.size() - pending_data_read_, 0);
-            
-            if (n <= 0) {
-                if (n == 0) {
-                    std::cout << "Connection closed while reading data on fd: " << fd_ << std::endl;
-                    Close();
-                    return;
-                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    std::cout << "Read data would block, waiting for more data (got " << pending_data_read_ << "/" << pending_data_.size() << " bytes)" << std::endl;
-                    return;
-                } else {
-                    std::cerr << "Read data error on fd " << fd_ << ": " << strerror(errno) << std::endl;
-                    Close();
-                    return;
+    LOG_TRACE << "TcpEpoller::In() called on fd: " << fd_ << ", state=" << (read_state_ == READING_HEADER ? "HEADER" : "DATA");
+    
+    // 每次调度的读入字节数与解出的帧数受预算（见 IoBudget）限制，用完即让出，由 Center 的就绪列表续读。
+    // 水平触发：每次可读事件只做一次 readv，socket 中剩余的数据由下一轮事件继续读取；
+    // 边沿触发：循环读到 EAGAIN 或预算用尽
+    const IoBudget& budget = this->budget();
+    size_t bytes_read = 0;
+    size_t packets = 0;
+    bool peer_closed = false;
+    // 上次因帧数预算留在缓冲区中的完整帧先处理，处理完之前不再读入
+    if (decode_paused_) {
+        packets += DecodeFrames(budget.packets);
+    }
+    while (fd_ >= 0 && !decode_paused_) {
+        ssize_t n = ReadSocket(budget.bytes - bytes_read);
+        if (n == 0) {
+            LOG_DEBUG << "Connection closed by peer on fd: " << fd_;
+            peer_closed = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!ring_) {
+                    metrics().read_eagain.Add(1);
                 }
+                break;
             }
-            
-            pending_data_read_ += n;
+            LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Read error on fd " << fd_ << ": " << strerror(errno);
+            Close();
+            return;
         }
         
-        std::cout << "Read complete data: " << pending_data_read_ << " bytes" << std::endl;
-        
-        // 创建Packet并调用RecvImpl
-        Data data(pending_data_.data(), pending_data_.size());
-        Packet packet(pending_header_, std::move(data));
-        RecvImpl(std::move(packet));
+        // 解出缓冲区内的完整帧；不完整的包头/负载留在缓冲区等待后续数据
+        activity_++;
+        packets += DecodeFrames(budget.packets - packets);
+        bytes_read += n;
         
-        // 重置状态，准备读取下一个包
-        ResetReadState();
-        
-        // 尝试立即发送
+        // 环没有可读事件可依赖，与边沿触发一样读空为止
+        if (fd_ < 0 || decode_paused_ || (!IsEdgeTriggered() && !ring_)) {
+            break;
+        }
+        if (bytes_read >= budget.bytes) {
+            metrics().budget_yields.Add(1);
+            SetPendingIn(true);
+            break;
+        }
+    }
+    if (fd_ < 0) {
+        return;
+    }
+    if (decode_paused_) {
+        metrics().budget_yields.Add(1);
+        SetPendingIn(true);
+    }
+    
+    // 尝试立即发送（延迟写出模式下由 Center 在本轮末尾统一写出），写不完时按积压量决定是否暂停读取
+    if (!DefersFlush()) {
+        Out();
+    }
+    UpdateReadPause();
+    OnReadProgress();
+    
+    // 帧已全部取走时归还接收缓冲区，空闲连接不占用内存
+    recv_buffer_.ReleaseIfEmpty();
+    ChargeRecvBuffer();
+    
+    if (ring_ && fd_ >= 0 && !HasPendingIn()) {
+        IdleRing();
+    }
+    if (peer_closed) {
+        Close();
+    }
+}
+
+uint32_t TcpEpoller::Events() const {
+    if (ring_) {
+        // 数据由门铃驱动，socket 上只等对端关闭
+        return EPOLLRDHUP;
+    }
+    uint32_t events = read_paused_ ? 0u : static_cast<uint32_t>(EPOLLIN);
+    return want_out_ ? (events | EPOLLOUT) : events;
+}
+
+void TcpEpoller::UpdateReadPause() {
+    if (fd_ < 0) {
+        return;
+    }
+    const FlowControlConfig& config = FlowControl::config();
+    // 先同步接收缓冲区的记账，本次读入的字节也参与预算判断
+    ChargeRecvBuffer();
+    // 超出进程预算时只暂停确有积压的连接，正常收发的连接不受影响
+    // 排在未完成卸载之后的应答同样算作积压，否则流水线请求会在其后无限堆积；
+    // 未收全的帧占用的接收缓冲区也算，否则慢慢送来大帧的连接在预算耗尽后仍会继续扩大缓冲区
+    size_t queued_bytes = send_queue_bytes_ + offload_parked_bytes_;
+    bool over_budget = queued_bytes + recv_charged_ >= config.budget_pause_bytes && FlowControl::OverBudget();
+    bool paused = over_budget;
+    if (config.high_watermark != 0) {
+        size_t mark = read_paused_ ? config.low_watermark : config.high_watermark;
+        paused = paused || (read_paused_ ? queued_bytes > mark : queued_bytes >= mark);
+    }
+    if (paused && !budget_timer_.IsArmed() && config.memory_budget != 0) {
+        StartTimer(&budget_timer_, kBudgetRecheckMs);
+    }
+    if (paused == read_paused_) {
+        return;
+    }
+    
+    read_paused_ = paused;
+    if (paused) {
+        metrics().read_pauses.Add(1);
+        LOG_DEBUG << "Read paused on fd " << fd_ << ", queued bytes: " << queued_bytes << ", receive buffer: " << recv_charged_;
+    } else if (IsEdgeTriggered() || ring_ || decode_paused_) {
+        // 暂停期间到达的数据不会再产生边沿（环则没有门铃），缓冲区中也可能还有未处理的帧，交给就绪列表读取
+        SetPendingIn(true);
+    }
+    UpdateEvents();
+}
+
+void TcpEpoller::InData(const void* data, size_t length) {
+    if (fd_ < 0) {
+        return;
+    }
+    
+    if (length == 0) {
+        LOG_DEBUG << "Connection closed by peer on fd: " << fd_;
+        // 已入队的回射写完后再关闭
+        if (send_queue_.empty() && sends_in_flight_ == 0) {
+            Close();
+        } else {
+            close_after_send_ = true;
+        }
+        return;
+    }
+    
+    // 后端的接收缓冲区需要立即归还，这里复制进本连接的接收缓冲区后解帧
+    last_read_ns_ = MonotonicNs();
+    metrics().bytes_in.Add(length);
+    activity_++;
+    recv_buffer_.Append(data, length);
+    DecodeFrames(SIZE_MAX);
+    if (!DefersFlush()) {
         Out();
     }
+    UpdateReadPause();
+    OnReadProgress();
+    recv_buffer_.ReleaseIfEmpty();
+    ChargeRecvBuffer();
+}
+
+size_t TcpEpoller::FillSendIov(size_t* index, size_t skip, iovec* iov, size_t max_iov, size_t* bytes, uint8_t* headers) {
+    size_t iov_count = 0;
+    size_t frame_iovs = checksum_ ? 3 : 2;
+    *bytes = 0;
+    
+    auto append = [&](uint8_t* base, size_t length) {
+        // skip 落在本段之内时从中间续写，整段已写出时跳过
+        if (skip < length) {
+            iov[iov_count].iov_base = base + skip;
+            iov[iov_count].iov_len = length - skip;
+            *bytes += iov[iov_count].iov_len;
+            iov_count++;
+            skip = 0;
+        } else {
+            skip -= length;
+        }
+    };
+    
+    for (size_t slot = 0; *index < send_queue_.size() && iov_count + frame_iovs <= max_iov && slot < max_iov / 2; ++*index, ++slot) {
+        Packet& packet = send_queue_[*index];
+        uint32_t payload_crc = packet.payload_crc();
+        uint8_t* scratch = headers + slot * kFrameScratchSize;
+        uint8_t* header_bytes = reinterpret_cast<uint8_t*>(&packet.header());
+        size_t header_size = sizeof(PacketHeader);
+        if (!wire_format_->host_layout) {
+            // 编码结果只取决于包头，短写后重新编码得到相同的字节
+            header_bytes = scratch;
+            header_size = wire_format_->encode(packet.header(), header_bytes);
+        }
+        append(header_bytes, header_size);
+        append(static_cast<uint8_t*>(packet.data().ptr()), packet.data().length());
+        if (checksum_) {
+            // 负载部分已在入队时算好，这里只续上不超过 kMaxWireHeaderSize 字节的包头
+            uint8_t* trailer = scratch + kMaxWireHeaderSize;
+            wire::Store<4, ByteOrder::LITTLE>(trailer, Crc32c(payload_crc, header_bytes, header_size));
+            append(trailer, kChecksumSize);
+        }
+    }
+    return iov_count;
+}
+
+void TcpEpoller::AdvanceSendQueue(size_t n) {
+    // 弹出已完整写出的 Packet，剩余字节记入 send_offset_
+    size_t written = n + send_offset_;
+    ReactorMetrics& stats = metrics();
+    stats.bytes_out.Add(n);
+    activity_++;
+    bytes_written_ += n;
+    uint64_t now = 0;
+    uint64_t popped = 0;
+    size_t popped_bytes = 0;
+    while (!send_queue_.empty()) {
+        const Packet& front = send_queue_.front();
+        size_t packet_size = WireFrameSize(front);
+        if (written < packet_size) {
+            break;
+        }
+        written -= packet_size;
+        popped_bytes += packet_size;
+        // 本批写完的帧共用一次取时
+        if (front.received_ns() != 0) {
+            if (now == 0) {
+                now = MonotonicNs();
+            }
+            stats.echo_latency_ns.Record(now - front.received_ns());
+        }
+        send_queue_.pop_front();
+        popped++;
+    }
+    send_offset_ = written;
+    stats.packets_out.Add(popped);
+    stats.send_queue_depth.Sub(popped);
+    stats.send_queue_bytes.Sub(popped_bytes);
+    send_queue_bytes_ -= popped_bytes;
+    FlowControl::Release(popped_bytes);
+    if (read_paused_) {
+        UpdateReadPause();
+    }
 }
 
 void TcpEpoller::Out() {
-    if (fd_ < 0 || send_queue_.empty()) {
-        want_out_ = false;
+    if (fd_ < 0) {
+        return;
+    }
+    if (IsAsyncIo()) {
+        OutAsync();
+        return;
+    }
+    SetPendingOut(false);
+    if (send_queue_.empty()) {
+        SetWantOut(false);
         return;
     }
     
-    std::cout << "TcpEpoller::Out() called on fd: " << fd_ << ", queue size: " << send_queue_.size() << std::endl;
+    LOG_TRACE << "TcpEpoller::Out() called on fd: " << fd_ << ", queue size: " << send_queue_.size();
     
+    size_t bytes_sent = 0;
     while (!send_queue_.empty()) {
-        Packet& packet = send_queue_.front();
+        // 预算用尽时交给就绪列表续写：边沿触发下没有 EAGAIN 就不会再有可写事件，水平触发下也不让一个连接独占本轮
+        if (bytes_sent >= budget().bytes) {
+            metrics().budget_yields.Add(1);
+            SetPendingOut(true);
+            return;
+        }
+        
+        // 从队首开始聚合多个 Packet 的包头与负载，跳过队首已写出的部分
+        iovec iov[kMaxSendIov];
+        uint8_t headers[kMaxSendIov / 2 * kFrameScratchSize];
+        size_t index = 0;
+        size_t batch_bytes = 0;
+        size_t iov_count = FillSendIov(&index, send_offset_, iov, kMaxSendIov, &batch_bytes, headers);
         
-        // 发送包头
-        ssize_t n = send(fd_, &packet.header(), sizeof(packet.header()), MSG_NOSIGNAL);
+        ssize_t n;
+        if (ring_) {
+            n = ring_->Write(iov, iov_count);
+            if (n == 0) {
+                n = -1;
+                errno = EAGAIN;
+            }
+        } else {
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iov_count;
+            n = sendmsg(fd_, &msg, MSG_NOSIGNAL);
+        }
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 暂时无法发送，保持want_out_
+                // 暂时无法发送，等待可写事件（环则等对端腾出空间后按门铃）
+                metrics().write_eagain.Add(1);
+                SetWantOut(true);
+                if (ring_ && !ring_->ArmWritable()) {
+                    SetPendingOut(true);
+                }
                 return;
             }
-            std::cerr << "Send header error on fd " << fd_ << ": " << strerror(errno) << std::endl;
+            LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Send error on fd " << fd_ << ": " << strerror(errno);
             Close();
             return;
         }
         
-        if (static_cast<size_t>(n) < sizeof(packet.header())) {
-            // 部分发送，保持want_out_
-            return;
-        }
+        bytes_sent += static_cast<size_t>(n);
+        AdvanceSendQueue(static_cast<size_t>(n));
         
-        // 发送数据
-        if (packet.data().length() > 0) {
-            n = send(fd_, packet.data().ptr(), packet.data().length(), MSG_NOSIGNAL);
-            if (n < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return;
-                }
-                std::cerr << "Send data error on fd " << fd_ << ": " << strerror(errno) << std::endl;
-                Close();
-                return;
-            }
-            
-            if (static_cast<size_t>(n) < packet.data().length()) {
-                // 部分发送，保持want_out_
-                return;
+        if (static_cast<size_t>(n) < batch_bytes) {
+            // 部分发送，等待可写事件后从 send_offset_ 续写
+            metrics().write_eagain.Add(1);
+            SetWantOut(true);
+            if (ring_ && !ring_->ArmWritable()) {
+                SetPendingOut(true);
             }
+            return;
         }
-        
-        // 成功发送一个完整的包
-        send_queue_.pop();
     }
     
-    // 队列为空
-    want_out_ = false;
+    // 队列为空，撤销写关注
+    SetWantOut(false);
     
     // 调用AllSended回调
     AllSendedImpl();
 }
 
+void TcpEpoller::OutAsync() {
+    // 同一时刻只保留一组在途发送，完成后再提交后续数据
+    if (sends_in_flight_ > 0 || send_queue_.empty()) {
+        return;
+    }
+    
+    async_iov_.resize(kMaxLinkedSends * kMaxSendIov);
+    async_msgs_.assign(kMaxLinkedSends, msghdr{});
+    if (!wire_format_->host_layout || checksum_) {
+        async_headers_.resize(kMaxLinkedSends * kMaxSendIov / 2 * kFrameScratchSize);
+    }
+    
+    size_t index = 0;
+    size_t skip = send_offset_;
+    size_t count = 0;
+    while (count < kMaxLinkedSends && index < send_queue_.size()) {
+        iovec* iov = async_iov_.data() + count * kMaxSendIov;
+        uint8_t* headers = async_headers_.data() + count * (kMaxSendIov / 2) * kFrameScratchSize;
+        size_t bytes = 0;
+        size_t iov_count = FillSendIov(&index, skip, iov, kMaxSendIov, &bytes, headers);
+        if (iov_count == 0) {
+            break;
+        }
+        async_msgs_[count].msg_iov = iov;
+        async_msgs_[count].msg_iovlen = iov_count;
+        count++;
+        skip = 0;
+    }
+    
+    if (count == 0) {
+        return;
+    }
+    if (!GetCenter()->SubmitSend(this, async_msgs_.data(), count)) {
+        LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Submit send failed on fd " << fd_;
+        Close();
+        return;
+    }
+    sends_in_flight_ = count;
+}
+
+void TcpEpoller::OutCompleted(int result) {
+    if (sends_in_flight_ > 0) {
+        sends_in_flight_--;
+    }
+    if (fd_ < 0) {
+        return;
+    }
+    
+    if (result > 0) {
+        AdvanceSendQueue(static_cast<size_t>(result));
+    } else if (result < 0 && result != -ECANCELED) {
+        // 链中前一个发送短写时，后续发送以 ECANCELED 结束，稍后从 send_offset_ 重新提交
+        LOG_RATE_LIMITED(LogLevel::WARN, 10) << "Send error on fd " << fd_ << ": " << strerror(-result);
+        Close();
+        return;
+    }
+    
+    if (sends_in_flight_ > 0) {
+        return;
+    }
+    
+    if (!send_queue_.empty()) {
+        OutAsync();
+        return;
+    }
+    
+    AllSendedImpl();
+    if (close_after_send_ && fd_ >= 0 && send_queue_.empty() && sends_in_flight_ == 0) {
+        Close();
+    }
+}
+
 void TcpEpoller::Send(Packet packet) {
+    if (offload_emit_seq_ != offload_next_seq_) {
+        offload_parked_bytes_ += WireFrameSize(packet);
+        offload_parked_.emplace(offload_next_seq_++, std::move(packet));
+        return;
+    }
+    EnqueueSend(std::move(packet));
+}
+
+bool TcpEpoller::Offload(std::function<Packet()> work, OffloadOrder order) {
+    Center* center = GetCenter();
+    if (fd_ < 0 || center == nullptr) {
+        return false;
+    }
+    bool ordered = order == OffloadOrder::IN_ORDER;
+    uint64_t seq = offload_next_seq_;
+    // 池线程写入结果后才把完成回调投递回本线程，MpscQueue 的发布/获取保证回调看到完整的结果
+    auto result = std::make_shared<Packet>();
+    bool submitted = center->Offload(this, [work = std::move(work), result]() { *result = work(); },
+                                     [this, ordered, seq, result]() { OnOffloadDone(ordered, seq, std::move(*result)); });
+    if (submitted && ordered) {
+        offload_next_seq_++;
+    }
+    return submitted;
+}
+
+void TcpEpoller::OnOffloadDone(bool ordered, uint64_t seq, Packet packet) {
+    if (fd_ < 0) {
+        return;
+    }
+    if (ordered) {
+        offload_parked_bytes_ += WireFrameSize(packet);
+        offload_parked_.emplace(seq, std::move(packet));
+        while (!offload_parked_.empty() && offload_parked_.begin()->first == offload_emit_seq_) {
+            auto it = offload_parked_.begin();
+            offload_parked_bytes_ -= WireFrameSize(it->second);
+            EnqueueSend(std::move(it->second));
+            offload_parked_.erase(it);
+            offload_emit_seq_++;
+        }
+    } else {
+        EnqueueSend(std::move(packet));
+    }
+    
+    // 不在读路径上，没有随后的 Out()：与 In() 的结尾相同，立即写出（或交给本轮末尾）并更新读暂停
+    if (!DefersFlush()) {
+        Out();
+    }
+    UpdateReadPause();
+}
+
+void TcpEpoller::EnqueueSend(Packet packet) {
     // 将 Packet 加入发送队列
-    std::cout << "TcpEpoller::Send() called on fd: " << fd_ << std::endl;
-    send_queue_.push(std::move(packet));
-    want_out_ = true;
+    // 只入队：读路径上随后的 Out() 会立即尝试发送，写不完时才关注 EPOLLOUT；
+    // 延迟写出模式下标记本连接，由 Center 在本轮事件处理完后写出
+    LOG_TRACE << "TcpEpoller::Send() called on fd: " << fd_;
+    if (checksum_ && !packet.has_payload_crc()) {
+        // 入队时算一次，短写后重新填充 iovec 不必再读负载；原样回射的帧沿用接收时校验过的值
+        const Data& data = std::as_const(packet).data();
+        packet.set_payload_crc(Crc32c(0, data.ptr(), data.length()));
+    }
+    size_t bytes = WireFrameSize(packet);
+    send_queue_.push_back(std::move(packet));
+    send_queue_bytes_ += bytes;
+    metrics().send_queue_depth.Add(1);
+    metrics().send_queue_bytes.Add(bytes);
+    FlowControl::Charge(bytes);
+    if (DefersFlush()) {
+        ScheduleFlush();
+    }
+    
+    // 写停滞检测：已在计时则只在到期时检查进展
+    if (!write_timer_.IsArmed() && GetCenter() && GetCenter()->timeouts().write_ms != 0) {
+        write_seen_ = bytes_written_;
+        StartTimer(&write_timer_, GetCenter()->timeouts().write_ms);
+    }
 }
 
 void TcpEpoller::Close() {
-    if (fd_ >= 0) {
+    bool closed = fd_ >= 0;
+    StopRing();
+    if (closed) {
+        int fd = fd_;
         ::close(fd_);
         fd_ = -1;
+        NotifyClosed(fd);
     }
+    idle_timer_.Cancel();
+    read_timer_.Cancel();
+    write_timer_.Cancel();
+    budget_timer_.Cancel();
+    budget_stalled_ms_ = 0;
     want_out_ = false;
+    read_paused_ = false;
+    close_after_send_ = false;
+    SetPendingIn(false);
+    SetPendingOut(false);
     ResetReadState();
+    recv_buffer_.RetrieveAll();
+    ChargeRecvBuffer();
+    decode_paused_ = false;
+    offload_parked_.clear();
+    offload_parked_bytes_ = 0;
+    offload_emit_seq_ = offload_next_seq_;
     
-    // 清空发送队列
-    while (!send_queue_.empty()) {
-        send_queue_.pop();
+    // 清空发送队列；异步发送在途时内核仍在读取这些 Packet，留待 Epoller 析构时释放
+    if (sends_in_flight_ == 0) {
+        metrics().send_queue_depth.Sub(send_queue_.size());
+        metrics().send_queue_bytes.Sub(send_queue_bytes_);
+        FlowControl::Release(send_queue_bytes_);
+        send_queue_.clear();
+        send_queue_bytes_ = 0;
+        send_offset_ = 0;
+    }
+    if (closed) {
+        OnClosed();
+    }
+}
+
+bool TcpEpoller::StartRing() {
+    // 只有 Unix 域 socket 能传递 fd；完成式后端没有就绪通知驱动门铃
+    sockaddr_storage local{};
+    socklen_t local_len = sizeof(local);
+    bool unix_socket = getsockname(fd_, reinterpret_cast<sockaddr*>(&local), &local_len) == 0 && local.ss_family == AF_UNIX;
+    std::unique_ptr<ShmRing> ring;
+    // 映射计入进程级内存预算，超出时拒绝，连接照常走 socket
+    if (unix_socket && !IsAsyncIo() && GetCenter()->ring_enabled() &&
+        FlowControl::Fits(ShmRing::MapSizeFor(ShmRing::kDefaultCapacity))) {
+        ring = ShmRing::Create();
+    }
+    if (ring && !GetCenter()->WatchReadable(this, ring->doorbell_fd())) {
+        ring.reset();
+    }
+    
+    bool replied = ring ? ring->Offer(fd_) : ShmRing::Decline(fd_);
+    if (!replied) {
+        if (ring) {
+            GetCenter()->UnwatchReadable(ring->doorbell_fd());
+        }
+        Close();
+        return false;
+    }
+    if (!ring) {
+        LOG_DEBUG << "fd " << fd_ << " declined shared ring";
+        return true;
+    }
+    LOG_DEBUG << "fd " << fd_ << " switched to shared ring";
+    ring_ = std::move(ring);
+    FlowControl::Charge(ring_->map_size());
+    metrics().ring_connections.Add(1);
+    UpdateEvents();
+    return true;
+}
+
+void TcpEpoller::StopRing() {
+    if (!ring_) {
+        return;
+    }
+    GetCenter()->UnwatchReadable(ring_->doorbell_fd());
+    FlowControl::Release(ring_->map_size());
+    ring_.reset();
+}
+
+ssize_t TcpEpoller::ReadRing(size_t max_bytes) {
+    // 轮询时多数调用读不到数据，先判断，避免空闲连接反复申请接收缓冲区
+    if (!ring_->Readable()) {
+        errno = EAGAIN;
+        return -1;
+    }
+    recv_buffer_.EnsureWritable(kMinReadSize);
+    ssize_t n = ring_->Read(recv_buffer_.BeginWrite(), std::min(recv_buffer_.WritableBytes(), max_bytes));
+    if (n < 0) {
+        return n;
+    }
+    last_read_ns_ = MonotonicNs();
+    metrics().bytes_in.Add(static_cast<size_t>(n));
+    recv_buffer_.HasWritten(static_cast<size_t>(n));
+    return n;
+}
+
+void TcpEpoller::IdleRing() {
+    // 最近收到过数据的连接留在就绪列表中继续轮询：对端下一批请求到达时不经过门铃与 epoll 唤醒。
+    // 轮询期间所在 Center 的 epoll_wait 不阻塞
+    uint64_t poll_ns = static_cast<uint64_t>(GetCenter()->ring_poll_us()) * 1000;
+    if (ring_->Readable() || MonotonicNs() - last_read_ns_ < poll_ns || !ring_->ArmReadable()) {
+        SetPendingIn(true);
+    }
+}
+
+void TcpEpoller::OnRegistered() {
+    uint32_t idle_ms = GetCenter()->timeouts().idle_ms;
+    if (idle_ms != 0) {
+        idle_seen_ = activity_;
+        StartTimer(&idle_timer_, idle_ms);
+    }
+}
+
+void TcpEpoller::OnReadProgress() {
+    // 留有不完整的帧时开始计时，到期时若期间没有解出任何帧则视为读超时
+    if (fd_ < 0 || read_timer_.IsArmed() || !HasPartialFrame() || !GetCenter()) {
+        return;
+    }
+    uint32_t read_ms = GetCenter()->timeouts().read_ms;
+    if (read_ms != 0) {
+        read_seen_ = frames_in_;
+        StartTimer(&read_timer_, read_ms);
+    }
+}
+
+void TcpEpoller::OnIdleTimer() {
+    if (fd_ < 0) {
+        return;
+    }
+    if (activity_ == idle_seen_) {
+        CloseOnTimeout("idle");
+        return;
+    }
+    idle_seen_ = activity_;
+    StartTimer(&idle_timer_, GetCenter()->timeouts().idle_ms);
+}
+
+void TcpEpoller::OnReadTimer() {
+    if (fd_ < 0 || !HasPartialFrame()) {
+        return;
+    }
+    if (frames_in_ == read_seen_) {
+        CloseOnTimeout("read deadline");
+        return;
     }
+    read_seen_ = frames_in_;
+    StartTimer(&read_timer_, GetCenter()->timeouts().read_ms);
 }
 
+void TcpEpoller::OnWriteTimer() {
+    if (fd_ < 0 || send_queue_.empty()) {
+        return;
+    }
+    if (bytes_written_ == write_seen_) {
+        CloseOnTimeout("write stall");
+        return;
+    }
+    write_seen_ = bytes_written_;
+    StartTimer(&write_timer_, GetCenter()->timeouts().write_ms);
+}
+
+void TcpEpoller::OnBudgetTimer() {
+    if (fd_ < 0 || !read_paused_) {
+        budget_stalled_ms_ = 0;
+        return;
+    }
+    UpdateReadPause();
+    if (fd_ < 0 || !read_paused_) {
+        budget_stalled_ms_ = 0;
+        return;
+    }
+    // 有待写数据的连接由写出进度恢复、由写超时兜底；只握着半帧的连接在预算持续耗尽时让出内存。
+    // 同一轮到期的定时器依次执行，前面的连接关闭释放后，后面的连接在这里看到的已是回落后的计数
+    const FlowControlConfig& config = FlowControl::config();
+    bool inbound_only = send_queue_bytes_ + offload_parked_bytes_ == 0 && HasPartialFrame();
+    if (inbound_only && FlowControl::OverBudget()) {
+        budget_stalled_ms_ += kBudgetRecheckMs;
+    } else {
+        budget_stalled_ms_ = 0;
+    }
+    if (config.budget_stall_ms != 0 && budget_stalled_ms_ >= config.budget_stall_ms) {
+        CloseOnTimeout("memory budget stall");
+        return;
+    }
+    StartTimer(&budget_timer_, kBudgetRecheckMs);
+}
+
+void TcpEpoller::CloseOnTimeout(const char* reason) {
+    LOG_DEBUG << "Closing fd " << fd_ << " on " << reason << " timeout";
+    metrics().connections_timed_out.Add(1);
+    Close();
+}
@@ -0,0 +1,259 @@
+#include "../include/net/udp_epoller.h"
+#include "../include/common/logger.h"
+#include "../include/common/packet.h"
+#include "../include/core/metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace {
+
+// 内核一次 GSO 发送最多切分的段数（UDP_MAX_SEGMENTS）
+constexpr size_t kMaxGsoSegments = 64;
+// 一次 GSO 发送的负载总长受 UDP 长度字段限制
+constexpr size_t kMaxGsoBytes = 65507;
+// 边沿触发下一次可读事件最多处理的批数，超过后让出给其他连接
+constexpr size_t kEdgeBatchBudget = 16;
+
+// 槽位按缓存行对齐，并错开 4KB 别名：各槽位开头的包头不会全部落在同一组 L1 缓存行上
+size_t SlotStride(size_t max_datagram) {
+    return ((max_datagram + 63) & ~size_t(63)) + 64;
+}
+
+bool ProbeGso(int fd) {
+    int segment = 0;
+    socklen_t length = sizeof(segment);
+    return getsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment, &length) == 0;
+}
+
+}  // namespace
+
+UdpEpoller::UdpEpoller(int fd, const WireFormat* wire_format, size_t max_datagram)
+    : wire_format_(wire_format), max_datagram_(max_datagram), slot_stride_(SlotStride(max_datagram)),
+      buffers_(new uint8_t[kBatchSize * SlotStride(max_datagram)]), recv_msgs_{}, recv_iov_{}, peers_{},
+      reply_count_(0), send_msgs_{}, send_count_(0), send_next_(0), batch_received_ns_(0),
+      gso_max_segment_(0), want_out_(false) {
+    fd_ = fd;
+    for (size_t i = 0; i < kBatchSize; i++) {
+        recv_iov_[i].iov_base = Slot(i);
+        recv_iov_[i].iov_len = max_datagram_;
+        recv_msgs_[i].msg_hdr.msg_iov = &recv_iov_[i];
+        recv_msgs_[i].msg_hdr.msg_iovlen = 1;
+        recv_msgs_[i].msg_hdr.msg_name = &peers_[i];
+    }
+    if (ProbeGso(fd)) {
+        gso_max_segment_ = kMaxGsoBytes;
+    }
+    LOG_DEBUG << "UDP socket fd " << fd << ": GSO " << (gso_enabled() ? "on" : "off");
+}
+
+UdpEpoller::~UdpEpoller() = default;
+
+void UdpEpoller::RecvImpl(Packet) {
+}
+
+uint32_t UdpEpoller::Events() const {
+    return want_out_ ? static_cast<uint32_t>(EPOLLOUT) : static_cast<uint32_t>(EPOLLIN);
+}
+
+void UdpEpoller::In() {
+    if (fd_ < 0) {
+        return;
+    }
+    SetPendingIn(false);
+    if (want_out_) {
+        return;
+    }
+    
+    // 水平触发：每次可读事件处理一批；边沿触发：处理到 socket 读空，超过预算时交给就绪列表续读
+    for (size_t batch = 0;; batch++) {
+        size_t count = ReceiveBatch();
+        if (count == 0) {
+            break;
+        }
+        ProcessBatch(count);
+        BuildSendList(0);
+        if (!SendReplies()) {
+            return;
+        }
+        if (count < kBatchSize || !IsEdgeTriggered()) {
+            break;
+        }
+        if (batch + 1 >= kEdgeBatchBudget) {
+            SetPendingIn(true);
+            break;
+        }
+    }
+}
+
+void UdpEpoller::Out() {
+    if (fd_ < 0 || !want_out_ || !SendReplies()) {
+        return;
+    }
+    want_out_ = false;
+    UpdateEvents();
+    // 等待可写期间没有读取，边沿触发下不会再收到已到达报文的可读事件
+    if (IsEdgeTriggered()) {
+        SetPendingIn(true);
+    }
+}
+
+size_t UdpEpoller::ReceiveBatch() {
+    // msg_namelen 与 msg_flags 每次都被内核改写
+    for (size_t i = 0; i < kBatchSize; i++) {
+        recv_msgs_[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+    int n = recvmmsg(fd_, recv_msgs_.data(), kBatchSize, MSG_DONTWAIT, nullptr);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            metrics().read_eagain.Add(1);
+        } else if (errno != EINTR) {
+            // 未连接的 UDP socket 上错误只影响单个报文，socket 本身继续可用
+            LOG_RATE_LIMITED(LogLevel::WARN, 10) << "recvmmsg failed on fd " << fd_ << ": " << strerror(errno);
+        }
+        return 0;
+    }
+    batch_received_ns_ = MonotonicNs();
+    metrics().datagrams_received.Add(static_cast<uint64_t>(n));
+    return static_cast<size_t>(n);
+}
+
+void UdpEpoller::ProcessBatch(size_t count) {
+    reply_count_ = 0;
+    size_t dropped = 0;
+    for (size_t i = 0; i < count; i++) {
+        const msghdr& hdr = recv_msgs_[i].msg_hdr;
+        size_t length = recv_msgs_[i].msg_len;
+        uint8_t* datagram = Slot(i);
+        PacketHeader header;
+        int header_size = (hdr.msg_flags & MSG_TRUNC) ? -1 : wire_format_->decode(datagram, length, &header);
+        // 一个报文恰好是一帧：包头声明的长度必须与报文剩余长度一致
+        if (header_size <= 0 || header.length != length - static_cast<size_t>(header_size)) {
+            dropped++;
+            continue;
+        }
+        
+        uint8_t* payload = datagram + header_size;
+        if (!OnDatagram(header, payload)) {
+            continue;
+        }
+        size_t k = reply_count_++;
+        uint8_t* reply_header = reply_headers_[k].data();
+        size_t reply_header_size = wire_format_->encode(header, reply_header);
+        reply_slot_[k] = static_cast<uint8_t>(i);
+        reply_size_[k] = static_cast<uint32_t>(reply_header_size + header.length);
+        reply_iov_[2 * k] = iovec{reply_header, reply_header_size};
+        reply_iov_[2 * k + 1] = iovec{payload, header.length};
+    }
+    if (dropped > 0) {
+        metrics().datagrams_dropped.Add(dropped);
+        LOG_RATE_LIMITED(LogLevel::DEBUG, 10) << "Dropped " << dropped << " malformed or truncated datagram(s) on fd " << fd_;
+    }
+}
+
+bool UdpEpoller::SamePeer(size_t a, size_t b) const {
+    const msghdr& x = recv_msgs_[reply_slot_[a]].msg_hdr;
+    const msghdr& y = recv_msgs_[reply_slot_[b]].msg_hdr;
+    return x.msg_namelen == y.msg_namelen && std::memcmp(x.msg_name, y.msg_name, x.msg_namelen) == 0;
+}
+
+void UdpEpoller::BuildSendList(size_t first) {
+    send_count_ = 0;
+    send_next_ = 0;
+    for (size_t k = first; k < reply_count_;) {
+        // 同一对端的连续应答合并：各段等长，只有最后一段可以更短
+        size_t segment = reply_size_[k];
+        size_t count = 1;
+        if (segment <= gso_max_segment_) {
+            size_t total = segment;
+            while (k + count < reply_count_ && count < kMaxGsoSegments && reply_size_[k + count] <= segment &&
+                   total + reply_size_[k + count] <= kMaxGsoBytes && SamePeer(k, k + count)) {
+                total += reply_size_[k + count];
+                count++;
+                if (reply_size_[k + count - 1] < segment) {
+                    break;
+                }
+            }
+        }
+        
+        const msghdr& request = recv_msgs_[reply_slot_[k]].msg_hdr;
+        msghdr& hdr = send_msgs_[send_count_].msg_hdr;
+        hdr.msg_name = request.msg_name;
+        hdr.msg_namelen = request.msg_namelen;
+        hdr.msg_iov = &reply_iov_[2 * k];
+        hdr.msg_iovlen = 2 * count;
+        hdr.msg_flags = 0;
+        if (count > 1) {
+            hdr.msg_control = send_control_[send_count_].data;
+            hdr.msg_controllen = sizeof(send_control_[send_count_].data);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t segment_size = static_cast<uint16_t>(segment);
+            std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+        } else {
+            hdr.msg_control = nullptr;
+            hdr.msg_controllen = 0;
+        }
+        send_first_[send_count_] = static_cast<uint8_t>(k);
+        send_segments_[send_count_] = static_cast<uint8_t>(count);
+        send_count_++;
+        k += count;
+    }
+}
+
+bool UdpEpoller::SendReplies() {
+    while (send_next_ < send_count_) {
+        int n = sendmmsg(fd_, &send_msgs_[send_next_], static_cast<unsigned>(send_count_ - send_next_), MSG_DONTWAIT);
+        if (n > 0) {
+            uint64_t now = MonotonicNs();
+            for (size_t i = send_next_; i < send_next_ + static_cast<size_t>(n); i++) {
+                size_t segments = send_segments_[i];
+                metrics().datagrams_sent.Add(segments);
+                if (segments > 1) {
+                    metrics().gso_sends.Add(1);
+                }
+                for (size_t s = 0; s < segments; s++) {
+                    metrics().echo_latency_ns.Record(now - batch_received_ns_);
+                }
+            }
+            send_next_ += static_cast<size_t>(n);
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            metrics().write_eagain.Add(1);
+            if (!want_out_) {
+                want_out_ = true;
+                UpdateEvents();
+            }
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        
+        size_t segments = send_segments_[send_next_];
+        if (segments > 1 && (errno == EIO || errno == EINVAL)) {
+            // EIO：出口设备不支持校验和卸载，GSO 不可用；EINVAL：分段超过路径 MTU，之后只合并更短的应答。
+            // 从失败的消息开始重新编排后重试
+            size_t segment = reply_size_[send_first_[send_next_]];
+            gso_max_segment_ = errno == EIO ? 0 : segment - 1;
+            LOG_INFO << "UDP GSO on fd " << fd_ << " limited to segments of " << gso_max_segment_ << " bytes: "
+                     << strerror(errno);
+            BuildSendList(send_first_[send_next_]);
+            continue;
+        }
+        // 其他错误（如对端地址不可达）只影响这条消息
+        LOG_RATE_LIMITED(LogLevel::WARN, 10) << "sendmmsg failed on fd " << fd_ << ": " << strerror(errno);
+        metrics().datagrams_dropped.Add(segments);
+        send_next_++;
+    }
+    return true;
+}
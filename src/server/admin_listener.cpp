@@ -0,0 +1,115 @@
+#include "admin_listener.h"
+#include "../include/core/metrics.h"
+#include "../include/common/logger.h"
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// 等待对端请求行的时间；超时即按纯文本应答
+constexpr int kRequestWaitMs = 100;
+}
+
+AdminListener::AdminListener() : listen_fd_(-1) {}
+
+AdminListener::~AdminListener() {
+    Stop();
+}
+
+bool AdminListener::Start(const char* host, uint16_t port) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR << "Failed to create admin socket: " << strerror(errno);
+        return false;
+    }
+    
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (host) {
+        if (inet_pton(AF_INET, host, &addr.sin_addr) <= 0) {
+            LOG_ERROR << "Invalid admin address: " << host;
+            close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+    } else {
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 16) < 0) {
+        LOG_ERROR << "Failed to bind admin port " << port << ": " << strerror(errno);
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    
+    LOG_INFO << "Admin listener on " << (host ? host : "127.0.0.1") << ":" << port;
+    thread_ = std::thread(&AdminListener::Serve, this);
+    return true;
+}
+
+void AdminListener::Stop() {
+    if (listen_fd_ < 0) {
+        return;
+    }
+    // shutdown 使阻塞的 accept 返回
+    shutdown(listen_fd_, SHUT_RDWR);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void AdminListener::Serve() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        HandleClient(fd);
+        close(fd);
+    }
+}
+
+void AdminListener::HandleClient(int fd) {
+    bool http = false;
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, kRequestWaitMs) > 0) {
+        char request[512];
+        ssize_t n = recv(fd, request, sizeof(request), MSG_DONTWAIT);
+        http = n >= 4 && std::memcmp(request, "GET ", 4) == 0;
+    }
+    
+    std::string body = MetricsRegistry::Format();
+    std::string response;
+    if (http) {
+        response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                   std::to_string(body.size()) + "\r\n\r\n";
+    }
+    response += body;
+    
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+// AdminListener 类定义
+// 纯文本管理端口：每个连接写出一次 MetricsRegistry::Format() 后关闭。
+// 运行在独立线程上，使用阻塞 accept，不占用任何 Reactor。
+// 对端先发送 HTTP GET 时以 HTTP/1.0 应答，便于 curl 抓取；否则直接写出文本（nc 可用）。
+
+class AdminListener {
+public:
+    AdminListener();
+    ~AdminListener();
+    
+    bool Start(const char* host, uint16_t port);
+    void Stop();
+    
+private:
+    void Serve();
+    void HandleClient(int fd);
+    
+    int listen_fd_;
+    std::thread thread_;
+};
@@ -0,0 +1,18 @@
+#include "coro_echo_handler.h"
+#include "echo_server_epoller.h"
+#include "../include/common/packet_header.h"
+
+ConnectionTask CoroEchoHandler(CoroTcpEpoller& conn) {
+    while (std::optional<Packet> packet = co_await conn.ReadPacket()) {
+        uint32_t command = packet->header().command;
+        if (command == static_cast<uint32_t>(PacketHeaderCommand::DEFAULT)) {
+            co_await conn.Send(std::move(*packet));
+        } else if (command == static_cast<uint32_t>(PacketHeaderCommand::STATS)) {
+            co_await conn.Send(BuildStatsReply(*packet));
+        } else if (command == static_cast<uint32_t>(PacketHeaderCommand::WORK)) {
+            // 应答经 TcpEpoller::Send 入队，不等待写出；之后的 co_await conn.Send 按序排在其后
+            DispatchWork(conn, std::move(*packet));
+        }
+        // 其他命令忽略
+    }
+}
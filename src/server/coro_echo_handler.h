@@ -0,0 +1,6 @@
+#pragma once
+
+#include "../include/net/coro_tcp_epoller.h"
+
+// 协程版回射处理函数（-C）：与 EchoServerEpoller 行为相同，DEFAULT 原样回射，STATS 返回指标文本
+ConnectionTask CoroEchoHandler(CoroTcpEpoller& conn);
@@ -1,12 +1,36 @@
 #include "echo_server_center.h"
 #include "echo_server_epoller.h"
+#include "coro_echo_handler.h"
 #include "../include/net/epoller.h"
 #include <memory>
 
-EchoServerCenter::EchoServerCenter() : EpollCenter() {}
+template <typename CenterBase>
+BasicEchoServerCenter<CenterBase>::BasicEchoServerCenter(bool use_coroutine, const WireFormat* wire_format)
+    : CenterBase(), use_coroutine_(use_coroutine), wire_format_(wire_format) {}
 
-EchoServerCenter::~EchoServerCenter() = default;
+template <typename CenterBase>
+BasicEchoServerCenter<CenterBase>::~BasicEchoServerCenter() = default;
 
-std::unique_ptr<Epoller> EchoServerCenter::NewConnectionEpoller(int fd) {
-    return std::make_unique<EchoServerEpoller>(fd);
+template <typename CenterBase>
+std::unique_ptr<Epoller> BasicEchoServerCenter<CenterBase>::NewConnectionEpoller(int fd) {
+    std::unique_ptr<TcpEpoller> epoller;
+    if (use_coroutine_) {
+        epoller = std::make_unique<CoroTcpEpoller>(fd, &CoroEchoHandler);
+    } else {
+        epoller = std::make_unique<EchoServerEpoller>(fd);
+    }
+    epoller->SetWireFormat(wire_format_);
+    // 任何连接都可以用开头的 magic 字节切换到紧凑格式、启用校验尾部；同机的 Unix 域 socket 连接还可以改用共享内存环
+    epoller->SetNegotiableFormat(&WireFormat::Compact());
+    epoller->SetNegotiableChecksum(true);
+    epoller->SetNegotiableRing(true);
+    return epoller;
 }
+
+template <typename CenterBase>
+std::unique_ptr<Epoller> BasicEchoServerCenter<CenterBase>::NewDatagramEpoller(int fd) {
+    return std::make_unique<EchoServerUdpEpoller>(fd, wire_format_);
+}
+
+template class BasicEchoServerCenter<EpollCenter>;
+template class BasicEchoServerCenter<IoUringCenter>;
@@ -1,19 +1,31 @@
 #pragma once
 
 #include "../include/core/epoll_center.h"
+#include "../include/core/io_uring_center.h"
+#include "../include/common/wire_codec.h"
 #include <memory>
 
 class Epoller;
 
-// EchoServerCenter 类定义
-// 覆写 NewConnectionEpoller 返回 EchoServerEpoller
+// BasicEchoServerCenter 类模板定义
+// 覆写 NewConnectionEpoller 返回 EchoServerEpoller（use_coroutine 时为运行 CoroEchoHandler 的 CoroTcpEpoller）；
+// 新连接使用 wire_format 收发，以 CompactHeaderCodec::kMagic 开头的连接改用紧凑格式；CenterBase 决定 I/O 后端
+// UDP socket 使用 EchoServerUdpEpoller，报文包头同样按 wire_format 编解码（仅 epoll 后端）
 
-class EchoServerCenter : public EpollCenter {
+template <typename CenterBase>
+class BasicEchoServerCenter : public CenterBase {
 public:
-    EchoServerCenter();
-    virtual ~EchoServerCenter();
+    explicit BasicEchoServerCenter(bool use_coroutine = false, const WireFormat* wire_format = &WireFormat::Native());
+    virtual ~BasicEchoServerCenter();
     
 protected:
     virtual std::unique_ptr<Epoller> NewConnectionEpoller(int fd) override;
+    virtual std::unique_ptr<Epoller> NewDatagramEpoller(int fd) override;
+    
+private:
+    bool use_coroutine_;
+    const WireFormat* wire_format_;
 };
 
+using EchoServerCenter = BasicEchoServerCenter<EpollCenter>;
+using IoUringEchoServerCenter = BasicEchoServerCenter<IoUringCenter>;
@@ -1,5 +1,9 @@
 #include "echo_server_epoller.h"
 #include "../include/common/packet_header.h"
+#include "../include/core/center.h"
+#include "../include/core/metrics.h"
+#include <algorithm>
+#include <string>
 
 EchoServerEpoller::EchoServerEpoller() : AutoFlagTcpEpoller() {}
 
@@ -17,6 +21,12 @@ void EchoServerEpoller::RecvImpl(Packet packet) {
     if (packet.header().command == static_cast<uint32_t>(PacketHeaderCommand::DEFAULT)) {
         // 直接原样回射
         Send(std::move(packet));
+    } else if (packet.header().command == static_cast<uint32_t>(PacketHeaderCommand::STATS)) {
+        // 指标查询
+        Send(BuildStatsReply(packet));
+    } else if (packet.header().command == static_cast<uint32_t>(PacketHeaderCommand::WORK)) {
+        // 耗时处理：不占用事件循环，其他连接照常收发
+        DispatchWork(*this, std::move(packet));
     } else {
         // 处理其他命令（如 READ_EOF/WRITE_CLOSED）交给基类
     }
@@ -27,3 +37,65 @@ void EchoServerEpoller::AllSendedImpl() {
     // 除非协议约定
 }
 
+EchoServerUdpEpoller::EchoServerUdpEpoller(int fd, const WireFormat* wire_format) : UdpEpoller(fd, wire_format) {}
+
+EchoServerUdpEpoller::~EchoServerUdpEpoller() = default;
+
+bool EchoServerUdpEpoller::OnDatagram(PacketHeader& header, uint8_t*) {
+    return header.command == static_cast<uint32_t>(PacketHeaderCommand::DEFAULT);
+}
+
+namespace {
+
+// 启动前由 SetWorkLimitUs 设置，之后只读
+uint32_t g_work_limit_us = 0;
+
+Packet BuildWorkRejection(const Packet& request) {
+    PacketHeader header{};
+    header.command = static_cast<uint32_t>(PacketHeaderCommand::ERROR);
+    header.extra1 = request.header().extra1;
+    Packet reply(header, Data());
+    reply.set_received_ns(request.received_ns());
+    return reply;
+}
+
+}  // namespace
+
+Packet BuildStatsReply(const Packet& request) {
+    std::string text = MetricsRegistry::Format();
+    PacketHeader header{};
+    header.command = static_cast<uint32_t>(PacketHeaderCommand::STATS);
+    header.length = static_cast<uint32_t>(text.size());
+    header.extra1 = request.header().extra1;
+    Packet reply(header, Data(text.data(), text.size()));
+    reply.set_received_ns(request.received_ns());
+    return reply;
+}
+
+void SetWorkLimitUs(uint32_t max_us) {
+    g_work_limit_us = std::min(max_us, kMaxWorkUs);
+}
+
+Packet HandleWork(Packet request) {
+    // 忙等而不是休眠：模拟压缩、查表等占用 CPU 的处理
+    uint64_t deadline = MonotonicNs() + static_cast<uint64_t>(request.header().extra2 & ~kWorkUnordered) * 1000;
+    while (MonotonicNs() < deadline) {
+    }
+    return request;
+}
+
+void DispatchWork(TcpEpoller& conn, Packet request) {
+    uint32_t work_us = request.header().extra2 & ~kWorkUnordered;
+    if (work_us > g_work_limit_us) {
+        conn.Send(BuildWorkRejection(request));
+        return;
+    }
+    OffloadOrder order = (request.header().extra2 & kWorkUnordered) ? OffloadOrder::UNORDERED : OffloadOrder::IN_ORDER;
+    Center* center = conn.GetCenter();
+    if (center == nullptr || center->offload_pool() == nullptr) {
+        conn.Send(HandleWork(std::move(request)));
+    } else if (!conn.Offload([request]() { return HandleWork(request); }, order)) {
+        // 池已满时不退回事件循环线程处理，否则大量请求仍会阻塞其他连接
+        conn.Send(BuildWorkRejection(request));
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../include/net/auto_flag_tcp_epoller.h"
+#include "../include/net/udp_epoller.h"
 #include "../include/common/packet.h"
 
 // EchoServerEpoller 类定义
@@ -17,3 +18,24 @@ public:
     virtual void AllSendedImpl() override;
 };
 
+// EchoServerUdpEpoller 类定义
+// UDP 回射：DEFAULT 命令的报文原样发回，其他命令丢弃（STATS 应答可能超出单个报文）
+
+class EchoServerUdpEpoller : public UdpEpoller {
+public:
+    EchoServerUdpEpoller(int fd, const WireFormat* wire_format);
+    virtual ~EchoServerUdpEpoller();
+
+protected:
+    virtual bool OnDatagram(PacketHeader& header, uint8_t* payload) override;
+};
+
+// STATS 请求的应答：负载为所有 Reactor 汇总后的纯文本，回调与协程两种处理方式共用
+Packet BuildStatsReply(const Packet& request);
+// 开启 WORK 请求并设置单个请求的时长上限（微秒，不超过 kMaxWorkUs），0 关闭（默认）；须在事件循环启动前调用
+void SetWorkLimitUs(uint32_t max_us);
+// WORK 请求：在调用线程上忙等请求指定的时长后返回原包，回调与协程两种处理方式共用
+Packet HandleWork(Packet request);
+// 有卸载线程池时把 WORK 请求交给池线程，未配置时就地处理；未开启、超过上限或池已满时应答 ERROR
+void DispatchWork(TcpEpoller& conn, Packet request);
+
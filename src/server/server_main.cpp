@@ -1,44 +1,365 @@
 #include "echo_server_center.h"
+#include "admin_listener.h"
+#include "echo_server_epoller.h"
+#include "../include/core/center_group.h"
+#include "../include/core/offload_pool.h"
+#include "../include/common/slab_allocator.h"
+#include "../include/common/crc32c.h"
+#include "../include/common/logger.h"
+#include "../include/net/flow_control.h"
 #include <iostream>
 #include <csignal>
 #include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 static std::atomic<bool> g_running{true};
-static EchoServerCenter* g_center = nullptr;
+static CenterGroup* g_group = nullptr;
+
+static std::atomic<int> g_signal{0};
 
 void signal_handler(int sig) {
-    std::cout << "\nReceived signal " << sig << ", shutting down..." << std::endl;
+    // 信号处理函数中只做异步信号安全的操作，日志在事件循环退出后输出
+    g_signal = sig;
     g_running = false;
-    if (g_center) {
-        g_center->Stop();
+    if (g_group) {
+        g_group->Stop();
+    }
+}
+
+static uint32_t SecondsToMs(const char* text) {
+    double seconds = std::max(0.0, std::atof(text));
+    return static_cast<uint32_t>(std::min(seconds * 1000, 4.0e9));
+}
+
+// class=kb[/packets]，如 bulk=64/16；省略帧数时为 IoBudget 的默认值 64
+static bool ParseIoBudget(const char* text, IoPriority* priority, IoBudget* budget) {
+    const char* eq = strchr(text, '=');
+    if (!eq) {
+        return false;
+    }
+    std::string name(text, eq - text);
+    if (name == "high") {
+        *priority = IoPriority::HIGH;
+    } else if (name == "normal") {
+        *priority = IoPriority::NORMAL;
+    } else if (name == "bulk") {
+        *priority = IoPriority::BULK;
+    } else {
+        return false;
+    }
+    int kb = std::atoi(eq + 1);
+    if (kb <= 0) {
+        return false;
     }
+    budget->bytes = static_cast<size_t>(kb) << 10;
+    const char* slash = strchr(eq + 1, '/');
+    if (slash) {
+        int packets = std::atoi(slash + 1);
+        if (packets <= 0) {
+            return false;
+        }
+        budget->packets = static_cast<size_t>(packets);
+    }
+    return true;
+}
+
+static void PrintUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-p port] [-a endpoint]... [-t threads] [-m model] [-b placement] [-M pool_mb] [-e] [-B backend] [-l level] [-L file] [-A admin_port] [-w high_kb] [-g budget_mb] [-s frame_kb] [-i seconds] [-R seconds] [-W seconds] [-C] [-F] [-f format] [-S] [-P usec] [-X max_us] [-O threads] [-G class=kb[/packets]]... [-Q bulk_kb] [port]\n"
+              << "  -p port       监听端口，默认8888\n"
+              << "  -a endpoint   监听地址，可重复指定以同时监听多个；指定后不再默认监听 -p 端口。形式：\n"
+              << "                8888 / 127.0.0.1:8888（IPv4）、[::]:8888（IPv6 双栈）、\n"
+              << "                unix:/tmp/echo.sock（Unix 域 socket）、unix:@echo（抽象命名空间）\n"
+              << "                udp:8888 / udp:[::]:8888（UDP 回射，每个报文一帧，recvmmsg/sendmmsg 批量收发，支持时用 GSO；仅 epoll 后端）\n"
+              << "  -t threads    事件循环线程数，0 表示使用全部CPU核心，默认1\n"
+              << "  -m model      线程模型：reuseport（默认）或 acceptor\n"
+              << "  -b placement  acceptor 模式及多线程下 Unix 域 socket 的连接分配：rr（轮询，默认）或 lc（最少连接）\n"
+              << "  -M pool_mb    每个线程负载缓冲池缓存的空闲内存上限（MB），默认64\n"
+              << "  -e            边沿触发（EPOLLET）模式\n"
+              << "  -B backend    I/O 后端：epoll（默认）或 uring（内核不支持时退回 epoll）\n"
+              << "  -l level      日志级别：trace/debug/info（默认）/warn/error/off\n"
+              << "  -L file       日志输出文件，默认 stderr\n"
+              << "  -A admin_port 在 127.0.0.1 上开启纯文本指标端口（nc/curl 读取）\n"
+              << "  -w high_kb    单连接发送队列高水位（KB），超过后暂停读取，降到 1/4 恢复；0 不限制，默认4096\n"
+              << "  -g budget_mb  所有连接发送队列与接收缓冲区合计预算（MB），超出后积压达 64KB 的连接暂停读取，\n"
+              << "                只握着未收全帧的连接在持续超出 2 秒后关闭；每个连接可超出一次读入的字节数，默认0不限制\n"
+              << "  -s frame_kb   单帧负载长度上限（KB），包头声明的长度超过时关闭连接；0 不限制，默认65536\n"
+              << "  -i seconds    空闲超时：既无读也无写超过该时长后关闭连接，0 不检查，默认300\n"
+              << "  -R seconds    读帧超时：一帧从首字节起未在该时长内收全则关闭连接，0 不检查，默认30\n"
+              << "  -W seconds    写停滞超时：有待发送数据但无写出进展超过该时长则关闭连接，0 不检查，默认60\n"
+              << "  -C            使用协程版连接处理（CoroTcpEpoller），行为与默认的回调版相同\n"
+              << "  -F            延迟写出：每轮事件处理完后每个连接统一写出一次，合并流水线请求的应答\n"
+              << "  -f format     包头线上格式：native（默认，主机序 20 字节）/network（网络字节序）/slim（网络字节序，零值字段省略）；\n"
+              << "                无论该选项如何，客户端都可以用首字节 0xC5 协商紧凑格式（compact），\n"
+              << "                用 0xCC 启用每帧 CRC32C 校验尾部（两者可同时使用）\n"
+              << "  -S            允许 Unix 域 socket 上的客户端用首字节 0xD5 协商共享内存环（每个连接约 2MB 映射，计入 -g 预算，\n"
+              << "                超出时拒绝协商）；默认关闭，仅 epoll 后端支持\n"
+              << "  -P usec       共享内存环连接收到数据后继续忙轮询的时长，默认在 CPU 核数多于\n"
+              << "                线程数时为50，否则为0（处理完即休眠，靠门铃唤醒）\n"
+              << "  -X max_us     开启耗时请求（command=11，WORK）并限制单个请求的时长（微秒，最大10000）；默认0，不处理 WORK 请求，\n"
+              << "                应答 ERROR\n"
+              << "  -O threads    卸载线程池的线程数：WORK 请求交给池线程处理，事件循环不被阻塞，池满时应答 ERROR；\n"
+              << "                默认0，在事件循环线程上就地处理\n"
+              << "  -G budget     按优先级设置每个连接每次调度的读写预算，形如 bulk=64/16（KB/帧），可重复；class 为 high/normal/bulk，\n"
+              << "                默认 high、normal 为 256/64，bulk 为 64/16。用完预算的连接进入就绪列表，高优先级先服务\n"
+              << "  -Q bulk_kb    收到负载不小于该大小（KB）的帧的连接降为 bulk 优先级，0 不自动分类，默认64\n";
 }
 
 int main(int argc, char* argv[]) {
-    std::cout << "Echo Server Starting..." << std::endl;
+    // 监听端口，默认8888；线程数默认1（单 Reactor）
+    uint16_t port = 8888;
+    std::vector<Endpoint> endpoints;
+    size_t threads = 1;
+    ThreadingModel model = ThreadingModel::REUSE_PORT;
+    std::unique_ptr<PlacementPolicy> placement;
+    SlabConfig slab_config;
+    bool edge_triggered = false;
+    bool use_io_uring = false;
+    LogConfig log_config;
+    uint16_t admin_port = 0;
+    FlowControlConfig flow_config;
+    ConnectionTimeouts timeouts;
+    bool use_coroutine = false;
+    bool deferred_flush = false;
+    const WireFormat* wire_format = &WireFormat::Native();
+    bool shm_ring = false;
+    int ring_poll_us = -1;
+    uint32_t work_limit_us = 0;
+    size_t offload_threads = 0;
+    std::vector<std::pair<IoPriority, IoBudget>> io_budgets;
+    size_t bulk_frame_bytes = 64 << 10;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "p:a:t:m:b:M:eB:l:L:A:w:g:s:i:R:W:CFf:SP:X:O:G:Q:h")) != -1) {
+        switch (opt) {
+            case 'p':
+                port = static_cast<uint16_t>(std::atoi(optarg));
+                break;
+            case 'a': {
+                Endpoint endpoint;
+                if (!Endpoint::Parse(optarg, &endpoint)) {
+                    std::cerr << "Invalid endpoint: " << optarg << "\n";
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                endpoints.push_back(endpoint);
+                break;
+            }
+            case 't':
+                threads = static_cast<size_t>(std::atoi(optarg));
+                break;
+            case 'm':
+                if (strcmp(optarg, "acceptor") == 0) {
+                    model = ThreadingModel::ACCEPTOR;
+                } else if (strcmp(optarg, "reuseport") == 0) {
+                    model = ThreadingModel::REUSE_PORT;
+                } else {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'b':
+                if (strcmp(optarg, "lc") == 0) {
+                    placement = std::make_unique<LeastConnectionsPlacement>();
+                } else if (strcmp(optarg, "rr") == 0) {
+                    placement = std::make_unique<RoundRobinPlacement>();
+                } else {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'M':
+                slab_config.max_cached_bytes = static_cast<size_t>(std::atoi(optarg)) << 20;
+                break;
+            case 'e':
+                edge_triggered = true;
+                break;
+            case 'B':
+                if (strcmp(optarg, "uring") == 0) {
+                    use_io_uring = true;
+                } else if (strcmp(optarg, "epoll") == 0) {
+                    use_io_uring = false;
+                } else {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'l':
+                if (!Logger::ParseLevel(optarg, &log_config.level)) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'L':
+                log_config.file = optarg;
+                break;
+            case 'A':
+                admin_port = static_cast<uint16_t>(std::atoi(optarg));
+                break;
+            case 'w':
+                flow_config.high_watermark = static_cast<size_t>(std::atoi(optarg)) << 10;
+                flow_config.low_watermark = flow_config.high_watermark / 4;
+                break;
+            case 'g':
+                flow_config.memory_budget = static_cast<size_t>(std::atoi(optarg)) << 20;
+                break;
+            case 's':
+                flow_config.max_frame_length = static_cast<size_t>(std::max(0, std::atoi(optarg))) << 10;
+                break;
+            case 'i':
+                timeouts.idle_ms = SecondsToMs(optarg);
+                break;
+            case 'R':
+                timeouts.read_ms = SecondsToMs(optarg);
+                break;
+            case 'W':
+                timeouts.write_ms = SecondsToMs(optarg);
+                break;
+            case 'C':
+                use_coroutine = true;
+                break;
+            case 'F':
+                deferred_flush = true;
+                break;
+            case 'f':
+                wire_format = WireFormat::Find(optarg);
+                if (!wire_format) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'S':
+                shm_ring = true;
+                break;
+            case 'P':
+                ring_poll_us = std::max(0, std::atoi(optarg));
+                break;
+            case 'X':
+                work_limit_us = static_cast<uint32_t>(std::max(0, std::atoi(optarg)));
+                if (work_limit_us > kMaxWorkUs) {
+                    std::cerr << "WORK limit capped at " << kMaxWorkUs << " us\n";
+                }
+                break;
+            case 'O':
+                offload_threads = static_cast<size_t>(std::max(0, std::atoi(optarg)));
+                break;
+            case 'G': {
+                IoPriority priority;
+                IoBudget budget;
+                if (!ParseIoBudget(optarg, &priority, &budget)) {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                io_budgets.emplace_back(priority, budget);
+                break;
+            }
+            case 'Q':
+                bulk_frame_bytes = static_cast<size_t>(std::max(0, std::atoi(optarg))) << 10;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    // 兼容旧用法：第一个位置参数为端口
+    if (optind < argc) {
+        port = static_cast<uint16_t>(std::atoi(argv[optind]));
+    }
+    if (endpoints.empty()) {
+        endpoints.emplace_back();
+        Endpoint::FromHostPort(nullptr, port, &endpoints.back());
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // 没有空闲核时忙轮询只会占住客户端需要的 CPU
+    if (ring_poll_us < 0) {
+        ring_poll_us = std::thread::hardware_concurrency() > threads ? 50 : 0;
+    }
+    
+    SlabAllocator::Configure(slab_config);
+    SetWorkLimitUs(work_limit_us);
+    FlowControl::Configure(flow_config);
+    if (!Logger::Start(log_config)) {
+        return 1;
+    }
+    LOG_INFO << "Echo Server Starting...";
+    LOG_INFO << "CRC32C implementation: " << Crc32cImplementation();
+    
+    if (use_io_uring && !IoUringCenter::IsSupported()) {
+        LOG_WARN << "io_uring not supported by this kernel, falling back to epoll";
+        use_io_uring = false;
+    }
     
     // 设置信号处理
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
-    // 创建服务器
-    EchoServerCenter center;
-    g_center = &center;
-    
-    // 监听端口，默认8888
-    uint16_t port = 8888;
-    if (argc > 1) {
-        port = static_cast<uint16_t>(std::atoi(argv[1]));
+    // 各 Center 共用一个卸载线程池；须比 Center 先停止，完成回调不能投递给已析构的 Center
+    std::unique_ptr<OffloadPool> offload_pool;
+    if (offload_threads > 0) {
+        offload_pool = std::make_unique<OffloadPool>(offload_threads);
     }
     
-    if (!center.Listen(nullptr, port)) {
-        std::cerr << "Failed to start server" << std::endl;
+    // 创建服务器：每个线程一个 EchoServerCenter
+    OffloadPool* pool = offload_pool.get();
+    CenterGroup group([edge_triggered, use_io_uring, use_coroutine, deferred_flush, wire_format, timeouts,
+                       shm_ring, ring_poll_us, pool, io_budgets, bulk_frame_bytes]() -> std::unique_ptr<Center> {
+                          std::unique_ptr<Center> center;
+                          if (use_io_uring) {
+                              center = std::make_unique<IoUringEchoServerCenter>(use_coroutine, wire_format);
+                          } else {
+                              center = std::make_unique<EchoServerCenter>(use_coroutine, wire_format);
+                              center->SetEdgeTriggered(edge_triggered);
+                          }
+                          center->SetTimeouts(timeouts);
+                          center->SetDeferredFlush(deferred_flush);
+                          center->SetRingEnabled(shm_ring);
+                          center->SetRingPollUs(static_cast<uint32_t>(ring_poll_us));
+                          center->SetOffloadPool(pool);
+                          for (const auto& entry : io_budgets) {
+                              center->SetIoBudget(entry.first, entry.second);
+                          }
+                          center->SetBulkFrameBytes(bulk_frame_bytes);
+                          return center;
+                      }, threads,
+                      model, std::move(placement));
+    g_group = &group;
+    
+    if (!group.Listen(endpoints)) {
+        LOG_ERROR << "Failed to start server";
+        Logger::Stop();
         return 1;
     }
     
+    AdminListener admin;
+    if (admin_port != 0 && !admin.Start(nullptr, admin_port)) {
+        LOG_WARN << "Admin listener disabled";
+    }
+    
     // 运行事件循环
-    center.Run();
+    group.Run();
+    admin.Stop();
+    if (offload_pool) {
+        offload_pool->Stop();
+    }
+    g_group = nullptr;
+    if (g_signal != 0) {
+        LOG_INFO << "Received signal " << g_signal.load() << ", shutting down...";
+    }
+    
+    // 负载缓冲池统计，用于按实际流量调整 -M
+    SlabStats stats = SlabAllocator::Stats();
+    LOG_INFO << "Slab pool: hits=" << stats.hits << " misses=" << stats.misses
+             << " oversized=" << stats.oversized << " releases=" << stats.releases
+             << " bytes_pooled=" << stats.bytes_pooled;
     
-    std::cout << "Echo Server Stopped" << std::endl;
+    LOG_INFO << "Echo Server Stopped";
+    Logger::Stop();
     return 0;
 }
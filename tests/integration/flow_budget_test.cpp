@@ -0,0 +1,217 @@
+// 进程级内存预算（-g）对入站数据的约束：多个连接各自慢慢送来大帧时，
+// 服务端记账的占用不超过预算加每个连接一次读入的余量，持续超出时关闭握着半帧的连接，新连接仍能正常回射
+
+#include "../unit/test_check.h"
+#include "../../include/common/packet_header.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBudgetMb = 8;
+constexpr size_t kConnections = 24;
+constexpr uint32_t kFrameLength = 32u << 20;
+constexpr size_t kChunkSize = 64 * 1024;
+// 与 FlowControlConfig::budget_pause_bytes、IoBudget::bytes 及单次 readv 的溢出缓冲区相同
+constexpr size_t kPerConnectionSlack = (64 + 256 + 64) * 1024;
+// 超过 FlowControlConfig::budget_stall_ms，保证关闭路径被覆盖
+constexpr auto kStreamDuration = std::chrono::milliseconds(4000);
+
+using Clock = std::chrono::steady_clock;
+
+uint16_t FreePort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+int Connect(uint16_t port, bool nonblocking) {
+    int fd = socket(AF_INET, SOCK_STREAM | (nonblocking ? SOCK_NONBLOCK : 0), 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool WaitForPort(uint16_t port) {
+    for (int i = 0; i < 100; i++) {
+        int fd = Connect(port, false);
+        if (fd >= 0) {
+            close(fd);
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+// 从管理端口读出一个指标值，失败返回 -1
+long long ReadMetric(uint16_t admin_port, const char* name) {
+    int fd = Connect(admin_port, false);
+    if (fd < 0) {
+        return -1;
+    }
+    const char request[] = "GET / HTTP/1.0\r\n\r\n";
+    send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL);
+    std::string body;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        body.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    std::string key = std::string("\n") + name + " ";
+    size_t pos = body.find(key);
+    return pos == std::string::npos ? -1 : std::atoll(body.c_str() + pos + key.size());
+}
+
+// 连接开始时只发出包头，负载在随后的循环中尽量写入
+struct Streamer {
+    int fd = -1;
+    size_t sent = 0;
+    bool closed_by_server = false;
+};
+
+bool EchoSmallFrame(uint16_t port) {
+    int fd = Connect(port, false);
+    if (fd < 0) {
+        return false;
+    }
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    PacketHeader header{static_cast<uint32_t>(PacketHeaderCommand::DEFAULT), 100, 0, 7, 0};
+    std::vector<uint8_t> frame(sizeof(header) + header.length, 0x5A);
+    std::memcpy(frame.data(), &header, sizeof(header));
+    bool ok = send(fd, frame.data(), frame.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(frame.size());
+    std::vector<uint8_t> reply(frame.size());
+    size_t got = 0;
+    while (ok && got < reply.size()) {
+        ssize_t n = recv(fd, reply.data() + got, reply.size() - got, 0);
+        ok = n > 0;
+        got += ok ? static_cast<size_t>(n) : 0;
+    }
+    close(fd);
+    return ok && std::memcmp(reply.data() + sizeof(header), frame.data() + sizeof(header), header.length) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s path/to/echo_server\n", argv[0]);
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    uint16_t port = FreePort();
+    uint16_t admin_port = FreePort();
+    std::string port_arg = std::to_string(port);
+    std::string admin_arg = std::to_string(admin_port);
+    std::string budget_arg = std::to_string(kBudgetMb);
+    
+    pid_t server = fork();
+    if (server == 0) {
+        execl(argv[1], argv[1], "-p", port_arg.c_str(), "-A", admin_arg.c_str(), "-t", "2", "-g", budget_arg.c_str(), "-l",
+              "error", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    CHECK(server > 0);
+    bool ready = WaitForPort(port) && WaitForPort(admin_port);
+    CHECK(ready);
+    
+    std::vector<Streamer> streamers(kConnections);
+    PacketHeader header{static_cast<uint32_t>(PacketHeaderCommand::DEFAULT), kFrameLength, 0, 0, 0};
+    for (Streamer& streamer : streamers) {
+        streamer.fd = Connect(port, true);
+        CHECK(streamer.fd >= 0);
+    }
+    
+    std::vector<uint8_t> chunk(kChunkSize, 0xA5);
+    std::vector<uint8_t> first(chunk);
+    std::memcpy(first.data(), &header, sizeof(header));
+    long long max_used = 0;
+    int samples = 0;
+    auto deadline = Clock::now() + kStreamDuration;
+    while (ready && Clock::now() < deadline) {
+        for (Streamer& streamer : streamers) {
+            if (streamer.fd < 0 || streamer.closed_by_server) {
+                continue;
+            }
+            // 每轮最多写 1MB，写满 socket 缓冲区即换下一个连接
+            for (int i = 0; i < 16 && streamer.sent < sizeof(header) + kFrameLength; i++) {
+                // 第一段从包头开始，之后都是负载，短写时从中断处续写
+                const uint8_t* data = streamer.sent < kChunkSize ? first.data() + streamer.sent : chunk.data();
+                size_t length = std::min(streamer.sent < kChunkSize ? kChunkSize - streamer.sent : kChunkSize,
+                                         sizeof(header) + kFrameLength - streamer.sent);
+                ssize_t n = send(streamer.fd, data, length, MSG_NOSIGNAL);
+                if (n < 0) {
+                    streamer.closed_by_server = errno == EPIPE || errno == ECONNRESET;
+                    break;
+                }
+                streamer.sent += static_cast<size_t>(n);
+            }
+        }
+        long long used = ReadMetric(admin_port, "echo_memory_budget_used_bytes");
+        if (used >= 0) {
+            samples++;
+            max_used = std::max(max_used, used);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    
+    size_t sent_total = 0;
+    size_t closed = 0;
+    for (Streamer& streamer : streamers) {
+        sent_total += streamer.sent;
+        closed += streamer.closed_by_server ? 1 : 0;
+    }
+    long long bound = static_cast<long long>((kBudgetMb << 20) + kConnections * kPerConnectionSlack);
+    std::fprintf(stderr, "sent=%zu MB, max budget used=%lld KB (bound %lld KB), closed by server=%zu, samples=%d\n",
+                 sent_total >> 20, max_used >> 10, bound >> 10, closed, samples);
+    CHECK(samples > 0);
+    // 客户端送出的数据远多于预算，服务端记账的占用仍受限
+    CHECK(sent_total > static_cast<size_t>(bound) * 2);
+    CHECK(max_used <= bound);
+    // 握着半帧的连接持续超出预算时被关闭
+    CHECK(closed > 0);
+    
+    for (Streamer& streamer : streamers) {
+        if (streamer.fd >= 0) {
+            close(streamer.fd);
+        }
+    }
+    // 其余连接断开、预算回落后，新连接照常回射
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(EchoSmallFrame(port));
+    
+    if (server > 0) {
+        kill(server, SIGINT);
+        int status = 0;
+        waitpid(server, &status, 0);
+    }
+    return g_check_failures == 0 ? 0 : 1;
+}
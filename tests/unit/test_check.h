@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+
+// 单元测试的最小断言：失败时输出位置并计数，不中断，main 按失败数返回
+inline int g_check_failures = 0;
+
+#define CHECK(cond)                                                                          \
+    do {                                                                                     \
+        if (!(cond)) {                                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);   \
+            g_check_failures++;                                                              \
+        }                                                                                    \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+// 在 main 中依次运行各测试函数
+#define RUN_TEST(fn)                                     \
+    do {                                                 \
+        int before = g_check_failures;                   \
+        fn();                                            \
+        std::fprintf(stderr, "%s %s\n", g_check_failures == before ? "PASS" : "FAIL", #fn); \
+    } while (0)
@@ -0,0 +1,186 @@
+#include "test_check.h"
+#include "../../include/core/timer_wheel.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// 与 TimerWheel::kMaxDelay 相同：第 0 层 8 位加三层各 6 位
+constexpr uint64_t kMaxDelay = (uint64_t(1) << 26) - 1;
+
+// 逐毫秒推进，记录每个定时器实际触发的时刻
+struct Recorder {
+    uint64_t now = 0;
+    std::vector<uint64_t> fired_at;
+    
+    void AdvanceTo(TimerWheel& wheel, uint64_t target) {
+        while (now < target) {
+            now++;
+            wheel.Advance(now);
+        }
+    }
+};
+
+void TestExpiresOnExactTick() {
+    TimerWheel wheel(0);
+    int fired = 0;
+    Timer timer([&fired] { fired++; });
+    wheel.Arm(&timer, 5);
+    CHECK_EQ(wheel.size(), 1u);
+    CHECK_EQ(wheel.Advance(4), 0u);
+    CHECK(timer.IsArmed());
+    CHECK_EQ(wheel.Advance(5), 1u);
+    CHECK_EQ(fired, 1);
+    CHECK(!timer.IsArmed());
+    CHECK_EQ(wheel.size(), 0u);
+}
+
+void TestZeroDelayFiresNextTick() {
+    TimerWheel wheel(0);
+    int fired = 0;
+    Timer timer([&fired] { fired++; });
+    wheel.Arm(&timer, 0);
+    CHECK_EQ(wheel.Advance(0), 0u);
+    CHECK_EQ(wheel.Advance(1), 1u);
+    CHECK_EQ(fired, 1);
+}
+
+void TestCascadeAcrossLevels() {
+    // 覆盖第 0 层边界、第 1~3 层各自的迁移，以及非零起始时刻
+    const uint64_t delays[] = {1, 255, 256, 257, 300, 511, 512, 16383, 16384, 16391, 70000, 1048576, 1048583, 5000000};
+    for (uint64_t start : {uint64_t(0), uint64_t(1000), uint64_t(255), uint64_t(16380)}) {
+        TimerWheel wheel(0);
+        Recorder recorder;
+        recorder.AdvanceTo(wheel, start);
+        std::vector<Timer> timers(sizeof(delays) / sizeof(delays[0]));
+        std::vector<uint64_t> fired_at(timers.size(), 0);
+        for (size_t i = 0; i < timers.size(); i++) {
+            timers[i].SetCallback([&fired_at, &recorder, i] { fired_at[i] = recorder.now; });
+            wheel.Arm(&timers[i], delays[i]);
+        }
+        recorder.AdvanceTo(wheel, start + 5000001);
+        for (size_t i = 0; i < timers.size(); i++) {
+            CHECK_EQ(fired_at[i], start + delays[i]);
+        }
+        CHECK_EQ(wheel.size(), 0u);
+    }
+}
+
+void TestBulkAdvanceFiresInExpiryOrder() {
+    // 一次推进跨越多层时，回调仍按到期时刻的先后发生
+    TimerWheel wheel(0);
+    const uint64_t delays[] = {70000, 3, 16384, 300, 256, 1048576, 1};
+    std::vector<Timer> timers(sizeof(delays) / sizeof(delays[0]));
+    std::vector<uint64_t> order;
+    for (size_t i = 0; i < timers.size(); i++) {
+        uint64_t delay = delays[i];
+        timers[i].SetCallback([&order, delay] { order.push_back(delay); });
+        wheel.Arm(&timers[i], delay);
+    }
+    CHECK_EQ(wheel.Advance(2000000), timers.size());
+    const std::vector<uint64_t> expected = {1, 3, 256, 300, 16384, 70000, 1048576};
+    CHECK(order == expected);
+}
+
+void TestMaxDelayClamp() {
+    TimerWheel wheel(0);
+    int fired = 0;
+    Timer timer([&fired] { fired++; });
+    wheel.Arm(&timer, UINT64_MAX);
+    CHECK_EQ(wheel.Advance(kMaxDelay - 1), 0u);
+    CHECK_EQ(wheel.Advance(kMaxDelay), 1u);
+    CHECK_EQ(fired, 1);
+}
+
+void TestRearmAndCancel() {
+    TimerWheel wheel(0);
+    int fired = 0;
+    Timer timer([&fired] { fired++; });
+    wheel.Arm(&timer, 10);
+    // 重新启动即重新计时
+    wheel.Advance(5);
+    wheel.Arm(&timer, 10);
+    CHECK_EQ(wheel.size(), 1u);
+    CHECK_EQ(wheel.Advance(14), 0u);
+    CHECK_EQ(wheel.Advance(15), 1u);
+    
+    wheel.Arm(&timer, 400);
+    timer.Cancel();
+    CHECK(!timer.IsArmed());
+    CHECK_EQ(wheel.size(), 0u);
+    CHECK_EQ(wheel.Advance(1000), 0u);
+    CHECK_EQ(fired, 1);
+}
+
+void TestCallbackMayCancelAndRearm() {
+    TimerWheel wheel(0);
+    Timer second;
+    int first_fired = 0;
+    int second_fired = 0;
+    Timer first;
+    // 同一槽中先触发的回调取消另一个，并重新启动自己：本次推进中不会再次触发
+    first.SetCallback([&] {
+        first_fired++;
+        second.Cancel();
+        if (first_fired == 1) {
+            wheel.Arm(&first, 0);
+        }
+    });
+    second.SetCallback([&second_fired] { second_fired++; });
+    wheel.Arm(&first, 7);
+    wheel.Arm(&second, 7);
+    CHECK_EQ(wheel.Advance(7), 1u);
+    CHECK_EQ(first_fired, 1);
+    CHECK_EQ(second_fired, 0);
+    CHECK(first.IsArmed());
+    CHECK_EQ(wheel.Advance(8), 1u);
+    CHECK_EQ(first_fired, 2);
+    CHECK_EQ(wheel.size(), 0u);
+}
+
+void TestNextTimeout() {
+    TimerWheel wheel(0);
+    CHECK_EQ(wheel.NextTimeoutMs(), -1);
+    Timer near;
+    Timer far;
+    wheel.Arm(&far, 1000);
+    // 只有高层定时器时在下一次迁移处醒来
+    CHECK_EQ(wheel.NextTimeoutMs(), 256);
+    wheel.Arm(&near, 10);
+    CHECK_EQ(wheel.NextTimeoutMs(), 10);
+    wheel.Advance(10);
+    CHECK_EQ(wheel.NextTimeoutMs(), 246);
+}
+
+void TestDestructionDetaches() {
+    Timer timer;
+    {
+        TimerWheel wheel(0);
+        wheel.Arm(&timer, 100);
+        {
+            Timer scoped;
+            wheel.Arm(&scoped, 50);
+            CHECK_EQ(wheel.size(), 2u);
+        }
+        // Timer 析构时自动取消
+        CHECK_EQ(wheel.size(), 1u);
+    }
+    // 时间轮先析构：定时器被断开，之后取消或析构都不访问已释放的时间轮
+    CHECK(!timer.IsArmed());
+    timer.Cancel();
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestExpiresOnExactTick);
+    RUN_TEST(TestZeroDelayFiresNextTick);
+    RUN_TEST(TestCascadeAcrossLevels);
+    RUN_TEST(TestBulkAdvanceFiresInExpiryOrder);
+    RUN_TEST(TestMaxDelayClamp);
+    RUN_TEST(TestRearmAndCancel);
+    RUN_TEST(TestCallbackMayCancelAndRearm);
+    RUN_TEST(TestNextTimeout);
+    RUN_TEST(TestDestructionDetaches);
+    return g_check_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include "test_check.h"
+#include "../../include/common/wire_codec.h"
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+namespace {
+
+// 变长编码 1~5 字节的边界值
+const uint32_t kBoundaryValues[] = {0, 1, 127, 128, 16383, 16384, (1u << 21) - 1, 1u << 21, (1u << 28) - 1, 1u << 28, UINT32_MAX};
+
+bool SameHeader(const PacketHeader& a, const PacketHeader& b) {
+    return a.command == b.command && a.length == b.length && a.error == b.error && a.extra1 == b.extra1 &&
+           a.extra2 == b.extra2;
+}
+
+// 编码后完整解码应得到原包头，任何更短的前缀都只能返回 0（数据不足）
+void CheckRoundTrip(const WireFormat& format, const PacketHeader& header) {
+    uint8_t buffer[kMaxWireHeaderSize + 8];
+    std::memset(buffer, 0xAB, sizeof(buffer));
+    size_t size = format.encode(header, buffer);
+    CHECK_EQ(size, format.encoded_size(header));
+    CHECK(size >= format.min_header_size && size <= format.max_header_size);
+    
+    PacketHeader decoded{};
+    // 尾部多余的字节不应被消耗
+    CHECK_EQ(format.decode(buffer, size + 8, &decoded), static_cast<int>(size));
+    CHECK(SameHeader(decoded, header));
+    for (size_t prefix = 0; prefix < size; prefix++) {
+        PacketHeader partial{};
+        CHECK_EQ(format.decode(buffer, prefix, &partial), 0);
+    }
+}
+
+void TestFindFormats() {
+    CHECK(WireFormat::Find("native") == &WireFormat::Native());
+    CHECK(WireFormat::Find("compact") == &WireFormat::Compact());
+    CHECK(WireFormat::Find("network") != nullptr);
+    CHECK(WireFormat::Find("slim") != nullptr);
+    CHECK(WireFormat::Find("bogus") == nullptr);
+    CHECK_EQ(WireFormat::Compact().magic, CompactHeaderCodec::kMagic);
+}
+
+void TestRoundTripAllFormats() {
+    for (const char* name : {"native", "network", "slim", "compact"}) {
+        const WireFormat& format = *WireFormat::Find(name);
+        for (uint32_t value : kBoundaryValues) {
+            CheckRoundTrip(format, PacketHeader{value, value, 0, 0, 0});
+            CheckRoundTrip(format, PacketHeader{1, value, value, value, value});
+            CheckRoundTrip(format, PacketHeader{value, 3, 0, value, 0});
+        }
+    }
+}
+
+void TestFixedLayoutByteOrder() {
+    const PacketHeader header{0x01020304, 0x05060708, 0, 0, 0x0A0B0C0D};
+    uint8_t buffer[kMaxWireHeaderSize];
+    CHECK_EQ(WireFormat::Find("network")->encode(header, buffer), 20u);
+    const uint8_t network_prefix[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    CHECK(std::memcmp(buffer, network_prefix, sizeof(network_prefix)) == 0);
+    CHECK_EQ(buffer[16], 0x0A);
+    
+    // native 与 PacketHeader 的内存布局一致
+    CHECK_EQ(WireFormat::Native().encode(header, buffer), sizeof(PacketHeader));
+    if (WireFormat::Native().host_layout) {
+        CHECK(std::memcmp(buffer, &header, sizeof(PacketHeader)) == 0);
+    }
+}
+
+void TestVarintBoundaries() {
+    for (uint32_t value : kBoundaryValues) {
+        uint8_t buffer[8];
+        uint8_t* end = wire::EncodeVarint(value, buffer);
+        CHECK_EQ(static_cast<size_t>(end - buffer), wire::VarintSize(value));
+        uint32_t decoded = 0;
+        bool truncated = false;
+        CHECK(wire::DecodeVarint(buffer, end, &decoded, &truncated) == end);
+        CHECK_EQ(decoded, value);
+        CHECK(!truncated);
+    }
+    CHECK_EQ(wire::VarintSize(0), 1u);
+    CHECK_EQ(wire::VarintSize(UINT32_MAX), 5u);
+}
+
+void TestVarintMalformed() {
+    uint32_t value = 0;
+    bool truncated = false;
+    
+    // 第 5 字节只能携带 4 位
+    const uint8_t max[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+    CHECK(wire::DecodeVarint(max, max + 5, &value, &truncated) == max + 5);
+    CHECK_EQ(value, UINT32_MAX);
+    const uint8_t overflow[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x1F};
+    CHECK(wire::DecodeVarint(overflow, overflow + 5, &value, &truncated) == nullptr);
+    CHECK(!truncated);
+    
+    // 超过 5 字节：第 5 字节带续位即溢出，不会继续读
+    const uint8_t too_long[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x00};
+    CHECK(wire::DecodeVarint(too_long, too_long + 6, &value, &truncated) == nullptr);
+    CHECK(!truncated);
+    
+    // 非最短编码在 5 字节内仍可接受
+    const uint8_t padded[] = {0x81, 0x80, 0x00};
+    CHECK(wire::DecodeVarint(padded, padded + 3, &value, &truncated) == padded + 3);
+    CHECK_EQ(value, 1u);
+    
+    // 合法 5 字节编码的任何前缀都是截断
+    const uint8_t partial[] = {0x80, 0x80, 0x80, 0x80, 0x01};
+    for (size_t size = 0; size < sizeof(partial); size++) {
+        truncated = false;
+        CHECK(wire::DecodeVarint(partial, partial + size, &value, &truncated) == nullptr);
+        CHECK(truncated);
+    }
+}
+
+void TestCompactMalformed() {
+    PacketHeader header{};
+    
+    // 未定义的标志位
+    const uint8_t bad_flags[] = {0x08, 0x01, 0x01};
+    CHECK_EQ(CompactHeaderCodec::Decode(bad_flags, sizeof(bad_flags), &header), -1);
+    
+    // length 溢出 32 位：数据再多也是格式错误而不是等待
+    const uint8_t bad_length[] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x01};
+    CHECK_EQ(CompactHeaderCodec::Decode(bad_length, sizeof(bad_length), &header), -1);
+    
+    // 可选字段溢出
+    const uint8_t bad_extra[] = {0x04, 0x01, 0x01, 0x80, 0x80, 0x80, 0x80, 0x10};
+    CHECK_EQ(CompactHeaderCodec::Decode(bad_extra, sizeof(bad_extra), &header), -1);
+    
+    // 标志声明了 extra1 但数据在其中截断
+    const uint8_t cut_extra[] = {0x02, 0x01, 0x01, 0x80};
+    CHECK_EQ(CompactHeaderCodec::Decode(cut_extra, sizeof(cut_extra), &header), 0);
+    
+    // 失败时不修改输出
+    header = PacketHeader{7, 7, 7, 7, 7};
+    CHECK_EQ(CompactHeaderCodec::Decode(bad_extra, sizeof(bad_extra), &header), -1);
+    CHECK(SameHeader(header, PacketHeader{7, 7, 7, 7, 7}));
+}
+
+void TestSlimPresenceMask() {
+    const WireFormat& slim = *WireFormat::Find("slim");
+    for (unsigned mask = 0; mask < 8; mask++) {
+        PacketHeader header{0x11, 0x22, (mask & 1) ? 0x33u : 0u, (mask & 2) ? 0x44u : 0u, (mask & 4) ? 0x55u : 0u};
+        uint8_t buffer[kMaxWireHeaderSize];
+        size_t size = slim.encode(header, buffer);
+        CHECK_EQ(size, 9u + 4u * static_cast<unsigned>(__builtin_popcount(mask)));
+        // 位图紧跟在 command、length 之后
+        CHECK_EQ(buffer[8], mask);
+        CheckRoundTrip(slim, header);
+    }
+    
+    // 位图声明了字段但数据不足：等待而不是读越界
+    const uint8_t cut[] = {0, 0, 0, 1, 0, 0, 0, 2, 0x06, 0, 0, 0, 3, 0, 0};
+    PacketHeader header{};
+    CHECK_EQ(slim.decode(cut, sizeof(cut), &header), 0);
+    
+    // 未定义的高位不对应任何字段，只消耗已声明的字节
+    const uint8_t high_bits[] = {0, 0, 0, 1, 0, 0, 0, 2, 0xF8, 0xEE};
+    CHECK_EQ(slim.decode(high_bits, sizeof(high_bits), &header), 9);
+    CHECK(SameHeader(header, PacketHeader{1, 2, 0, 0, 0}));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestFindFormats);
+    RUN_TEST(TestRoundTripAllFormats);
+    RUN_TEST(TestFixedLayoutByteOrder);
+    RUN_TEST(TestVarintBoundaries);
+    RUN_TEST(TestVarintMalformed);
+    RUN_TEST(TestCompactMalformed);
+    RUN_TEST(TestSlimPresenceMask);
+    return g_check_failures == 0 ? 0 : 1;
+}